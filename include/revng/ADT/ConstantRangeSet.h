@@ -4,52 +4,28 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/ConstantRange.h"
 
-#include "revng/ADT/ZipMapIterator.h"
 #include "revng/Support/Debug.h"
 
-using APIntVector = llvm::SmallVector<llvm::APInt, 4>;
-
-struct APIntVectorKeyContainer {
-  static int compare(const llvm::APInt &LHS, const llvm::APInt &RHS) {
-    if (LHS == RHS)
-      return 0;
-    if (LHS.ult(RHS))
-      return -1;
-    else
-      return 1;
-  }
-};
-
-// Options:
-//
-// * Empty
-// * [10,)
-// * [0,10)
+class ConstantRangeSet;
 
+/// \brief Iterator over all the values contained in a ConstantRangeSet
 class ConstantRangeSetIterator {
 private:
+  const ConstantRangeSet *Set;
   llvm::APInt Current;
-  const llvm::APInt *NextBound;
-  const llvm::APInt *const End;
+  size_t NextBound;
   bool ToLast;
   bool Done;
-  const llvm::APInt Max;
 
 public:
-  ConstantRangeSetIterator(const llvm::APInt *Start, const llvm::APInt *End) :
-    NextBound(Start), End(End), ToLast(false), Done(false) {
-    if (Start != End) {
-      Current = *NextBound;
-      ++NextBound;
-      if (NextBound == End)
-        ToLast = true;
-    } else {
-      Done = true;
-    }
-  }
+  inline ConstantRangeSetIterator(const ConstantRangeSet &Set, bool IsEnd);
 
   bool operator==(const ConstantRangeSetIterator &Other) const {
     // TODO: implement proper comparison operator
@@ -61,29 +37,7 @@ public:
     return not(*this == Other);
   }
 
-  ConstantRangeSetIterator &operator++() {
-    revng_assert(not Done);
-
-    if (ToLast and Current.isMaxValue()) {
-      Done = true;
-      return *this;
-    }
-
-    ++Current;
-    if (not ToLast and Current == *NextBound) {
-      ++NextBound;
-      if (NextBound != End) {
-        Current = *NextBound;
-        ++NextBound;
-        if (NextBound == End)
-          ToLast = true;
-      } else {
-        Done = true;
-      }
-    }
-
-    return *this;
-  }
+  inline ConstantRangeSetIterator &operator++();
 
   const llvm::APInt &operator*() const {
     revng_assert(not Done);
@@ -98,12 +52,26 @@ public:
 /// This class is effectively an extension of llvm::ConstantRange aiming to
 /// represent multiple disjoint ranges.
 ///
-/// It is implemented as a vector of llvm::APInt. Each one of them represents a
-/// flip in the status of the range (`ON -> OFF` or `OFF -> ON`), starting from
-/// the initial state `OFF`.
+/// It is implemented as a sorted vector of bounds. Each one of them represents
+/// a flip in the status of the range (`ON -> OFF` or `OFF -> ON`), starting
+/// from the initial state `OFF`.
+///
+/// Bounds of sets up to 64 bits wide, by far the most common case, are stored
+/// as plain `uint64_t`s in a SmallVector, so that copying and merging sets
+/// doesn't involve llvm::APInt. Wider sets use a vector of llvm::APInt.
 class ConstantRangeSet {
+  friend class ConstantRangeSetIterator;
+
 private:
-  APIntVector Bounds;
+  static constexpr uint32_t MaxNarrowBitWidth = 64;
+  using NarrowVector = llvm::SmallVector<uint64_t, 4>;
+  using WideVector = std::vector<llvm::APInt>;
+
+private:
+  /// Bounds, if BitWidth <= MaxNarrowBitWidth
+  NarrowVector Narrow;
+  /// Bounds, if BitWidth > MaxNarrowBitWidth
+  WideVector Wide;
   uint32_t BitWidth;
 
 public:
@@ -111,24 +79,24 @@ public:
 
   ConstantRangeSet(uint32_t BitWidth, bool IsFullSet) : BitWidth(BitWidth) {
     if (IsFullSet)
-      Bounds.emplace_back(BitWidth, 0);
+      pushBound(llvm::APInt(BitWidth, 0));
   }
 
   ConstantRangeSet(const llvm::ConstantRange &Range) {
     BitWidth = Range.getBitWidth();
 
     if (Range.isFullSet()) {
-      Bounds.emplace_back(BitWidth, 0);
+      pushBound(llvm::APInt(BitWidth, 0));
     } else if (Range.isEmptySet()) {
       // Nothing to do here
     } else if (Range.isWrappedSet()) {
-      Bounds.emplace_back(BitWidth, 0);
-      Bounds.push_back(Range.getUpper());
-      Bounds.push_back(Range.getLower());
+      pushBound(llvm::APInt(BitWidth, 0));
+      pushBound(Range.getUpper());
+      pushBound(Range.getLower());
     } else {
-      Bounds.push_back(Range.getLower());
-      if (Range.getUpper() != llvm::APInt{ BitWidth, 0 })
-        Bounds.push_back(Range.getUpper());
+      pushBound(Range.getLower());
+      if (not Range.getUpper().isNullValue())
+        pushBound(Range.getUpper());
     }
   }
 
@@ -146,50 +114,45 @@ public:
   }
 
   bool operator==(const ConstantRangeSet &Other) const {
-    return Bounds == Other.Bounds;
+    return Narrow == Other.Narrow and Wide == Other.Wide;
   }
 
   void setWidth(unsigned NewBitWidth) {
-    if (BitWidth == 0)
+    if (BitWidth == 0) {
+      revng_assert(boundsCount() == 0);
       BitWidth = NewBitWidth;
-    else
+    } else {
       revng_assert(BitWidth == NewBitWidth);
+    }
   }
 
   ConstantRangeSetIterator begin() const {
-    return ConstantRangeSetIterator(&*Bounds.begin(), &*Bounds.end());
+    return ConstantRangeSetIterator(*this, false);
   }
 
   ConstantRangeSetIterator end() const {
-    return ConstantRangeSetIterator(&*Bounds.end(), &*Bounds.end());
+    return ConstantRangeSetIterator(*this, true);
   }
 
   bool isFullSet() const {
-    return Bounds.size() == 1 and Bounds[0].isNullValue();
+    if (isWide())
+      return Wide.size() == 1 and Wide[0].isNullValue();
+    else
+      return Narrow.size() == 1 and Narrow[0] == 0;
   }
-  bool isEmptySet() const { return Bounds.size() == 0; }
+
+  bool isEmptySet() const { return boundsCount() == 0; }
 
   llvm::APInt size() const {
     using namespace llvm;
 
-    if (Bounds.size() == 0)
-      return APInt(BitWidth, 0);
+    if (isWide())
+      return sizeOf(Wide, APInt::getMaxValue(BitWidth));
 
-    APInt Size(BitWidth, 0);
-    const APInt *Last = nullptr;
-    for (const llvm::APInt &N : Bounds) {
-      if (Last == nullptr) {
-        Last = &N;
-      } else {
-        Size += (N - *Last);
-        Last = nullptr;
-      }
-    }
-
-    if (Last != nullptr)
-      Size += (APInt::getMaxValue(BitWidth) - *Last);
-
-    return Size;
+    // Compute the size modulo 2^BitWidth, as APInt would
+    uint64_t Max = BitWidth == 0 ? 0 : maxNarrowValue();
+    uint64_t Size = sizeOf(Narrow, Max);
+    return APInt(BitWidth, BitWidth == 0 ? 0 : Size & Max);
   }
 
   void dump() const debug_function { dump(dbg); }
@@ -202,13 +165,14 @@ public:
     }
 
     bool Open = true;
-    for (const llvm::APInt &N : Bounds) {
+    size_t Count = boundsCount();
+    for (size_t I = 0; I < Count; ++I) {
       if (Open)
         Output << "[";
       else
         Output << ",";
 
-      Output << N.getLimitedValue();
+      Output << bound(I).getLimitedValue();
 
       if (not Open)
         Output << ") ";
@@ -216,7 +180,7 @@ public:
       Open = not Open;
     }
 
-    if (Bounds.size() == 0) {
+    if (Count == 0) {
       Output << "[)";
     }
     if (not Open) {
@@ -226,48 +190,157 @@ public:
   }
 
 private:
-  template<bool And>
-  ConstantRangeSet merge(const ConstantRangeSet &Other) const {
-    using namespace llvm;
+  bool isWide() const { return BitWidth > MaxNarrowBitWidth; }
 
-    auto ResultBitWidth = std::max(BitWidth, Other.BitWidth);
-    ConstantRangeSet Result(ResultBitWidth, false);
-    revng_assert(BitWidth == 0 or Other.BitWidth == 0
-                 or BitWidth == Other.BitWidth);
+  uint64_t maxNarrowValue() const {
+    revng_assert(BitWidth != 0 and not isWide());
+    return std::numeric_limits<uint64_t>::max() >> (64 - BitWidth);
+  }
+
+  size_t boundsCount() const { return isWide() ? Wide.size() : Narrow.size(); }
 
+  llvm::APInt bound(size_t Index) const {
+    if (isWide())
+      return Wide[Index];
+    else
+      return llvm::APInt(BitWidth, Narrow[Index]);
+  }
+
+  bool boundEquals(size_t Index, const llvm::APInt &Value) const {
+    if (isWide())
+      return Wide[Index] == Value;
+    else
+      return Narrow[Index] == Value.getZExtValue();
+  }
+
+  void pushBound(const llvm::APInt &Value) {
+    revng_assert(Value.getBitWidth() == BitWidth);
+    if (isWide())
+      Wide.push_back(Value);
+    else
+      Narrow.push_back(Value.getZExtValue());
+  }
+
+  static bool lessThan(uint64_t LHS, uint64_t RHS) { return LHS < RHS; }
+
+  static bool lessThan(const llvm::APInt &LHS, const llvm::APInt &RHS) {
+    return LHS.ult(RHS);
+  }
+
+  template<typename VectorT, typename T>
+  static T sizeOf(const VectorT &Bounds, const T &Max) {
+    T Size = Max - Max;
+    const T *Last = nullptr;
+    for (const T &N : Bounds) {
+      if (Last == nullptr) {
+        Last = &N;
+      } else {
+        Size += (N - *Last);
+        Last = nullptr;
+      }
+    }
+
+    if (Last != nullptr)
+      Size += (Max - *Last);
+
+    return Size;
+  }
+
+  /// \brief Merge two sorted vectors of bounds
+  template<bool And, typename VectorT>
+  static void mergeBounds(const VectorT &Left,
+                          const VectorT &Right,
+                          VectorT &Result) {
     bool LastOutput = false;
     bool LeftActive = false;
     bool RightActive = false;
-    auto zip_APIntVector = zipmap_range<const APIntVector,
-                                        const APIntVector,
-                                        APIntVectorKeyContainer>;
-    for (auto &P : zip_APIntVector(Bounds, Other.Bounds)) {
-      const llvm::APInt *Left = P.first;
-      const llvm::APInt *Right = P.second;
-
-      if (Left != nullptr) {
-        revng_assert(Left->getBitWidth() == ResultBitWidth);
+    auto LeftIt = Left.begin();
+    auto RightIt = Right.begin();
+    while (LeftIt != Left.end() or RightIt != Right.end()) {
+      // Consume the lowest bound, or both if they are equal
+      bool TakeLeft = RightIt == Right.end()
+                      or (LeftIt != Left.end()
+                          and not lessThan(*RightIt, *LeftIt));
+      bool TakeRight = LeftIt == Left.end()
+                       or (RightIt != Right.end()
+                           and not lessThan(*LeftIt, *RightIt));
+      const auto &Value = TakeLeft ? *LeftIt : *RightIt;
+
+      if (TakeLeft)
         LeftActive = not LeftActive;
-      }
 
-      if (Right != nullptr) {
-        revng_assert(Right->getBitWidth() == ResultBitWidth);
+      if (TakeRight)
         RightActive = not RightActive;
-      }
-
-      const llvm::APInt *Value = P.first == nullptr ? P.second : P.first;
-      revng_assert(Value != nullptr);
 
       bool NewOutput = And ? (LeftActive and RightActive) :
                              (LeftActive or RightActive);
 
-      if (NewOutput != LastOutput) {
-        Result.Bounds.push_back(*Value);
-      }
+      if (NewOutput != LastOutput)
+        Result.push_back(Value);
 
       LastOutput = NewOutput;
+
+      if (TakeLeft)
+        ++LeftIt;
+      if (TakeRight)
+        ++RightIt;
     }
+  }
+
+  template<bool And>
+  ConstantRangeSet merge(const ConstantRangeSet &Other) const {
+    auto ResultBitWidth = std::max(BitWidth, Other.BitWidth);
+    ConstantRangeSet Result(ResultBitWidth, false);
+    revng_assert(BitWidth == 0 or Other.BitWidth == 0
+                 or BitWidth == Other.BitWidth);
+
+    // Sets with BitWidth == 0 are empty, so we can treat them as having the
+    // same representation as the other set
+    if (Result.isWide())
+      mergeBounds<And>(Wide, Other.Wide, Result.Wide);
+    else
+      mergeBounds<And>(Narrow, Other.Narrow, Result.Narrow);
 
     return Result;
   }
 };
+
+inline ConstantRangeSetIterator::ConstantRangeSetIterator(
+  const ConstantRangeSet &Set,
+  bool IsEnd) :
+  Set(&Set), NextBound(0), ToLast(false), Done(false) {
+  size_t Count = Set.boundsCount();
+  if (not IsEnd and Count != 0) {
+    Current = Set.bound(0);
+    NextBound = 1;
+    if (NextBound == Count)
+      ToLast = true;
+  } else {
+    Done = true;
+  }
+}
+
+inline ConstantRangeSetIterator &ConstantRangeSetIterator::operator++() {
+  revng_assert(not Done);
+
+  if (ToLast and Current.isMaxValue()) {
+    Done = true;
+    return *this;
+  }
+
+  ++Current;
+  if (not ToLast and Set->boundEquals(NextBound, Current)) {
+    ++NextBound;
+    size_t Count = Set->boundsCount();
+    if (NextBound != Count) {
+      Current = Set->bound(NextBound);
+      ++NextBound;
+      if (NextBound == Count)
+        ToLast = true;
+    } else {
+      Done = true;
+    }
+  }
+
+  return *this;
+}
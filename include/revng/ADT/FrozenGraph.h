@@ -0,0 +1,286 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/GraphTraits.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/iterator_range.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/Assert.h"
+
+template<typename OriginalNodeRef>
+class FrozenGraph;
+
+/// \brief Node of a FrozenGraph
+///
+/// Successors and predecessors are ranges in two flat arrays owned by the
+/// graph.
+template<typename OriginalNodeRef>
+class FrozenNode {
+private:
+  using Graph = FrozenGraph<OriginalNodeRef>;
+  friend Graph;
+
+public:
+  using iterator = FrozenNode *const *;
+
+private:
+  OriginalNodeRef Original;
+  Graph *Parent;
+  FrozenNode *const *SuccessorsBegin = nullptr;
+  FrozenNode *const *SuccessorsEnd = nullptr;
+  FrozenNode *const *PredecessorsBegin = nullptr;
+  FrozenNode *const *PredecessorsEnd = nullptr;
+
+public:
+  FrozenNode(OriginalNodeRef Original, Graph *Parent) :
+    Original(Original), Parent(Parent) {}
+
+public:
+  /// \brief The node of the original graph this node is a copy of
+  OriginalNodeRef original() const { return Original; }
+
+  /// \brief Dense index of this node in its graph
+  uint32_t index() const { return this - Parent->Nodes.data(); }
+
+  Graph *getParent() const { return Parent; }
+
+  llvm::iterator_range<iterator> successors() const {
+    return llvm::make_range(SuccessorsBegin, SuccessorsEnd);
+  }
+
+  llvm::iterator_range<iterator> predecessors() const {
+    return llvm::make_range(PredecessorsBegin, PredecessorsEnd);
+  }
+
+  size_t successorCount() const { return SuccessorsEnd - SuccessorsBegin; }
+  size_t predecessorCount() const {
+    return PredecessorsEnd - PredecessorsBegin;
+  }
+
+  // This stuff is needed by the DominatorTree implementation
+  void printAsOperand(llvm::raw_ostream &, bool) const { revng_abort(); }
+};
+
+/// \brief Immutable compressed sparse row copy of a graph
+///
+/// Nodes are stored in a single vector, successors and predecessors of all
+/// the nodes in two flat arrays. This makes traversals, which touch only
+/// these three arrays, considerably cheaper than on the original graph.
+/// FrozenGraph provides GraphTraits, so that the usual algorithms (RPOT, SCCs,
+/// dominator trees, nodesBetween...) can run on it unchanged.
+///
+/// Any GraphTraits can be frozen, including the filtered views of
+/// FilteredGraphTraits.h, whose predicates are then evaluated only once per
+/// edge.
+///
+/// A FrozenGraph cannot be copied nor moved, since nodes point to it.
+///
+/// \warning This class is experimental: it has no users outside of the tests
+///          and the benchmarks yet. Freezing a graph costs about as much as a
+///          traversal of the original graph and saves a fraction of the
+///          following ones (see the frozen-graph microbenchmark), therefore
+///          adopt it only for graphs that are queried many times after being
+///          built, measuring the result.
+template<typename OriginalNodeRef>
+class FrozenGraph {
+public:
+  using Node = FrozenNode<OriginalNodeRef>;
+  using nodes_iterator = typename std::vector<Node>::iterator;
+
+private:
+  friend Node;
+
+private:
+  std::vector<Node> Nodes;
+  std::vector<Node *> Successors;
+  std::vector<Node *> Predecessors;
+  llvm::DenseMap<OriginalNodeRef, uint32_t> Indices;
+  Node *EntryNode = nullptr;
+
+public:
+  FrozenGraph(const FrozenGraph &) = delete;
+  FrozenGraph(FrozenGraph &&) = delete;
+  FrozenGraph &operator=(const FrozenGraph &) = delete;
+  FrozenGraph &operator=(FrozenGraph &&) = delete;
+
+public:
+  /// \brief Freeze all the nodes of \p G
+  ///
+  /// \tparam GT the GraphTraits to use, they need to provide nodes_begin and
+  ///         nodes_end.
+  template<typename GraphT, typename GT = llvm::GraphTraits<GraphT>>
+  static FrozenGraph freeze(GraphT G) {
+    auto Range = llvm::make_range(GT::nodes_begin(G), GT::nodes_end(G));
+    return FrozenGraph(Range, GT::getEntryNode(G), (GT *) nullptr);
+  }
+
+  /// \brief Freeze all the nodes reachable from \p Entry through \p GT
+  ///
+  /// Nodes are numbered in depth first preorder, therefore the entry node
+  /// always has index 0.
+  template<typename GT = llvm::GraphTraits<OriginalNodeRef>>
+  static FrozenGraph freezeReachable(OriginalNodeRef Entry) {
+    using Set = llvm::df_iterator_default_set<OriginalNodeRef>;
+    using DFIterator = llvm::df_iterator<OriginalNodeRef, Set, false, GT>;
+    auto Range = llvm::make_range(DFIterator::begin(Entry),
+                                  DFIterator::end(Entry));
+    return FrozenGraph(Range, Entry, (GT *) nullptr);
+  }
+
+public:
+  size_t size() const { return Nodes.size(); }
+
+  Node *getEntryNode() { return EntryNode; }
+
+  llvm::iterator_range<nodes_iterator> nodes() {
+    return llvm::make_range(Nodes.begin(), Nodes.end());
+  }
+
+  Node *getNodeByIndex(uint32_t Index) {
+    revng_assert(Index < Nodes.size());
+    return &Nodes[Index];
+  }
+
+  /// \brief The node corresponding to \p Original, or nullptr
+  Node *lookup(OriginalNodeRef Original) {
+    auto It = Indices.find(Original);
+    if (It == Indices.end())
+      return nullptr;
+    return &Nodes[It->second];
+  }
+
+private:
+  /// \note Edges towards nodes not in \p Range are dropped
+  template<typename RangeT, typename GT>
+  FrozenGraph(RangeT &&Range, OriginalNodeRef Entry, GT *) {
+    // Number the nodes
+    for (OriginalNodeRef Original : Range) {
+      bool New = Indices.try_emplace(Original, Nodes.size()).second;
+      revng_assert(New);
+      Nodes.emplace_back(Original, this);
+    }
+
+    // Collect the successors and count the predecessors
+    std::vector<uint32_t> SuccessorIndices;
+    std::vector<uint32_t> SuccessorOffsets;
+    std::vector<uint32_t> PredecessorOffsets(Nodes.size() + 1, 0);
+    SuccessorOffsets.reserve(Nodes.size() + 1);
+    for (Node &N : Nodes) {
+      SuccessorOffsets.push_back(SuccessorIndices.size());
+      auto Children = llvm::make_range(GT::child_begin(N.Original),
+                                       GT::child_end(N.Original));
+      for (OriginalNodeRef Child : Children) {
+        auto It = Indices.find(Child);
+        if (It == Indices.end())
+          continue;
+        SuccessorIndices.push_back(It->second);
+        ++PredecessorOffsets[It->second + 1];
+      }
+    }
+    SuccessorOffsets.push_back(SuccessorIndices.size());
+
+    for (size_t I = 1; I < PredecessorOffsets.size(); ++I)
+      PredecessorOffsets[I] += PredecessorOffsets[I - 1];
+
+    // Fill the flat arrays
+    Successors.resize(SuccessorIndices.size());
+    Predecessors.resize(SuccessorIndices.size());
+    std::vector<uint32_t> NextPredecessor(PredecessorOffsets.begin(),
+                                          --PredecessorOffsets.end());
+    for (uint32_t Index = 0; Index < Nodes.size(); ++Index) {
+      for (uint32_t I = SuccessorOffsets[Index];
+           I < SuccessorOffsets[Index + 1];
+           ++I) {
+        uint32_t Successor = SuccessorIndices[I];
+        Successors[I] = &Nodes[Successor];
+        Predecessors[NextPredecessor[Successor]++] = &Nodes[Index];
+      }
+    }
+
+    Node *const *SuccessorsData = Successors.data();
+    Node *const *PredecessorsData = Predecessors.data();
+    for (uint32_t Index = 0; Index < Nodes.size(); ++Index) {
+      Node &N = Nodes[Index];
+      N.SuccessorsBegin = SuccessorsData + SuccessorOffsets[Index];
+      N.SuccessorsEnd = SuccessorsData + SuccessorOffsets[Index + 1];
+      N.PredecessorsBegin = PredecessorsData + PredecessorOffsets[Index];
+      N.PredecessorsEnd = PredecessorsData + PredecessorOffsets[Index + 1];
+    }
+
+    if (Entry != OriginalNodeRef{})
+      EntryNode = lookup(Entry);
+  }
+};
+
+//
+// GraphTraits implementation for FrozenGraph
+//
+namespace llvm {
+
+template<typename T>
+struct GraphTraits<FrozenNode<T> *> {
+  using NodeRef = FrozenNode<T> *;
+  using ChildIteratorType = typename FrozenNode<T>::iterator;
+
+  static ChildIteratorType child_begin(NodeRef N) {
+    return N->successors().begin();
+  }
+
+  static ChildIteratorType child_end(NodeRef N) {
+    return N->successors().end();
+  }
+
+  static NodeRef getEntryNode(NodeRef N) { return N; }
+};
+
+template<typename T>
+struct GraphTraits<Inverse<FrozenNode<T> *>> {
+  using NodeRef = FrozenNode<T> *;
+  using ChildIteratorType = typename FrozenNode<T>::iterator;
+
+  static ChildIteratorType child_begin(NodeRef N) {
+    return N->predecessors().begin();
+  }
+
+  static ChildIteratorType child_end(NodeRef N) {
+    return N->predecessors().end();
+  }
+
+  static NodeRef getEntryNode(Inverse<NodeRef> N) { return N.Graph; }
+};
+
+template<typename T>
+struct GraphTraits<FrozenGraph<T> *> : public GraphTraits<FrozenNode<T> *> {
+  using NodeRef = FrozenNode<T> *;
+
+private:
+  static NodeRef getAddress(FrozenNode<T> &N) { return &N; }
+
+public:
+  using nodes_iterator = mapped_iterator<
+    typename FrozenGraph<T>::nodes_iterator,
+    decltype(&getAddress)>;
+
+  static NodeRef getEntryNode(FrozenGraph<T> *G) { return G->getEntryNode(); }
+
+  static nodes_iterator nodes_begin(FrozenGraph<T> *G) {
+    return nodes_iterator(G->nodes().begin(), getAddress);
+  }
+
+  static nodes_iterator nodes_end(FrozenGraph<T> *G) {
+    return nodes_iterator(G->nodes().end(), getAddress);
+  }
+
+  static size_t size(FrozenGraph<T> *G) { return G->size(); }
+};
+
+} // namespace llvm
@@ -4,11 +4,19 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
 #include <type_traits>
+#include <vector>
 
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/iterator.h"
+#include "llvm/Support/MathExtras.h"
 
 #include "revng/Support/Debug.h"
 
@@ -16,7 +24,33 @@ struct Empty {
   bool operator==(const Empty &) const { return true; }
 };
 
-template<typename Node, size_t SmallSize = 16, bool HasEntryNode = true>
+//
+// Allocation policies for the nodes of GenericGraph
+//
+
+/// Each node is allocated on the heap on its own
+struct HeapNodes {};
+
+/// Nodes are allocated in chunks of \p ChunkSize nodes and addressed by a dense
+/// 32-bit index
+template<size_t ChunkSize = 1024>
+struct ChunkedNodes {};
+
+/// \brief Allocation policy used by default for the GenericGraphs of \p Node
+///
+/// Specialize this to switch all the GenericGraphs of a certain node type to a
+/// different policy. This is the only way to change the policy for nodes with
+/// a parent pointer, since the parent type is computed with the default
+/// template arguments of GenericGraph.
+template<typename Node>
+struct GenericGraphAllocation {
+  using type = HeapNodes;
+};
+
+template<typename Node,
+         size_t SmallSize = 16,
+         bool HasEntryNode = true,
+         typename Allocation = typename GenericGraphAllocation<Node>::type>
 class GenericGraph;
 
 template<typename T, typename BaseType>
@@ -369,44 +403,283 @@ public:
   void setEntryNode(NodeT *EntryNode) { this->EntryNode = EntryNode; }
 };
 
+namespace detail {
+
+template<typename NodeT, size_t SmallSize, typename Allocation>
+class NodeStorage;
+
+/// Nodes owned through std::unique_ptr, in a SmallVector
+template<typename NodeT, size_t SmallSize>
+class NodeStorage<NodeT, SmallSize, HeapNodes> {
+private:
+  using Container = llvm::SmallVector<std::unique_ptr<NodeT>, SmallSize>;
+
+  static NodeT *getNode(std::unique_ptr<NodeT> &E) { return E.get(); }
+  static const NodeT *getConstNode(const std::unique_ptr<NodeT> &E) {
+    return E.get();
+  }
+
+public:
+  // TODO: these iterators will not work with llvm::filter_iterator,
+  //       since the mapped type is not a reference
+  using iterator = llvm::mapped_iterator<typename Container::iterator,
+                                         decltype(&getNode)>;
+  using const_iterator = llvm::mapped_iterator<
+    typename Container::const_iterator,
+    decltype(&getConstNode)>;
+
+public:
+  iterator begin() { return iterator(Nodes.begin(), getNode); }
+  iterator end() { return iterator(Nodes.end(), getNode); }
+  const_iterator begin() const {
+    return const_iterator(Nodes.begin(), getConstNode);
+  }
+  const_iterator end() const {
+    return const_iterator(Nodes.end(), getConstNode);
+  }
+
+  size_t size() const { return Nodes.size(); }
+
+  template<class... Args>
+  NodeT *emplace(Args &&...A) {
+    Nodes.push_back(std::make_unique<NodeT>(std::forward<Args>(A)...));
+    return Nodes.back().get();
+  }
+
+  iterator erase(iterator It) {
+    return iterator(Nodes.erase(It.getCurrent()), getNode);
+  }
+
+private:
+  Container Nodes;
+};
+
+/// Nodes constructed in place in fixed-size chunks
+///
+/// Each node is identified by a dense 32-bit index, assigned in order of
+/// creation. Removed nodes leave a hole, so that indices and addresses of the
+/// other nodes remain stable. Since memory is released a chunk at a time,
+/// destroying the storage only costs the destructors of the nodes, which are
+/// skipped altogether if they are trivial.
+template<typename NodeT, size_t SmallSize, size_t ChunkSize>
+class NodeStorage<NodeT, SmallSize, ChunkedNodes<ChunkSize>> {
+  static_assert(llvm::isPowerOf2_64(ChunkSize));
+
+private:
+  struct alignas(NodeT) Slot {
+    std::byte Data[sizeof(NodeT)];
+  };
+
+  template<typename StorageT, typename T>
+  class IteratorImpl
+    : public llvm::iterator_facade_base<IteratorImpl<StorageT, T>,
+                                        std::forward_iterator_tag,
+                                        T *,
+                                        std::ptrdiff_t,
+                                        T **,
+                                        T *> {
+  private:
+    StorageT *Storage = nullptr;
+    uint32_t Index = 0;
+    /// The node at Index, nullptr at the end
+    T *Current = nullptr;
+
+  public:
+    IteratorImpl() = default;
+    IteratorImpl(StorageT *Storage, uint32_t Index) :
+      Storage(Storage), Index(Index) {
+      update();
+    }
+
+    bool operator==(const IteratorImpl &Other) const {
+      return Index == Other.Index;
+    }
+
+    T *operator*() const { return Current; }
+
+    IteratorImpl &operator++() {
+      if (Storage->LiveCount == Storage->Live.size()) {
+        // No node has been removed, within a chunk nodes are contiguous
+        ++Index;
+        if (Index % ChunkSize != 0 and Index < Storage->Live.size())
+          ++Current;
+        else
+          update();
+      } else {
+        Index = Storage->nextLive(Index);
+        update();
+      }
+      return *this;
+    }
+
+    uint32_t index() const { return Index; }
+
+  private:
+    void update() {
+      bool End = Index >= Storage->Live.size();
+      Current = End ? nullptr : Storage->slot(Index);
+    }
+  };
+
+public:
+  using iterator = IteratorImpl<NodeStorage, NodeT>;
+  using const_iterator = IteratorImpl<const NodeStorage, const NodeT>;
+
+public:
+  NodeStorage() = default;
+  ~NodeStorage() { destroyAll(); }
+
+  NodeStorage(const NodeStorage &) = delete;
+  NodeStorage &operator=(const NodeStorage &) = delete;
+
+  NodeStorage(NodeStorage &&Other) { *this = std::move(Other); }
+  NodeStorage &operator=(NodeStorage &&Other) {
+    if (this != &Other) {
+      destroyAll();
+      Chunks = std::move(Other.Chunks);
+      SortedChunks = std::move(Other.SortedChunks);
+      Live = std::move(Other.Live);
+      LiveCount = Other.LiveCount;
+      Other.Chunks.clear();
+      Other.SortedChunks.clear();
+      Other.Live.clear();
+      Other.LiveCount = 0;
+    }
+    return *this;
+  }
+
+public:
+  iterator begin() { return iterator(this, nextLive(-1)); }
+  iterator end() { return iterator(this, Live.size()); }
+  const_iterator begin() const { return const_iterator(this, nextLive(-1)); }
+  const_iterator end() const { return const_iterator(this, Live.size()); }
+
+  size_t size() const { return LiveCount; }
+
+  /// \brief One past the highest index assigned to a node so far
+  uint32_t indexLimit() const { return Live.size(); }
+
+  NodeT *at(uint32_t Index) {
+    revng_assert(Index < Live.size() and Live[Index]);
+    return slot(Index);
+  }
+
+  const NodeT *at(uint32_t Index) const {
+    revng_assert(Index < Live.size() and Live[Index]);
+    return slot(Index);
+  }
+
+  uint32_t indexOf(const NodeT *Node) const {
+    auto *Pointer = reinterpret_cast<const Slot *>(Node);
+
+    // Find the last chunk starting at or before Node
+    auto Compare = [](const Slot *Pointer, const auto &Entry) {
+      return Pointer < Entry.first;
+    };
+    auto It = std::upper_bound(SortedChunks.begin(),
+                               SortedChunks.end(),
+                               Pointer,
+                               Compare);
+    revng_assert(It != SortedChunks.begin());
+    --It;
+
+    auto Offset = Pointer - It->first;
+    revng_assert(Offset >= 0 and static_cast<size_t>(Offset) < ChunkSize);
+    uint32_t Index = It->second * ChunkSize + Offset;
+    revng_assert(Index < Live.size() and Live[Index]);
+    return Index;
+  }
+
+  template<class... Args>
+  NodeT *emplace(Args &&...A) {
+    size_t Index = Live.size();
+    revng_assert(Index < UINT32_MAX);
+
+    if (Index % ChunkSize == 0) {
+      Chunks.emplace_back(new Slot[ChunkSize]);
+      std::pair<const Slot *, uint32_t> Entry = { Chunks.back().get(),
+                                                  Chunks.size() - 1 };
+      auto Position = std::upper_bound(SortedChunks.begin(),
+                                       SortedChunks.end(),
+                                       Entry);
+      SortedChunks.insert(Position, Entry);
+    }
+
+    NodeT *Result = new (slot(Index)) NodeT(std::forward<Args>(A)...);
+    Live.push_back(true);
+    ++LiveCount;
+    return Result;
+  }
+
+  iterator erase(iterator It) {
+    uint32_t Index = It.index();
+    at(Index)->~NodeT();
+    Live.reset(Index);
+    --LiveCount;
+    return iterator(this, nextLive(Index));
+  }
+
+private:
+  NodeT *slot(uint32_t Index) const {
+    Slot &Result = Chunks[Index / ChunkSize][Index % ChunkSize];
+    return std::launder(reinterpret_cast<NodeT *>(&Result));
+  }
+
+  uint32_t nextLive(int Index) const {
+    int Result = Live.find_next(Index);
+    return Result == -1 ? Live.size() : Result;
+  }
+
+  void destroyAll() {
+    if constexpr (not std::is_trivially_destructible_v<NodeT>)
+      for (unsigned Index : Live.set_bits())
+        slot(Index)->~NodeT();
+  }
+
+  template<typename, typename>
+  friend class IteratorImpl;
+
+private:
+  std::vector<std::unique_ptr<Slot[]>> Chunks;
+  /// Start address of each chunk along with its index, sorted by address
+  std::vector<std::pair<const Slot *, uint32_t>> SortedChunks;
+  /// Indices of the nodes that have not been removed
+  llvm::BitVector Live;
+  size_t LiveCount = 0;
+};
+
+} // namespace detail
+
 /// Generic graph parametrized in the node type
 ///
 /// This graph owns its nodes (but not the edges).
 /// It can optionally have an elected entry point.
-template<typename NodeT, size_t SmallSize, bool HasEntryNode>
+/// How nodes are allocated depends on \p Allocation, see
+/// GenericGraphAllocation.
+template<typename NodeT,
+         size_t SmallSize,
+         bool HasEntryNode,
+         typename Allocation>
 class GenericGraph
   : public std::conditional_t<HasEntryNode, EntryNode<NodeT>, Empty> {
 public:
   static const bool is_generic_graph = true;
-  using NodesContainer = llvm::SmallVector<std::unique_ptr<NodeT>, SmallSize>;
+  using NodesContainer = detail::NodeStorage<NodeT, SmallSize, Allocation>;
   using Node = NodeT;
   static constexpr bool hasEntryNode = HasEntryNode;
-
-private:
-  using nodes_iterator_impl = typename NodesContainer::iterator;
-  using const_nodes_iterator_impl = typename NodesContainer::const_iterator;
+  static constexpr bool hasNodeIndices = not std::is_same_v<Allocation,
+                                                            HeapNodes>;
 
 public:
-  static NodeT *getNode(std::unique_ptr<NodeT> &E) { return E.get(); }
-  static const NodeT *getConstNode(const std::unique_ptr<NodeT> &E) {
-    return E.get();
-  }
-
-  // TODO: these iterators will not work with llvm::filter_iterator,
-  //       since the mapped type is not a reference
-  using nodes_iterator = llvm::mapped_iterator<nodes_iterator_impl,
-                                               decltype(&getNode)>;
-  using const_nodes_iterator = llvm::mapped_iterator<const_nodes_iterator_impl,
-                                                     decltype(&getConstNode)>;
+  using nodes_iterator = typename NodesContainer::iterator;
+  using const_nodes_iterator = typename NodesContainer::const_iterator;
 
   llvm::iterator_range<nodes_iterator> nodes() {
-    return llvm::map_range(llvm::make_range(Nodes.begin(), Nodes.end()),
-                           getNode);
+    return llvm::make_range(Nodes.begin(), Nodes.end());
   }
 
   llvm::iterator_range<const_nodes_iterator> nodes() const {
-    return llvm::map_range(llvm::make_range(Nodes.begin(), Nodes.end()),
-                           getConstNode);
+    return llvm::make_range(Nodes.begin(), Nodes.end());
   }
 
   size_t size() const { return Nodes.size(); }
@@ -414,17 +687,46 @@ public:
 public:
   template<class... Args>
   NodeT *addNode(Args &&...A) {
-    Nodes.push_back(std::make_unique<NodeT>(std::forward<Args>(A)...));
-    if constexpr (NodeT::has_parent)
-      Nodes.back()->setParent(this);
-    return Nodes.back().get();
+    NodeT *Result = Nodes.emplace(std::forward<Args>(A)...);
+    if constexpr (NodeT::has_parent) {
+      static_assert(std::is_same_v<decltype(Result->getParent()),
+                                   GenericGraph *>,
+                    "The allocation policy of a graph whose nodes have a "
+                    "parent can only be changed through "
+                    "GenericGraphAllocation");
+      Result->setParent(this);
+    }
+    return Result;
+  }
+
+  nodes_iterator removeNode(nodes_iterator It) { return Nodes.erase(It); }
+
+public:
+  /// \name Dense node indices
+  ///
+  /// Only available for policies other than HeapNodes. Indices are assigned in
+  /// order of creation and are not reused after a node is removed.
+  /// @{
+
+  /// \brief One past the highest index assigned to a node so far
+  uint32_t nodeIndexLimit() const requires hasNodeIndices {
+    return Nodes.indexLimit();
+  }
+
+  NodeT *getNodeByIndex(uint32_t Index) requires hasNodeIndices {
+    return Nodes.at(Index);
   }
 
-  nodes_iterator removeNode(nodes_iterator It) {
-    auto InternalIt = Nodes.erase(It.getCurrent());
-    return nodes_iterator(InternalIt, getNode);
+  const NodeT *getNodeByIndex(uint32_t Index) const requires hasNodeIndices {
+    return Nodes.at(Index);
   }
 
+  uint32_t getNodeIndex(const NodeT *Node) const requires hasNodeIndices {
+    return Nodes.indexOf(Node);
+  }
+
+  /// @}
+
 private:
   NodesContainer Nodes;
 };
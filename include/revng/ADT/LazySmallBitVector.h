@@ -4,10 +4,12 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <bit>
 #include <climits>
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <type_traits>
 
 #include "boost/iterator/iterator_facade.hpp"
 
@@ -15,18 +17,10 @@
 
 // TODO: implement shrinking
 
-// TODO: implement using __builtin_clz if available
 /// \brief Returns the minimum amount of bits required to represent \p Value
 template<typename T>
 inline unsigned requiredBits(T Value) {
-  unsigned Result = 0;
-
-  while (Value != 0) {
-    Result++;
-    Value = Value >> 1;
-  }
-
-  return Result;
+  return std::bit_width(static_cast<std::make_unsigned_t<T>>(Value));
 }
 
 template<typename T, typename A, typename B>
@@ -123,6 +117,10 @@ private:
       return Storage[Index];
     }
 
+    /// Unchecked access to the words, for loops over the whole storage
+    uintptr_t *data() { return Storage; }
+    const uintptr_t *data() const { return Storage; }
+
     const uintptr_t &at(size_t Index) const {
       revng_assert(Index < wordCount());
       return Storage[Index];
@@ -584,31 +582,131 @@ public:
 
   /// \brief Returns the 1-based index of the next set bit after \p StartIndex
   ///
+  /// Whole words of zeros are skipped at once.
+  ///
   /// \return 0 if no bits are set after \p StartIndex, the 1-based index of the
   ///         next bit set otherwise
   unsigned findNext(unsigned StartIndex) const {
-    if (StartIndex >= requiredBits())
+    if (StartIndex >= capacity())
       return 0;
 
     if (isSmall()) {
-      return StartIndex + findFirstBit(getSmall() >> StartIndex);
-    } else {
-      const LargeStorage &Large = getLarge();
-      unsigned Index = StartIndex / BitsPerPointer;
-      unsigned ShiftAmount = StartIndex % BitsPerPointer;
+      uintptr_t Value = getSmall() >> StartIndex;
+      return Value == 0 ? 0 : StartIndex + findFirstBit(Value);
+    }
+
+    const LargeStorage &Large = getLarge();
+    const uintptr_t *Words = Large.data();
+    unsigned Index = StartIndex / BitsPerPointer;
+
+    uintptr_t FirstValue = Words[Index] >> (StartIndex % BitsPerPointer);
+    if (FirstValue != 0)
+      return StartIndex + findFirstBit(FirstValue);
+
+    for (Index++; Index < Large.wordCount(); Index++)
+      if (Words[Index] != 0)
+        return Index * BitsPerPointer + findFirstBit(Words[Index]);
+
+    return 0;
+  }
+
+  /// \brief Returns the number of set bits
+  unsigned count() const {
+    if (isSmall())
+      return std::popcount(getSmall());
+
+    const LargeStorage &Large = getLarge();
+    const uintptr_t *Words = Large.data();
+    unsigned Result = 0;
+    for (unsigned I = 0; I < Large.wordCount(); I++)
+      Result += std::popcount(Words[I]);
+
+    return Result;
+  }
+
+  /// \brief Perform `*this |= Other`, reporting if anything changed
+  ///
+  /// This is the join of a powerset lattice and the check for a change, fused
+  /// in a single pass over the storage.
+  ///
+  /// \return true if \p Other had bits not set in this bit vector
+  bool orInPlaceChanged(const LazySmallBitVector &Other) {
+    // Ensure we have at least the same capacity as Other
+    if (Other.capacity() > this->capacity())
+      alloc(Other.capacity());
 
-      uintptr_t FirstValue = Large.at(Index) >> ShiftAmount;
-      if (FirstValue != 0)
-        return StartIndex + findFirstBit(FirstValue);
+    if (isSmall()) {
+      revng_assert(Other.isSmall());
+      uintptr_t Old = Storage;
+      Storage = Storage | Other.Storage;
+      return Storage != Old;
+    }
 
-      do {
-        Index++;
-        if (Index * BitsPerPointer >= capacity())
-          return 0;
-      } while (Large.at(Index) == 0);
+    LargeStorage &ThisLarge = getLarge();
+    if (Other.isSmall()) {
+      uintptr_t &Word = ThisLarge.at(0);
+      uintptr_t Old = Word;
+      Word = Word | Other.getSmall();
+      return Word != Old;
+    }
 
-      return Index * BitsPerPointer + findFirstBit(Large.at(Index));
+    const LargeStorage &OtherLarge = Other.getLarge();
+    uintptr_t *Destination = ThisLarge.data();
+    const uintptr_t *Source = OtherLarge.data();
+    uintptr_t NewBits = 0;
+    for (unsigned I = 0; I < OtherLarge.wordCount(); I++) {
+      NewBits = NewBits | (Source[I] & ~Destination[I]);
+      Destination[I] = Destination[I] | Source[I];
     }
+
+    return NewBits != 0;
+  }
+
+  /// \brief Perform `*this &= ~Other`
+  LazySmallBitVector &andNot(const LazySmallBitVector &Other) {
+    if (isSmall()) {
+      uintptr_t OtherValue;
+      if (Other.isSmall())
+        OtherValue = Other.getSmall();
+      else
+        OtherValue = Other.getLarge().at(0);
+
+      setSmall(getSmall() & ~OtherValue);
+      return *this;
+    }
+
+    LargeStorage &ThisLarge = getLarge();
+    if (Other.isSmall()) {
+      ThisLarge.at(0) = ThisLarge.at(0) & ~Other.getSmall();
+      return *this;
+    }
+
+    const LargeStorage &OtherLarge = Other.getLarge();
+    uintptr_t *Destination = ThisLarge.data();
+    const uintptr_t *Source = OtherLarge.data();
+    unsigned Max = std::min(ThisLarge.wordCount(), OtherLarge.wordCount());
+    for (unsigned I = 0; I < Max; I++)
+      Destination[I] = Destination[I] & ~Source[I];
+
+    return *this;
+  }
+
+  /// \brief Returns true if all the bits set in this are also set in \p Other
+  bool isSubsetOf(const LazySmallBitVector &Other) const {
+    if (isSmall() or Other.isSmall())
+      return (word(0) & ~Other.word(0)) == 0 and wordsAfterAreZero(1);
+
+    const LargeStorage &ThisLarge = getLarge();
+    const LargeStorage &OtherLarge = Other.getLarge();
+    const uintptr_t *ThisWords = ThisLarge.data();
+    const uintptr_t *OtherWords = OtherLarge.data();
+    unsigned Max = std::min(ThisLarge.wordCount(), OtherLarge.wordCount());
+
+    uintptr_t Extra = 0;
+    for (unsigned I = 0; I < Max; I++)
+      Extra = Extra | (ThisWords[I] & ~OtherWords[I]);
+
+    return Extra == 0 and wordsAfterAreZero(Max);
   }
 
   const_iterator begin() const { return const_iterator(this); }
@@ -632,6 +730,28 @@ private:
     return Storage >> 1;
   }
 
+  /// \brief Returns the \p Index-th word, 0 if it's beyond the capacity
+  uintptr_t word(unsigned Index) const {
+    if (isSmall())
+      return Index == 0 ? getSmall() : 0;
+
+    const LargeStorage &Large = getLarge();
+    return Index < Large.wordCount() ? Large.data()[Index] : 0;
+  }
+
+  bool wordsAfterAreZero(unsigned Index) const {
+    if (isSmall())
+      return Index > 0 or getSmall() == 0;
+
+    const LargeStorage &Large = getLarge();
+    const uintptr_t *Words = Large.data();
+    for (unsigned I = Index; I < Large.wordCount(); I++)
+      if (Words[I] != 0)
+        return false;
+
+    return true;
+  }
+
   void setSmall(uintptr_t Value) {
     revng_assert(isSmall());
     Storage = (Value << 1) | 1;
@@ -4,15 +4,74 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <cstddef>
 #include <queue>
 #include <set>
+#include <type_traits>
+#include <vector>
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 
 #include "revng/Support/Assert.h"
 
+/// \brief Describes how to map elements of type T to dense integer IDs
+///
+/// Specialize this for types that can be cheaply numbered densely (e.g., basic
+/// block indices) to have UniquedQueue and OnceQueue use a bit vector to track
+/// membership in place of a std::set. The specialization must provide:
+///
+/// * `static constexpr bool IsDense = true;`
+/// * `static size_t toID(T)`;
+/// * `static T fromID(size_t)`.
+///
+/// IDs should be small, since the bit vector grows up to the largest ID seen.
+///
+/// \note Pointers do not need a specialization: they are numbered in order of
+///       first insertion (see InsertionNumbering).
+template<typename T>
+struct DenseQueueKey {
+  static constexpr bool IsDense = false;
+};
+
+template<typename T>
+concept HasDenseID = DenseQueueKey<T>::IsDense;
+
+/// \brief Numbering of the elements provided by DenseQueueKey
+template<typename T>
+struct KeyNumbering {
+  static size_t id(T Element) { return DenseQueueKey<T>::toID(Element); }
+  static T element(size_t ID) { return DenseQueueKey<T>::fromID(ID); }
+};
+
+/// \brief Numbering of the elements in order of first insertion
+///
+/// The IDs are never released, therefore a queue that is cleared and reused
+/// does not have to number its elements again.
+template<typename T>
+class InsertionNumbering {
+private:
+  llvm::DenseMap<T, unsigned> IDs;
+  std::vector<T> Elements;
+
+public:
+  size_t id(T Element) {
+    auto [It, New] = IDs.try_emplace(Element, Elements.size());
+    if (New)
+      Elements.push_back(Element);
+    return It->second;
+  }
+
+  T element(size_t ID) const { return Elements[ID]; }
+};
+
 /// \brief Queue where an element cannot be re-inserted if it's already in the
 ///        queue
+///
+/// This is the generic implementation, membership is tracked with a std::set.
 template<typename T, bool Once>
-class QueueImpl {
+class SetQueueImpl {
 public:
   void insert(T Element) {
     if (Set.count(Element) == 0) {
@@ -50,6 +109,104 @@ private:
   std::queue<T> Queue;
 };
 
+/// \brief Queue where an element cannot be re-inserted if it's already in the
+///        queue, for elements with a dense ID
+///
+/// Membership is tracked by a bit vector indexed by ID and the IDs of the
+/// elements are kept in a ring buffer, therefore, once the buffers have grown,
+/// pop does not allocate and insert only looks up the ID of the element.
+///
+/// \tparam Numbering maps elements to IDs and back, see KeyNumbering and
+///         InsertionNumbering.
+template<typename T, bool Once, typename Numbering>
+class DenseQueueImpl {
+public:
+  void insert(T Element) {
+    size_t ID = Numbers.id(Element);
+    if (ID >= Members.size())
+      Members.resize(std::max<size_t>(ID + 1, 2 * Members.size()));
+
+    if (Members.test(ID))
+      return;
+
+    Members.set(ID);
+    push(ID);
+  }
+
+  bool empty() const { return Count == 0; }
+
+  T head() const {
+    revng_assert(not empty());
+    return Numbers.element(Buffer[Head]);
+  }
+
+  T pop() {
+    revng_assert(not empty());
+    size_t ID = Buffer[Head];
+    Head = (Head + 1) & (Buffer.size() - 1);
+    --Count;
+    if (!Once)
+      Members.reset(ID);
+    return Numbers.element(ID);
+  }
+
+  size_t size() const { return Count; }
+
+  std::set<T> visited() {
+    revng_assert(Once);
+    std::set<T> Result;
+    for (unsigned ID : Members.set_bits())
+      Result.insert(Numbers.element(ID));
+    Members.clear();
+    return Result;
+  }
+
+  /// \note The storage is retained, so that the queue can be reused
+  void clear() {
+    Members.reset();
+    Head = 0;
+    Count = 0;
+  }
+
+private:
+  void push(size_t ID) {
+    if (Count == Buffer.size())
+      grow();
+    Buffer[(Head + Count) & (Buffer.size() - 1)] = ID;
+    ++Count;
+  }
+
+  /// Double the size of the ring buffer, moving the elements at its beginning
+  void grow() {
+    std::vector<size_t> NewBuffer(std::max<size_t>(16, 2 * Buffer.size()));
+    for (size_t I = 0; I < Count; ++I)
+      NewBuffer[I] = Buffer[(Head + I) & (Buffer.size() - 1)];
+    Buffer = std::move(NewBuffer);
+    Head = 0;
+  }
+
+private:
+  Numbering Numbers;
+  llvm::BitVector Members;
+  /// Ring buffer of IDs, its size is always a power of two
+  std::vector<size_t> Buffer;
+  size_t Head = 0;
+  size_t Count = 0;
+};
+
+/// \brief Queue where an element cannot be re-inserted if it's already in the
+///        queue
+///
+/// Elements with a dense ID (see DenseQueueKey) and pointers, numbered on
+/// insertion, use DenseQueueImpl, all the others SetQueueImpl.
+template<typename T, bool Once>
+using QueueImpl = std::conditional_t<
+  HasDenseID<T>,
+  DenseQueueImpl<T, Once, KeyNumbering<T>>,
+  std::conditional_t<std::is_pointer_v<T>,
+                     DenseQueueImpl<T, Once, InsertionNumbering<T>>,
+                     SetQueueImpl<T, Once>>>;
+
 template<typename T>
 using UniquedQueue = QueueImpl<T, false>;
 
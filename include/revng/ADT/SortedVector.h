@@ -4,12 +4,18 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "llvm/ADT/STLExtras.h"
 
 #include "revng/ADT/KeyedObjectContainer.h"
 #include "revng/ADT/KeyedObjectTraits.h"
 #include "revng/Support/Assert.h"
 
+/// \brief Like std::unique, but keeps the last element of each run of
+///        equivalent elements
 template<class ForwardIt, class BinaryPredicate>
 ForwardIt
 unique_last(ForwardIt First, ForwardIt Last, BinaryPredicate Predicate) {
@@ -18,9 +24,11 @@ unique_last(ForwardIt First, ForwardIt Last, BinaryPredicate Predicate) {
 
   ForwardIt Result = First;
   while (++First != Last) {
-    if (not Predicate(*Result, *First) and ++Result != First) {
+    if (Predicate(*Result, *First)) {
+      // Equivalent to the current element, replace it
       *Result = std::move(*First);
-    } else {
+    } else if (++Result != First) {
+      // Distinct element, move it next to the previous one, if necessary
       *Result = std::move(*First);
     }
   }
@@ -28,6 +36,32 @@ unique_last(ForwardIt First, ForwardIt Last, BinaryPredicate Predicate) {
   return ++Result;
 }
 
+/// \brief Like std::lower_bound, but performs an exponential search starting
+///        from \p First
+///
+/// The cost is logarithmic in the distance between \p First and the result,
+/// rather than in the size of the range. This is convenient when merging
+/// sorted ranges, where the result is often close to \p First.
+template<class RandomIt, class T, class Compare>
+RandomIt galloping_lower_bound(RandomIt First,
+                               RandomIt Last,
+                               const T &Value,
+                               Compare C) {
+  using traits = std::iterator_traits<RandomIt>;
+  using difference_type = typename traits::difference_type;
+  difference_type Size = Last - First;
+  difference_type Step = 1;
+  difference_type Low = 0;
+
+  // Find a range [Low, Step] containing the result
+  while (Step < Size and C(First[Step - 1], Value)) {
+    Low = Step;
+    Step *= 2;
+  }
+
+  return std::lower_bound(First + Low, First + std::min(Step, Size), Value, C);
+}
+
 template<HasKeyObjectTraits T, class Compare>
 class SortedVector {
 public:
@@ -60,11 +94,16 @@ private:
 public:
   SortedVector() {}
 
-  SortedVector(std::initializer_list<T> List) {
-    auto Inserter = batch_insert_or_assign();
-    for (const T &Element : List) {
-      Inserter.insert_or_assign(Element);
-    }
+  SortedVector(std::initializer_list<T> List) :
+    SortedVector(List.begin(), List.end()) {}
+
+  /// \brief Build from a range of elements, in any order
+  ///
+  /// In case of elements with the same key, the last one is kept. If the
+  /// range is already sorted, the cost is linear.
+  template<typename InputIt>
+  SortedVector(InputIt First, InputIt Last) : TheVector(First, Last) {
+    sort<false>(0);
   }
 
 public:
@@ -288,13 +327,21 @@ public:
   }
 
 public:
+  /// \brief Insert elements in bulk
+  ///
+  /// Elements are appended and the container is fixed up on commit: the new
+  /// elements are sorted (unless they already are), deduplicated and then
+  /// merged with the preexisting ones in linear time. Therefore, inserting
+  /// the elements in order is cheaper.
   template<bool KeepFirst>
   class BatchInserterBase {
   private:
     SortedVector *SV;
+    size_t SortedPrefix;
 
   public:
-    BatchInserterBase(SortedVector &SV) : SV(&SV) {
+    BatchInserterBase(SortedVector &SV) :
+      SV(&SV), SortedPrefix(SV.TheVector.size()) {
       revng_assert(not SV.BatchInsertInProgress);
       SV.BatchInsertInProgress = true;
     }
@@ -304,12 +351,15 @@ public:
 
     BatchInserterBase(BatchInserterBase &&Other) {
       SV = Other.SV;
+      SortedPrefix = Other.SortedPrefix;
       Other.SV = nullptr;
     }
 
     BatchInserterBase &operator=(BatchInserterBase &&Other) {
       SV = Other.SV;
+      SortedPrefix = Other.SortedPrefix;
       Other.SV = nullptr;
+      return *this;
     }
 
     ~BatchInserterBase() { commit(); }
@@ -317,7 +367,7 @@ public:
     void commit() {
       if (SV != nullptr && SV->BatchInsertInProgress) {
         SV->BatchInsertInProgress = false;
-        SV->sort<KeepFirst>();
+        SV->sort<KeepFirst>(SortedPrefix);
       }
     }
 
@@ -374,18 +424,88 @@ private:
     return not compareKeys(LHS, RHS) and not compareKeys(RHS, LHS);
   }
 
+  /// \brief Restore the invariants after unsorted elements have been
+  ///        appended
+  ///
+  /// \param SortedPrefix number of elements at the beginning of the vector
+  ///        that are known to be sorted and unique.
+  /// \tparam KeepFirst in case of duplicates, prefer the element that has
+  ///         been inserted first.
   template<bool KeepFirst>
-  void sort() {
-    // Sort
-    std::stable_sort(begin(), end(), compareElements);
-
-    // Remove duplicates keeping the last instance of each element
-    auto NewEnd = end();
-    if (KeepFirst) {
-      NewEnd = std::unique(begin(), end(), elementsEqual);
+  void sort(size_t SortedPrefix) {
+    revng_assert(SortedPrefix <= TheVector.size());
+    auto Begin = TheVector.begin();
+    auto Middle = Begin + SortedPrefix;
+
+    // Sort the new elements, unless they're already sorted
+    if (not std::is_sorted(Middle, TheVector.end(), compareElements))
+      std::stable_sort(Middle, TheVector.end(), compareElements);
+
+    // Remove duplicates among the new elements
+    auto NewEnd = TheVector.end();
+    if constexpr (KeepFirst) {
+      NewEnd = std::unique(Middle, TheVector.end(), elementsEqual);
     } else {
-      NewEnd = unique_last(begin(), end(), elementsEqual);
+      NewEnd = unique_last(Middle, TheVector.end(), elementsEqual);
+    }
+    TheVector.erase(NewEnd, TheVector.end());
+
+    // Fast path: all the new elements go after the existing ones
+    if (Middle == Begin or Middle == TheVector.end()
+        or compareElements(*(Middle - 1), *Middle))
+      return;
+
+    merge<KeepFirst>(SortedPrefix);
+  }
+
+  /// \brief Merge the sorted and unique ranges [0, Middle) and
+  ///        [Middle, size())
+  template<bool KeepFirst>
+  void merge(size_t Middle) {
+    vector_type Result;
+    Result.reserve(TheVector.size());
+
+    auto Old = TheVector.begin();
+    auto OldEnd = Old + Middle;
+    auto New = OldEnd;
+    auto NewEnd = TheVector.end();
+    auto Append = [&Result](auto First, auto Last) {
+      Result.insert(Result.end(),
+                    std::make_move_iterator(First),
+                    std::make_move_iterator(Last));
+    };
+
+    while (Old != OldEnd and New != NewEnd) {
+      // Move all the old elements preceding the current new one
+      auto OldRunEnd = galloping_lower_bound(Old,
+                                             OldEnd,
+                                             *New,
+                                             compareElements);
+      Append(Old, OldRunEnd);
+      Old = OldRunEnd;
+      if (Old == OldEnd)
+        break;
+
+      // Handle duplicates
+      if (elementsEqual(*Old, *New)) {
+        Result.push_back(std::move(KeepFirst ? *Old : *New));
+        ++Old;
+        ++New;
+        continue;
+      }
+
+      // Move all the new elements preceding the current old one
+      auto NewRunEnd = galloping_lower_bound(New,
+                                             NewEnd,
+                                             *Old,
+                                             compareElements);
+      Append(New, NewRunEnd);
+      New = NewRunEnd;
     }
-    TheVector.erase(NewEnd, end());
+
+    Append(Old, OldEnd);
+    Append(New, NewEnd);
+
+    TheVector = std::move(Result);
   }
 };
@@ -4,7 +4,12 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #include "llvm/Support/Casting.h"
@@ -83,74 +88,126 @@ void upcast(P &Upcastable, const L &Callable) {
   upcast(Upcastable, Wrapper, false);
 }
 
-/// A unique_ptr copiable thanks to LLVM RTTI
+/// A copiable, nullable owner of a T, with inline storage
+///
+/// Instead of heap-allocating the pointee, all the types listed in
+/// `concrete_types_traits<T>` are stored in-place, in a buffer large enough
+/// for the largest of them, and a discriminant keeps track of which one (if
+/// any) is currently alive. This avoids an allocation and a pointer chase for
+/// each object, which matters for containers of small polymorphic objects
+/// such as `model::FunctionEdge`.
+///
+/// \note Since the object lives within the UpcastablePointer, moving the
+///       UpcastablePointer moves the pointee too: pointers obtained through
+///       `get()` do not survive a move of the owner (e.g., a reallocation of
+///       the container holding it).
 template<Upcastable T>
 class UpcastablePointer {
 private:
-  template<Upcastable P>
-  static P *clone(P *Pointer) {
-    auto Dispatcher = [](auto &Upcasted) -> P * {
-      using type = std::remove_reference_t<decltype(Upcasted)>;
-      return new type(Upcasted);
-    };
-    return ::upcast(Pointer, Dispatcher, static_cast<P *>(nullptr));
+  using concrete_types = concrete_types_traits_t<T>;
+  static constexpr size_t TypesCount = std::tuple_size_v<concrete_types>;
+  static_assert(TypesCount < std::numeric_limits<uint8_t>::max());
+
+  /// Discriminant value representing the null pointer
+  static constexpr uint8_t Null = TypesCount;
+
+  template<typename C, size_t I = 0>
+  static constexpr uint8_t indexOf() {
+    static_assert(I < TypesCount, "Type not in concrete_types_traits");
+    if constexpr (std::is_same_v<C, std::tuple_element_t<I, concrete_types>>)
+      return I;
+    else
+      return indexOf<C, I + 1>();
   }
 
-  template<Upcastable P>
-  static void destroy(P *Pointer) {
-    ::upcast(Pointer, [](auto &Upcasted) { delete &Upcasted; });
+  template<typename Tuple>
+  struct StorageTraits;
+
+  template<typename... Ts>
+  struct StorageTraits<std::tuple<Ts...>> {
+    static_assert((std::is_base_of_v<T, Ts> and ...));
+    static constexpr size_t Size = std::max({ sizeof(Ts)... });
+    static constexpr size_t Alignment = std::max({ alignof(Ts)... });
+  };
+
+  using Storage = StorageTraits<concrete_types>;
+
+public:
+  using pointer = T *;
+  using element_type = T;
+
+private:
+  alignas(Storage::Alignment) std::byte Buffer[Storage::Size];
+  uint8_t Index = Null;
+
+public:
+  UpcastablePointer() noexcept {}
+  UpcastablePointer(std::nullptr_t) noexcept {}
+
+  /// Take ownership of a heap-allocated object
+  ///
+  /// The pointee is moved in the inline storage and \p P is deleted. Prefer
+  /// `make` or `emplace`, which do not allocate at all.
+  explicit UpcastablePointer(pointer P) { reset(P); }
+
+  ~UpcastablePointer() { destroy(); }
+
+public:
+  /// Create an UpcastablePointer holding a C constructed from \p Args
+  template<typename C, typename... ArgsT>
+  static UpcastablePointer make(ArgsT &&... Args) {
+    UpcastablePointer Result;
+    Result.template emplace<C>(std::forward<ArgsT>(Args)...);
+    return Result;
+  }
+
+  /// Destroy the current pointee, if any, and construct a C in-place
+  template<typename C, typename... ArgsT>
+  C &emplace(ArgsT &&... Args) {
+    destroy();
+    C *Result = new (Buffer) C(std::forward<ArgsT>(Args)...);
+    Index = indexOf<C>();
+    return *Result;
   }
 
 public:
   template<typename L>
   void upcast(const L &Callable) {
-    ::upcast(Pointer, Callable);
+    dispatch<void>(*this, Callable);
   }
 
   template<typename L>
   void upcast(const L &Callable) const {
-    ::upcast(Pointer, Callable);
+    dispatch<void>(*this, Callable);
   }
 
-private:
-  using concrete_types = concrete_types_traits_t<T>;
-  static constexpr void (*deleter)(T *) = &destroy<T>;
-  using inner_pointer = std::unique_ptr<T, decltype(deleter)>;
-
-public:
-  using pointer = typename inner_pointer::pointer;
-  using element_type = typename inner_pointer::element_type;
-
-public:
-  constexpr UpcastablePointer() noexcept : Pointer(nullptr, deleter) {}
-  constexpr UpcastablePointer(std::nullptr_t P) noexcept :
-    Pointer(P, deleter) {}
-  explicit UpcastablePointer(pointer P) noexcept : Pointer(P, deleter) {}
-
 public:
   UpcastablePointer &operator=(const UpcastablePointer &Other) {
     if (&Other != this) {
-      Pointer.reset(clone(Other.Pointer.get()));
-      revng_assert(Pointer.get_deleter() == deleter);
+      destroy();
+      Other.upcast([this](const auto &Upcasted) {
+        using type = std::remove_cvref_t<decltype(Upcasted)>;
+        this->template emplace<type>(Upcasted);
+      });
     }
     return *this;
   }
 
-  UpcastablePointer(const UpcastablePointer &Other) :
-    UpcastablePointer(nullptr) {
-    *this = Other;
-  }
+  UpcastablePointer(const UpcastablePointer &Other) { *this = Other; }
 
   UpcastablePointer &operator=(UpcastablePointer &&Other) {
     if (&Other != this) {
-      Pointer.reset(Other.Pointer.release());
-      revng_assert(Pointer.get_deleter() == deleter);
+      destroy();
+      Other.upcast([this](auto &Upcasted) {
+        using type = std::remove_cvref_t<decltype(Upcasted)>;
+        this->template emplace<type>(std::move(Upcasted));
+      });
+      Other.destroy();
     }
     return *this;
   }
 
-  UpcastablePointer(UpcastablePointer &&Other) noexcept :
-    UpcastablePointer(nullptr) {
+  UpcastablePointer(UpcastablePointer &&Other) noexcept {
     *this = std::move(Other);
   }
 
@@ -168,17 +225,65 @@ public:
     return Result;
   }
 
-  auto get() const noexcept { return Pointer.get(); }
-  auto &operator*() const { return *Pointer; }
-  auto *operator->() const noexcept { return Pointer.operator->(); }
+  pointer get() const noexcept {
+    auto ToBase = [](auto &Upcasted) -> pointer { return &Upcasted; };
+    auto *This = const_cast<UpcastablePointer *>(this);
+    return dispatch<pointer>(*This, ToBase);
+  }
+
+  T &operator*() const { return *get(); }
+  pointer operator->() const noexcept { return get(); }
 
-  void reset(pointer Other = pointer()) noexcept {
-    Pointer.reset(Other);
-    revng_assert(Pointer.get_deleter() == deleter);
+  void reset(pointer Other = pointer()) {
+    destroy();
+
+    if (Other == nullptr)
+      return;
+
+    // Move the object in the inline storage and release the original one.
+    // T might lack a virtual destructor, delete it through its concrete type.
+    ::upcast(Other, [this](auto &Upcasted) {
+      using type = std::remove_cvref_t<decltype(Upcasted)>;
+      this->template emplace<type>(std::move(Upcasted));
+      delete &Upcasted;
+    });
   }
 
 private:
-  inner_pointer Pointer;
+  void destroy() noexcept {
+    upcast([](auto &Upcasted) {
+      using type = std::remove_cvref_t<decltype(Upcasted)>;
+      Upcasted.~type();
+    });
+    Index = Null;
+  }
+
+  /// Invoke \p Callable on the pointee cast to its concrete type, dispatching
+  /// on the discriminant rather than going through LLVM RTTI
+  ///
+  /// \return the result of \p Callable, or a value-initialized ReturnT if null
+  template<typename ReturnT, size_t I = 0, typename Self, typename L>
+  static ReturnT dispatch(Self &This, const L &Callable) {
+    if constexpr (I < TypesCount) {
+      using type = std::tuple_element_t<I, concrete_types>;
+      using qualified = std::conditional_t<std::is_const_v<Self>,
+                                           const type,
+                                           type>;
+      if (This.Index == I) {
+        auto *Upcasted = std::launder(reinterpret_cast<qualified *>(This.Buffer));
+        if constexpr (std::is_void_v<ReturnT>)
+          Callable(*Upcasted);
+        else
+          return Callable(*Upcasted);
+      } else {
+        return dispatch<ReturnT, I + 1>(This, Callable);
+      }
+    } else {
+      revng_assert(This.Index == Null);
+      if constexpr (not std::is_void_v<ReturnT>)
+        return ReturnT{};
+    }
+  }
 };
 
 template<typename T>
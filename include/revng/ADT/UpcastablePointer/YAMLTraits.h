@@ -15,7 +15,10 @@ void initializeOwningPointer(llvm::yaml::IO &io, O &Obj) {
   if constexpr (I < std::tuple_size_v<concrete_types>) {
     using type = typename std::tuple_element_t<I, concrete_types>;
     if (io.mapTag(type::Tag)) {
-      Obj.reset(new type);
+      if constexpr (IsUpcastablePointer<O>)
+        Obj.template emplace<type>();
+      else
+        Obj.reset(new type);
     } else {
       initializeOwningPointer<O, I + 1>(io, Obj);
     }
@@ -4,8 +4,11 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <list>
+#include <map>
 #include <set>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/LazyValueInfo.h"
 #include "llvm/Analysis/ScalarEvolution.h"
@@ -145,46 +148,146 @@ struct Edge {
 /// \brief Monotone framework to collect ConstantRangeSets from LazyValueInfo
 namespace DisjointRanges {
 
+/// \brief Map from target instructions to their ConstantRangeSet
+///
+/// Target instructions are identified by their index in the list of target
+/// instructions of the Analysis. Entries are kept sorted by index in a flat
+/// vector, so that copying, combining and comparing elements boil down to
+/// linear scans without allocating tree nodes.
+///
+/// Target instructions without an entry have an empty range, or the full range
+/// if the element is top.
 class Element {
 private:
-  using Container = std::map<llvm::Instruction *, ConstantRangeSet>;
+  using Entry = std::pair<unsigned, ConstantRangeSet>;
+  using Container = llvm::SmallVector<Entry, 2>;
   Container Ranges;
+  bool Top = false;
 
 public:
   Element() {}
 
   static Element bottom() { return Element(); }
+  static Element top() {
+    Element Result;
+    Result.Top = true;
+    return Result;
+  }
   Element copy() const { return *this; }
 
 public:
-  void combine(const Element &Other) {
+  bool isTop() const { return Top; }
 
-    // We can't use zipmap_ranges since Other is const
-    for (auto &P : Other.Ranges) {
-      auto It = Ranges.find(P.first);
-      if (It == Ranges.end())
-        Ranges[P.first] = P.second;
-      else
-        It->second = It->second.unionWith(P.second);
+  void combine(const Element &Other) {
+    if (Other.Ranges.empty() and not Other.Top)
+      return;
+
+    // Merge the two sorted containers. Entries missing on a top side have the
+    // full range, therefore they're dropped.
+    Container Result;
+    Result.reserve(Ranges.size() + Other.Ranges.size());
+    auto It = Ranges.begin();
+    auto OtherIt = Other.Ranges.begin();
+    while (It != Ranges.end() or OtherIt != Other.Ranges.end()) {
+      if (OtherIt == Other.Ranges.end()
+          or (It != Ranges.end() and It->first < OtherIt->first)) {
+        if (not Other.Top)
+          Result.push_back(std::move(*It));
+        ++It;
+      } else if (It == Ranges.end() or OtherIt->first < It->first) {
+        if (not Top)
+          Result.push_back(*OtherIt);
+        ++OtherIt;
+      } else {
+        Result.emplace_back(It->first, It->second.unionWith(OtherIt->second));
+        ++It;
+        ++OtherIt;
+      }
     }
+
+    Ranges = std::move(Result);
+    Top = Top or Other.Top;
   }
 
   bool lowerThanOrEqual(const Element &Other) const {
-    for (auto &P : Ranges) {
-      auto It = Other.Ranges.find(P.first);
-      if (It == Other.Ranges.end() or not It->second.contains(P.second))
+    // Entries missing in a top element have the full range: they must be
+    // missing or full in Other too
+    if (Top) {
+      if (not Other.Top)
+        return false;
+
+      auto It = Ranges.begin();
+      for (const Entry &E : Other.Ranges) {
+        while (It != Ranges.end() and It->first < E.first)
+          ++It;
+
+        bool Missing = It == Ranges.end() or It->first != E.first;
+        if (Missing and not E.second.isFullSet())
+          return false;
+      }
+    }
+
+    auto OtherIt = Other.Ranges.begin();
+    auto OtherEnd = Other.Ranges.end();
+    for (const Entry &E : Ranges) {
+      while (OtherIt != OtherEnd and OtherIt->first < E.first)
+        ++OtherIt;
+
+      if (OtherIt == OtherEnd or OtherIt->first != E.first) {
+        if (not Other.Top)
+          return false;
+      } else if (not OtherIt->second.contains(E.second)) {
         return false;
+      }
     }
 
     return true;
   }
 
-  ConstantRangeSet &operator[](llvm::Instruction *I) { return Ranges[I]; }
-  const ConstantRangeSet &operator[](llvm::Instruction *I) const {
-    return Ranges.at(I);
+  Container::iterator begin() { return Ranges.begin(); }
+  Container::iterator end() { return Ranges.end(); }
+
+  ConstantRangeSet &operator[](unsigned Index) {
+    auto It = lowerBound(Index);
+    if (It == Ranges.end() or It->first != Index)
+      It = Ranges.insert(It, { Index, ConstantRangeSet() });
+    return It->second;
+  }
+
+  const ConstantRangeSet &operator[](unsigned Index) const {
+    auto It = lowerBound(Index);
+    revng_assert(It != Ranges.end() and It->first == Index);
+    return It->second;
+  }
+
+  bool hasKey(unsigned Index) const {
+    auto It = lowerBound(Index);
+    return It != Ranges.end() and It->first == Index;
   }
 
-  bool hasKey(llvm::Instruction *I) const { return Ranges.count(I) != 0; }
+private:
+  Container::iterator lowerBound(unsigned Index) {
+    auto Compare = [](const Entry &E, unsigned Index) {
+      return E.first < Index;
+    };
+    return std::lower_bound(Ranges.begin(), Ranges.end(), Index, Compare);
+  }
+
+  Container::const_iterator lowerBound(unsigned Index) const {
+    return const_cast<Element *>(this)->lowerBound(Index);
+  }
+};
+
+/// \brief Knobs speeding up the convergence of Analysis at the expense of
+///        precision, all disabled by default
+struct ConvergenceOptions {
+  /// Visits of a label after which the ranges that keep growing are widened
+  /// to the full range, 0 means never
+  uint64_t WideningThreshold = 0;
+
+  /// Average number of visits per label after which the analysis gives up and
+  /// converges to top, 0 means no limit
+  uint64_t VisitsPerLabelBudget = 0;
 };
 
 class Analysis
@@ -204,7 +307,11 @@ private:
   llvm::BasicBlock *Entry;
   llvm::LazyValueInfo &LVI;
   const llvm::DominatorTree &DT;
-  std::map<llvm::Instruction *, ConstantRangeSet> InstructionRanges;
+  /// Target instructions and their ConstantRangeSet, Element refers to them
+  /// by their index in this vector
+  std::vector<std::pair<llvm::Instruction *, ConstantRangeSet>>
+    InstructionRanges;
+  llvm::DenseMap<llvm::Instruction *, unsigned> InstructionIndex;
   std::set<Edge> TargetEdges;
   std::set<llvm::BasicBlock *> WhiteList;
 
@@ -213,16 +320,24 @@ public:
            llvm::LazyValueInfo &LVI,
            const llvm::DominatorTree &DT,
            const std::vector<llvm::Instruction *> &TargetInstructions,
-           const std::vector<Edge> &TargetEdges) :
+           const std::vector<Edge> &TargetEdges,
+           const ConvergenceOptions &Options = {}) :
     Base(RPOT), Entry(RPOT[0]), LVI(LVI), DT(DT) {
     using namespace llvm;
 
     registerExtremal(Entry);
+    setWideningThreshold(Options.WideningThreshold);
+    setIterationsBudget(Options.VisitsPerLabelBudget * RPOT.size());
 
     for (Instruction *I : TargetInstructions) {
       if (auto *Ty = dyn_cast<IntegerType>(I->getType())) {
-        InstructionRanges[I] = { ConstantRange(Ty->getIntegerBitWidth(),
-                                               true) };
+        ConstantRange Full(Ty->getIntegerBitWidth(), true);
+        auto [It, New] = InstructionIndex.try_emplace(I,
+                                                      InstructionRanges.size());
+        if (New)
+          InstructionRanges.emplace_back(I, Full);
+        else
+          InstructionRanges[It->second].second = Full;
       }
     }
 
@@ -241,6 +356,17 @@ public:
     revng_assert(A.lowerThanOrEqual(B));
   }
 
+  /// \brief Widen to the full range the ranges that have grown
+  void widen(llvm::BasicBlock *, const Element &Previous, Element &Current) {
+    for (auto &[Index, RangeSet] : Current) {
+      if (Previous.hasKey(Index) and Previous[Index].contains(RangeSet))
+        continue;
+
+      llvm::Type *Ty = InstructionRanges[Index].first->getType();
+      RangeSet = llvm::ConstantRange::getFull(Ty->getIntegerBitWidth());
+    }
+  }
+
   DefaultInterrupt<Element> transfer(llvm::BasicBlock *BB) {
     if (TargetEdges.count({ BB, nullptr }) != 0) {
       Element Result = *compute(State[BB], BB, nullptr, true);
@@ -273,7 +399,9 @@ public:
   }
 
   const ConstantRangeSet &get(llvm::Instruction *I) const {
-    return InstructionRanges.at(I);
+    auto It = InstructionIndex.find(I);
+    revng_assert(It != InstructionIndex.end());
+    return InstructionRanges[It->second].second;
   }
 
   void dump() const debug_function { dump(dbg); }
@@ -295,9 +423,9 @@ private:
                                   llvm::BasicBlock *Destination,
                                   bool IsTargetEdge) {
     Element Result = Original;
-    for (auto &P : InstructionRanges) {
-      llvm::Instruction *I = P.first;
-      ConstantRangeSet &InstructionRangeSet = P.second;
+    for (unsigned Index = 0; Index < InstructionRanges.size(); ++Index) {
+      llvm::Instruction *I = InstructionRanges[Index].first;
+      ConstantRangeSet &InstructionRangeSet = InstructionRanges[Index].second;
 
       if (not DT.dominates(I->getParent(), Source))
         continue;
@@ -311,8 +439,8 @@ private:
       else
         NewRange = LVI.getConstantRangeOnEdge(I, Source, Destination);
 
-      bool IsNew = not Result.hasKey(I);
-      ConstantRangeSet &RangeSet = Result[I];
+      bool IsNew = not Result.hasKey(Index);
+      ConstantRangeSet &RangeSet = Result[Index];
       if (IsNew) {
         RangeSet = NewRange;
       } else {
@@ -471,11 +599,15 @@ public:
   ///    according to LVI.
   /// 3. Iterate over the chain looking for the instruction associated with the
   ///    smallest range.
-  llvm::Instruction *buildExpression(llvm::LazyValueInfo &LVI,
-                                     const llvm::DominatorTree &DT,
-                                     PhiEdges &Edges,
-                                     llvm::Value *V,
-                                     llvm::BasicBlock *StopAt) {
+  ///
+  /// \p Options are forwarded to the DisjointRanges analysis.
+  llvm::Instruction *
+  buildExpression(llvm::LazyValueInfo &LVI,
+                  const llvm::DominatorTree &DT,
+                  PhiEdges &Edges,
+                  llvm::Value *V,
+                  llvm::BasicBlock *StopAt,
+                  const DisjointRanges::ConvergenceOptions &Options = {}) {
     using namespace llvm;
 
     revng_log(AVILogger, "Building expression for " << V);
@@ -601,7 +733,12 @@ public:
       for (BasicBlock *BB : Reachable)
         ReachableVector.push_back(BB);
 
-      DisjointRanges::Analysis DR(ReachableVector, LVI, DT, Targets, Edges);
+      DisjointRanges::Analysis DR(ReachableVector,
+                                  LVI,
+                                  DT,
+                                  Targets,
+                                  Edges,
+                                  Options);
       DR.initialize();
       DR.run();
 
@@ -843,6 +980,121 @@ public:
   }
 };
 
+/// \brief Size-bounded LRU memo table for the values materialized by
+///        AdvancedValueInfo
+///
+/// Two kind of entries are recorded:
+///
+/// * the result of a whole query, i.e., the values of a tracked value in a
+///   given basic block;
+/// * the values of a phi node reached through a certain sequence of edges,
+///   which determines the constraints LVI provides on its incoming values.
+///
+/// The cache holds pointers to instructions and basic blocks, therefore it's
+/// valid only as long as the function on which it has been populated is not
+/// changed. It's meant to be shared by all the queries on a function.
+class MaterializedValuesCache {
+public:
+  /// Default capacity, in number of cached MaterializedValue
+  static constexpr size_t DefaultCapacity = 4 * MaxMaterializedValues;
+
+  struct Key {
+    llvm::Value *V;
+
+    /// The basic block in which V has been queried, for query results
+    llvm::BasicBlock *Context;
+
+    /// The edges through which the phi V has been reached, for phi results
+    std::vector<Edge> Edges;
+
+    bool operator<(const Key &Other) const {
+      auto This = std::tie(V, Context, Edges);
+      auto That = std::tie(Other.V, Other.Context, Other.Edges);
+      return This < That;
+    }
+  };
+
+  struct Entry {
+    MaterializedValues Values;
+
+    /// The upper bound on the number of values in use while computing Values.
+    /// A lower bound could have led to giving up.
+    range_size_t UpperBound;
+
+    /// The phis that have been visited while computing Values
+    std::vector<llvm::Instruction *> VisitedPhis;
+
+    size_t cost() const { return 1 + Values.size() + VisitedPhis.size(); }
+  };
+
+private:
+  using EntriesList = std::list<std::pair<Key, Entry>>;
+
+private:
+  size_t Capacity;
+  size_t Size = 0;
+  /// Most recently used first
+  EntriesList Entries;
+  std::map<Key, EntriesList::iterator> Index;
+  uint64_t Hits = 0;
+  uint64_t Misses = 0;
+
+public:
+  MaterializedValuesCache(size_t Capacity = DefaultCapacity) :
+    Capacity(Capacity) {}
+
+public:
+  /// \return the entry associated to \p K, if present and if \p IsUsable
+  ///         accepts it, nullptr otherwise.
+  template<typename F>
+  const Entry *find(const Key &K, F &&IsUsable) {
+    auto It = Index.find(K);
+    if (It == Index.end() or not IsUsable(It->second->second)) {
+      ++Misses;
+      return nullptr;
+    }
+
+    ++Hits;
+    Entries.splice(Entries.begin(), Entries, It->second);
+    return &It->second->second;
+  }
+
+  void insert(Key K, Entry E) {
+    auto It = Index.find(K);
+    if (It != Index.end()) {
+      Size -= It->second->second.cost();
+      Entries.erase(It->second);
+      Index.erase(It);
+    }
+
+    // Entries larger than the whole cache are not worth evicting everything
+    if (E.cost() > Capacity)
+      return;
+
+    Size += E.cost();
+    Entries.emplace_front(K, std::move(E));
+    Index[std::move(K)] = Entries.begin();
+
+    // Evict the least recently used entries
+    while (Size > Capacity) {
+      auto &[LastKey, LastEntry] = Entries.back();
+      Size -= LastEntry.cost();
+      Index.erase(LastKey);
+      Entries.pop_back();
+    }
+  }
+
+  void clear() {
+    Entries.clear();
+    Index.clear();
+    Size = 0;
+  }
+
+  size_t size() const { return Index.size(); }
+  uint64_t hits() const { return Hits; }
+  uint64_t misses() const { return Misses; }
+};
+
 /// \brief Context for processing a phi node
 class PhiProcess {
 public:
@@ -867,6 +1119,18 @@ public:
   /// Did we exceed MaxMaterializedValues?
   bool TooLarge;
 
+  /// Did we avoid entering a phi in order not to enter in a loop?
+  ///
+  /// If this happened, Values depends on the phis visited before this one, and
+  /// it cannot be cached.
+  bool Cut;
+
+  /// The edges through which Phi has been reached (only if caching)
+  Expression::PhiEdges ReachingEdges;
+
+  /// The phis visited while processing Phi (only if caching)
+  std::vector<llvm::Instruction *> VisitedPhis;
+
 public:
   PhiProcess(const llvm::DataLayout &DL,
              llvm::ScalarEvolution &SE,
@@ -877,7 +1141,8 @@ public:
     Expr(DL, SE),
     Unfinished(false),
     UpperBound(UpperBound),
-    TooLarge(false) {
+    TooLarge(false),
+    Cut(false) {
 
     revng_assert(isPhiLike(Phi));
   }
@@ -902,6 +1167,7 @@ public:
     Output << "Unfinished: " << Unfinished << "\n";
     Output << "UpperBound: " << UpperBound << "\n";
     Output << "TooLarge: " << TooLarge << "\n";
+    Output << "Cut: " << Cut << "\n";
   }
 };
 
@@ -910,6 +1176,11 @@ public:
 ///
 /// \tparam MemoryOracle the type of the class used to produce obtain the result
 ///         of memory accesses from constant addresses.
+///
+/// \note If a MaterializedValuesCache is provided, the values of the queries
+///       and of the phis met while exploring are memoized. The cache must be
+///       used only with AdvancedValueInfo instances working on the same
+///       function, with the same StopAt and the same ConvergenceOptions.
 template<typename MemoryOracle>
 class AdvancedValueInfo {
 private:
@@ -918,14 +1189,24 @@ private:
   const llvm::DominatorTree &DT;
   MemoryOracle &MO;
   llvm::BasicBlock *StopAt;
+  MaterializedValuesCache *Cache;
+  DisjointRanges::ConvergenceOptions Options;
 
 public:
   AdvancedValueInfo(llvm::LazyValueInfo &LVI,
                     llvm::ScalarEvolution &SE,
                     const llvm::DominatorTree &DT,
                     MemoryOracle &MO,
-                    llvm::BasicBlock *StopAt) :
-    LVI(LVI), SE(SE), DT(DT), MO(MO), StopAt(StopAt) {}
+                    llvm::BasicBlock *StopAt,
+                    MaterializedValuesCache *Cache = nullptr,
+                    const DisjointRanges::ConvergenceOptions &Options = {}) :
+    LVI(LVI),
+    SE(SE),
+    DT(DT),
+    MO(MO),
+    StopAt(StopAt),
+    Cache(Cache),
+    Options(Options) {}
 
   MaterializedValues explore(llvm::BasicBlock *BB, llvm::Value *V);
 };
@@ -938,6 +1219,16 @@ AdvancedValueInfo<MemoryOracle>::explore(llvm::BasicBlock *BB, llvm::Value *V) {
 
   revng_log(AVILogger, "Exploring " << V << " in " << BB);
 
+  using CacheKey = MaterializedValuesCache::Key;
+  using CacheEntry = MaterializedValuesCache::Entry;
+  if (Cache != nullptr) {
+    auto Any = [](const CacheEntry &) { return true; };
+    if (const CacheEntry *Cached = Cache->find({ V, BB, {} }, Any)) {
+      revng_log(AVILogger, "Cache hit");
+      return Cached->Values;
+    }
+  }
+
   // Create a fake Phi for the initial entry
   PHINode *FakePhi = PHINode::Create(V->getType(), 1);
   FakePhi->addIncoming(V, BB);
@@ -988,13 +1279,50 @@ AdvancedValueInfo<MemoryOracle>::explore(llvm::BasicBlock *BB, llvm::Value *V) {
 
       Edges.push_back(NewEdge);
 
-      NextPhi = Current.Expr.buildExpression(LVI, DT, Edges, NextValue, StopAt);
+      NextPhi = Current.Expr.buildExpression(LVI,
+                                             DT,
+                                             Edges,
+                                             NextValue,
+                                             StopAt,
+                                             Options);
       Current.NextIncomingIndex++;
     }
 
     // Don't enter in loops
-    if (VisitedPhis.count(NextPhi) != 0)
+    if (VisitedPhis.count(NextPhi) != 0) {
+      Current.Cut = true;
       NextPhi = nullptr;
+    }
+
+    if (NextPhi != nullptr and Cache != nullptr) {
+      // Have we already explored NextPhi through the same edges? The cached
+      // result is usable only if we would have visited the same phis
+      range_size_t UpperBound = Current.Expr.smallestRangeSize();
+      auto IsUsable = [&VisitedPhis, UpperBound](const CacheEntry &Entry) {
+        if (Entry.UpperBound > UpperBound)
+          return false;
+        for (Instruction *Phi : Entry.VisitedPhis)
+          if (VisitedPhis.count(Phi) != 0)
+            return false;
+        return true;
+      };
+
+      if (const CacheEntry *Cached = Cache->find({ NextPhi, nullptr, Edges },
+                                                 IsUsable)) {
+        revng_log(AVILogger, "Cache hit for " << NextPhi);
+        VisitedPhis.insert(NextPhi);
+        VisitedPhis.insert(Cached->VisitedPhis.begin(),
+                           Cached->VisitedPhis.end());
+        Current.VisitedPhis.push_back(NextPhi);
+        llvm::copy(Cached->VisitedPhis,
+                   std::back_inserter(Current.VisitedPhis));
+
+        // Proceed as if we just popped NextPhi
+        Current.Unfinished = true;
+        Current.Expr.setPhiValues(Cached->Values);
+        continue;
+      }
+    }
 
     if (NextPhi != nullptr) {
       VisitedPhis.insert(NextPhi);
@@ -1007,6 +1335,8 @@ AdvancedValueInfo<MemoryOracle>::explore(llvm::BasicBlock *BB, llvm::Value *V) {
                                SE,
                                NextPhi,
                                Current.Expr.smallestRangeSize());
+      if (Cache != nullptr)
+        PendingPhis.back().ReachingEdges = Edges;
     } else {
       // The last node is not a phi, we're done on this incoming value of
       // the phi
@@ -1018,6 +1348,7 @@ AdvancedValueInfo<MemoryOracle>::explore(llvm::BasicBlock *BB, llvm::Value *V) {
       size_t UpperBound = Current.Expr.smallestRangeSize();
       bool IsSmallerThanUpperBound = UpperBound < Current.UpperBound;
       bool PhiDone = not IsSmallerThanUpperBound;
+      bool PhiCompleted = false;
       if (IsSmallerThanUpperBound) {
         // Materialize the current expression
         Result = std::move(Current.Expr.materialize<MemoryOracle>(MO));
@@ -1049,6 +1380,7 @@ AdvancedValueInfo<MemoryOracle>::explore(llvm::BasicBlock *BB, llvm::Value *V) {
         if (Current.NextIncomingIndex == IncomingCount) {
           // We're done with this phi
           PhiDone = true;
+          PhiCompleted = true;
 
           // Save and deduplicate the result
           Result = std::move(Current.Values);
@@ -1061,8 +1393,26 @@ AdvancedValueInfo<MemoryOracle>::explore(llvm::BasicBlock *BB, llvm::Value *V) {
       }
 
       if (PhiDone) {
-        if (PendingPhis.size() == 1)
+        if (PendingPhis.size() == 1) {
+          if (Cache != nullptr)
+            Cache->insert({ V, BB, {} }, { Result, MaxMaterializedValues, {} });
           return Result;
+        }
+
+        if (Cache != nullptr) {
+          // Record the values of the phi, unless they're incomplete or they
+          // depend on the phis visited before it
+          if (PhiCompleted and IsSmallerThanUpperBound and not Current.Cut) {
+            Cache->insert({ Current.Phi, nullptr, Current.ReachingEdges },
+                          { Result, Current.UpperBound, Current.VisitedPhis });
+          }
+
+          PhiProcess &Parent = PendingPhis[PendingPhis.size() - 2];
+          Parent.Cut = Parent.Cut or Current.Cut;
+          Parent.VisitedPhis.push_back(Current.Phi);
+          llvm::copy(Current.VisitedPhis,
+                     std::back_inserter(Parent.VisitedPhis));
+        }
 
         // Pop
         PendingPhis.pop_back();
@@ -813,9 +813,9 @@ struct KeyedObjectTraits<UpcastablePointer<model::FunctionEdge>> {
   static UpcastablePointer<model::FunctionEdge> fromKey(const Key &Obj) {
     using ResultType = UpcastablePointer<model::FunctionEdge>;
     if (model::FunctionEdgeType::isCall(Obj.second)) {
-      return ResultType(new model::CallEdge(Obj.first, Obj.second));
+      return ResultType::make<model::CallEdge>(Obj.first, Obj.second);
     } else {
-      return ResultType(new model::FunctionEdge(Obj.first, Obj.second));
+      return ResultType::make<model::FunctionEdge>(Obj.first, Obj.second);
     }
   }
 };
@@ -914,7 +914,31 @@ public:
   MutableSet<model::Function> Functions;
 
 public:
+  /// A function that failed verification and the shard that verified it
+  struct VerificationFailure {
+    size_t Shard;
+    MetaAddress Entry;
+
+    bool operator==(const VerificationFailure &Other) const = default;
+  };
+
+public:
+  /// Verify all the functions, in parallel shards
   bool verify() const debug_function;
+
+  /// Verify all the functions, in parallel shards
+  ///
+  /// \return the functions that failed verification, in order.
+  std::vector<VerificationFailure> verificationFailures() const;
+
+  /// Serialize to YAML, serializing functions in parallel shards
+  ///
+  /// \note The output is identical to the one of the regular YAML serializer.
+  ///       Deserialization, on the other hand, is not sharded:
+  ///       llvm::yaml::Input parses the whole document in a single pass
+  ///       before mapping it, and splitting the document beforehand would
+  ///       mean parsing it by hand.
+  void serialize(llvm::raw_ostream &Stream) const;
 };
 INTROSPECTION_NS(model, Binary, Functions)
 
@@ -0,0 +1,99 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "boost/icl/interval_map.hpp"
+
+#include "revng/Model/Binary.h"
+#include "revng/Model/TupleTreeDiff.h"
+
+namespace model {
+
+/// \brief Reverse indexes over a TupleTree<model::Binary>
+///
+/// The following queries are provided:
+///
+/// * the call sites of a function (i.e., all the `CallEdge`s targeting it);
+/// * the functions owning a certain address (i.e., the functions having a
+///   basic block whose [Start, End) range contains it).
+///
+/// The indexes are built on the first query. After that, they can be kept up
+/// to date incrementally by calling update() with each TupleTreeDiff applied
+/// to the model: only the functions touched by the diff are re-indexed. If
+/// the model has been mutated in any other way (i.e., accessed through a
+/// non-const TupleTree, see TupleTree::markMutated), the indexes are rebuilt
+/// from scratch on the next query.
+class BinaryIndexes {
+public:
+  struct CallSite {
+    /// Entry point of the calling function
+    MetaAddress Caller;
+    /// Start address of the basic block performing the call
+    MetaAddress Block;
+
+    bool operator<(const CallSite &Other) const {
+      return std::tie(Caller, Block) < std::tie(Other.Caller, Other.Block);
+    }
+
+    bool operator==(const CallSite &Other) const = default;
+  };
+
+  using CallSitesSet = std::set<CallSite>;
+  using FunctionsSet = std::set<MetaAddress>;
+
+private:
+  using interval = boost::icl::interval<MetaAddress, compareAddress>;
+  using interval_type = interval::type;
+  using RangesMap = boost::icl::interval_map<MetaAddress,
+                                             FunctionsSet,
+                                             boost::icl::partial_absorber,
+                                             compareAddress>;
+
+  /// What a function contributed to the indexes, so that it can be removed
+  struct Contribution {
+    std::vector<std::pair<MetaAddress, CallSite>> CallSites;
+    std::vector<interval_type> Ranges;
+  };
+
+private:
+  const TupleTree<Binary> &Model;
+  uint64_t Generation = 0;
+
+  std::map<MetaAddress, CallSitesSet> CallSites;
+  RangesMap Ranges;
+  std::map<MetaAddress, Contribution> Contributions;
+
+public:
+  BinaryIndexes(const TupleTree<Binary> &Model) : Model(Model) {}
+
+public:
+  /// \return the set of call sites targeting \p Callee
+  const CallSitesSet &callSites(const MetaAddress &Callee);
+
+  /// \return the entry points of the functions containing \p Address
+  const FunctionsSet &functionsAt(const MetaAddress &Address);
+
+public:
+  /// Update the indexes after \p Diff has been applied to the model
+  ///
+  /// If the model has been mutated in other ways too since the indexes have
+  /// been last used, they are rebuilt on the next query.
+  void update(const TupleTreeDiff<Binary> &Diff);
+
+  /// Drop all the indexes, they will be rebuilt on the next query
+  void invalidate() { Generation = 0; }
+
+private:
+  void ensureUpToDate();
+  void rebuild();
+  void indexFunction(const Function &F);
+  void unindexFunction(const MetaAddress &Entry);
+};
+
+} // namespace model
@@ -5,6 +5,7 @@
 //
 
 #include <array>
+#include <atomic>
 #include <set>
 #include <type_traits>
 #include <vector>
@@ -244,12 +245,10 @@ ResultT getByKey(RootT &M, KeyT Key) {
 
 template<typename ResultT, IsKeyedObjectContainer RootT, typename KeyT>
 ResultT *getByKey(RootT &M, KeyT Key) {
-  for (auto &Element : M) {
-    using KOT = KeyedObjectTraits<std::remove_reference_t<decltype(Element)>>;
-    if (KOT::key(Element) == Key)
-      return &Element;
-  }
-  return nullptr;
+  auto It = M.find(Key);
+  if (It == M.end())
+    return nullptr;
+  return &*It;
 }
 
 //
@@ -384,21 +383,15 @@ bool callOnPathSteps(Visitor &V,
   using key_type = decltype(KOT::key(std::declval<value_type>()));
   auto TargetKey = Path[0].get<key_type>();
 
-  value_type *Matching = nullptr;
-  for (value_type &Element : M) {
-    using KOT = KeyedObjectTraits<value_type>;
-    if (KOT::key(Element) == TargetKey) {
-      Matching = &Element;
-      break;
-    }
-  }
-
-  if (Matching == nullptr)
+  // Go through the index of the container
+  auto It = M.find(TargetKey);
+  if (It == M.end())
     return false;
 
-  V.template visitContainerElement<RootT>(TargetKey, *Matching);
+  auto &Matching = *It;
+  V.template visitContainerElement<RootT>(TargetKey, Matching);
   if (Path.size() > 1) {
-    return callOnPathSteps(V, Path.slice(1), *Matching);
+    return callOnPathSteps(V, Path.slice(1), Matching);
   }
 
   return true;
@@ -1077,6 +1070,16 @@ class TupleTree {
 private:
   std::unique_ptr<T> Root;
 
+  /// Identifies the current contents of the tree, used to invalidate derived
+  /// data such as model::BinaryIndexes and TupleTreePathCache
+  ///
+  /// It changes upon each mutable access and its values are never reused, not
+  /// even by other trees.
+  uint64_t Generation = newGeneration();
+
+  /// The generation before the last mutation
+  uint64_t PreviousGeneration = 0;
+
 public:
   TupleTree() : Root(new T) {}
 
@@ -1119,7 +1122,12 @@ public:
   template<typename S>
   void serialize(S &Stream) const {
     revng_assert(Root);
-    ::serialize(Stream, *Root);
+
+    // Let the root provide its own, possibly faster, serializer
+    if constexpr (requires { Root->serialize(Stream); })
+      Root->serialize(Stream);
+    else
+      ::serialize(Stream, *Root);
   }
 
   void serialize(std::string &Buffer) const {
@@ -1128,9 +1136,50 @@ public:
   }
 
 public:
-  auto get() const noexcept { return Root.get(); }
-  auto &operator*() const { return *Root; }
-  auto *operator->() const noexcept { return Root.operator->(); }
+  /// \name Accessors
+  ///
+  /// The non-const accessors consider the tree as mutated (see markMutated).
+  /// Use a const TupleTree to only read it.
+  ///
+  /// @{
+  T *get() noexcept {
+    markMutated();
+    return Root.get();
+  }
+  const T *get() const noexcept { return Root.get(); }
+
+  T &operator*() {
+    markMutated();
+    return *Root;
+  }
+  const T &operator*() const { return *Root; }
+
+  T *operator->() noexcept {
+    markMutated();
+    return Root.get();
+  }
+  const T *operator->() const noexcept { return Root.get(); }
+  /// @}
+
+public:
+  uint64_t generation() const { return Generation; }
+  uint64_t previousGeneration() const { return PreviousGeneration; }
+
+  /// Notify that the tree has been (or is about to be) mutated
+  ///
+  /// This happens automatically upon each mutable access, call it explicitly
+  /// only when writing through references obtained before the last time the
+  /// derived data has been used.
+  void markMutated() {
+    PreviousGeneration = Generation;
+    Generation = newGeneration();
+  }
+
+private:
+  static uint64_t newGeneration() {
+    static std::atomic<uint64_t> Next = 1;
+    return Next.fetch_add(1, std::memory_order_relaxed);
+  }
 
 public:
   bool verify() const debug_function { return verifyReferences(); }
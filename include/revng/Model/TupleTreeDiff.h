@@ -66,6 +66,9 @@ struct TupleTreeDiff {
 
   void dump() const;
   void apply(T &M) const;
+
+  /// \note This is a single mutation of \p M (see TupleTree::markMutated)
+  void apply(TupleTree<T> &M) const { apply(*M); }
 };
 
 //
@@ -0,0 +1,257 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <map>
+#include <optional>
+#include <tuple>
+
+#include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/ADT/TupleTreePath.h"
+#include "revng/ADT/UpcastablePointer.h"
+#include "revng/Model/TupleTree.h"
+
+/// Path step selecting the I-th field of a tuple-like object
+template<size_t I>
+struct TupleFieldStep {
+  static constexpr size_t Index = I;
+};
+
+/// Path step selecting an element of a KeyedObjectContainer given its key
+struct ContainerKeyStep {};
+
+namespace tupletree::detail {
+
+template<typename T>
+struct TupleOf {
+  using type = T;
+};
+
+template<IsUpcastablePointer T>
+struct TupleOf<T> {
+  using type = typename T::element_type;
+};
+
+/// Walk the type tree according to Steps, computing the type of the target
+/// and the tuple of the types of the keys
+template<typename T, typename... Steps>
+struct TypedPathWalk;
+
+template<typename T>
+struct TypedPathWalk<T> {
+  using type = T;
+  using keys = std::tuple<>;
+};
+
+template<typename T, size_t I, typename... Rest>
+struct TypedPathWalk<T, TupleFieldStep<I>, Rest...> {
+  using tuple_type = typename TupleOf<std::remove_cv_t<T>>::type;
+  static_assert(HasTupleSize<tuple_type>, "Field step on a non-tuple-like");
+  static_assert(I < std::tuple_size_v<tuple_type>, "Field out of range");
+
+  using next = TypedPathWalk<std::tuple_element_t<I, tuple_type>, Rest...>;
+  using type = typename next::type;
+  using keys = typename next::keys;
+};
+
+template<typename T, typename... Rest>
+struct TypedPathWalk<T, ContainerKeyStep, Rest...> {
+  static_assert(IsKeyedObjectContainer<T>, "Key step on a non-container");
+
+  using key_type = std::remove_cv_t<typename T::key_type>;
+  using next = TypedPathWalk<typename T::value_type, Rest...>;
+  using type = typename next::type;
+  using keys = decltype(std::tuple_cat(std::declval<std::tuple<key_type>>(),
+                                       std::declval<typename next::keys>()));
+};
+
+} // namespace tupletree::detail
+
+/// A TupleTreePath whose shape is known at compile time
+///
+/// Each step is either a TupleFieldStep or a ContainerKeyStep. The type of
+/// the target and the types of the keys are computed and checked at compile
+/// time, and resolution goes through `find` on each container, without any
+/// type-erased key.
+///
+/// \note Field steps on an UpcastablePointer select fields of its
+///       `element_type`, not of the concrete types.
+template<typename RootT, typename... Steps>
+class TypedTupleTreePath {
+private:
+  using Walk = tupletree::detail::TypedPathWalk<RootT, Steps...>;
+
+public:
+  using root_type = RootT;
+  using type = typename Walk::type;
+  using keys_type = typename Walk::keys;
+
+private:
+  keys_type Keys;
+
+public:
+  TypedTupleTreePath() = default;
+
+  // clang-format off
+  template<typename... KeysT>
+  requires (sizeof...(KeysT) > 0
+            and std::is_constructible_v<keys_type, KeysT &&...>)
+  explicit TypedTupleTreePath(KeysT &&... Keys) :
+    Keys(std::forward<KeysT>(Keys)...) {}
+  // clang-format on
+
+  bool operator==(const TypedTupleTreePath &) const = default;
+
+public:
+  const keys_type &keys() const { return Keys; }
+
+  /// \return the target node, or nullptr if any of the keys is missing
+  type *resolve(RootT &Root) const {
+    return resolveImpl<type *, 0, Steps...>(Root);
+  }
+
+  const type *resolve(const RootT &Root) const {
+    return resolveImpl<const type *, 0, Steps...>(Root);
+  }
+
+public:
+  /// Convert to a type-erased TupleTreePath
+  TupleTreePath toPath() const {
+    TupleTreePath Result;
+    toPathImpl<0, Steps...>(Result);
+    return Result;
+  }
+
+  /// Convert from a type-erased TupleTreePath, if it has the right shape
+  static std::optional<TypedTupleTreePath>
+  fromPath(const TupleTreePath &Path) {
+    if (Path.size() != sizeof...(Steps))
+      return {};
+
+    TypedTupleTreePath Result;
+    if (not Result.template fromPathImpl<0, 0, Steps...>(Path))
+      return {};
+
+    return Result;
+  }
+
+private:
+  template<typename ResultT, size_t K, typename T>
+  ResultT resolveImpl(T &Node) const {
+    return &Node;
+  }
+
+  template<typename ResultT, size_t K, typename Step, typename... Rest>
+  ResultT resolveImpl(auto &Node) const {
+    using NodeType = std::remove_cvref_t<decltype(Node)>;
+    if constexpr (std::is_same_v<Step, ContainerKeyStep>) {
+      auto It = Node.find(std::get<K>(Keys));
+      if (It == Node.end())
+        return nullptr;
+      return resolveImpl<ResultT, K + 1, Rest...>(*It);
+    } else if constexpr (IsUpcastablePointer<NodeType>) {
+      if (Node.get() == nullptr)
+        return nullptr;
+      return resolveImpl<ResultT, K, Step, Rest...>(*Node);
+    } else {
+      return resolveImpl<ResultT, K, Rest...>(get<Step::Index>(Node));
+    }
+  }
+
+  template<size_t K>
+  void toPathImpl(TupleTreePath &Result) const {}
+
+  template<size_t K, typename Step, typename... Rest>
+  void toPathImpl(TupleTreePath &Result) const {
+    if constexpr (std::is_same_v<Step, ContainerKeyStep>) {
+      Result.push_back(std::get<K>(Keys));
+      toPathImpl<K + 1, Rest...>(Result);
+    } else {
+      Result.push_back(size_t(Step::Index));
+      toPathImpl<K, Rest...>(Result);
+    }
+  }
+
+  template<size_t K, size_t I>
+  bool fromPathImpl(const TupleTreePath &Path) {
+    return true;
+  }
+
+  template<size_t K, size_t I, typename Step, typename... Rest>
+  bool fromPathImpl(const TupleTreePath &Path) {
+    if constexpr (std::is_same_v<Step, ContainerKeyStep>) {
+      using key_type = std::tuple_element_t<K, keys_type>;
+      auto *Key = Path[I].tryGet<key_type>();
+      if (Key == nullptr)
+        return false;
+      std::get<K>(Keys) = *Key;
+      return fromPathImpl<K + 1, I + 1, Rest...>(Path);
+    } else {
+      auto *Index = Path[I].tryGet<size_t>();
+      if (Index == nullptr or *Index != Step::Index)
+        return false;
+      return fromPathImpl<K, I + 1, Rest...>(Path);
+    }
+  }
+};
+
+/// Cache from a TypedTupleTreePath to the node it resolves to in a TupleTree
+///
+/// The cache is dropped as soon as the TupleTree it has been populated from
+/// changes generation, i.e., upon any mutable access to it (see
+/// TupleTree::markMutated). For this reason, it only hands out const nodes.
+/// Paths that do not resolve are not cached.
+///
+/// Bulk operations working on many nodes under the same subtree (e.g., a
+/// function) should cache the path of the subtree and resolve the rest of the
+/// path starting from it:
+///
+/// \code
+/// using FunctionPath = TypedTupleTreePath<model::Binary,
+///                                         TupleFieldStep<0>,
+///                                         ContainerKeyStep>;
+/// using BlockPath = TypedTupleTreePath<model::Function,
+///                                      TupleFieldStep<3>,
+///                                      ContainerKeyStep>;
+/// TupleTreePathCache<FunctionPath> Cache;
+/// const model::Function *F = Cache.get(Model, FunctionPath(Entry));
+/// const model::BasicBlock *Block = BlockPath(Start).resolve(*F);
+/// \endcode
+template<typename PathT>
+class TupleTreePathCache {
+private:
+  using root_type = typename PathT::root_type;
+  using type = typename PathT::type;
+  using keys_type = typename PathT::keys_type;
+
+private:
+  std::map<keys_type, const type *> Cache;
+  uint64_t Generation = 0;
+
+public:
+  const type *get(const TupleTree<root_type> &Tree, const PathT &Path) {
+    if (Tree.generation() != Generation) {
+      Cache.clear();
+      Generation = Tree.generation();
+    }
+
+    auto It = Cache.find(Path.keys());
+    if (It != Cache.end())
+      return It->second;
+
+    const type *Result = Path.resolve(*Tree);
+    if (Result != nullptr)
+      Cache.emplace(Path.keys(), Result);
+
+    return Result;
+  }
+
+  void clear() {
+    Cache.clear();
+    Generation = 0;
+  }
+
+  size_t size() const { return Cache.size(); }
+};
@@ -16,11 +16,43 @@
 
 #include "revng/Support/Assert.h"
 #include "revng/Support/CommandLine.h"
+#include "revng/Support/LoggersConfig.h"
 
 // TODO: use a dedicated namespace
+/// \brief Stream for debug output
+///
+/// What is written to dbg is buffered per thread and, line by line, handed
+/// over to a background thread which writes it to stderr. Use flushLogs to
+/// make sure everything has been written out.
 extern std::ostream &dbg;
 extern size_t MaxLoggerNameLength;
 
+/// \brief Synchronously write out everything written to dbg so far
+///
+/// This is done automatically upon exit and before aborting due to a failed
+/// assertion.
+void flushLogs();
+
+/// \brief Write out what has been queued so far, from a signal handler
+///
+/// Unlike flushLogs, this never blocks and doesn't allocate: if another thread
+/// is writing out the debug output, or the signal interrupted it, nothing is
+/// written. Incomplete lines of the current thread are not written either.
+void flushLogsFromSignalHandler();
+
+/// \brief Whether Logger<> is actually able to log
+///
+/// In release builds of revng (i.e., defining NDEBUG), loggers are compiled
+/// out, unless the REVNG_LOGGERS_IN_RELEASE CMake option is set.
+/// Logger<>::isEnabled is then constant false, therefore revng_log statements
+/// and code guarded by isEnabled are dropped by the compiler. Use Logger<true>
+/// for loggers that must be always available.
+///
+/// The choice is made when revng is configured and recorded in the generated
+/// LoggersConfig.h: code including this header agrees on what Logger<> is,
+/// whatever its own NDEBUG.
+inline constexpr bool LoggersCompiledIn = REVNG_LOGGERS_COMPILED_IN;
+
 #define debug_function __attribute__((used, noinline))
 
 /// \brief Stream an instance of this class to call Logger::emit()
@@ -35,7 +67,7 @@ struct LogTerminator {
 ///
 /// The typical usage of this class is to be a static global variable in a
 /// translation unit.
-template<bool StaticEnabled = true>
+template<bool StaticEnabled = LoggersCompiledIn>
 class Logger {
 private:
   static unsigned IndentLevel;
@@ -87,7 +119,7 @@ private:
 };
 
 /// \brief Indent all loggers within the scope of this object
-template<bool StaticEnabled = true>
+template<bool StaticEnabled = LoggersCompiledIn>
 class LoggerIndent {
 public:
   LoggerIndent(Logger<StaticEnabled> &L) : L(L) { L.indent(); }
@@ -102,7 +134,7 @@ private:
 /// You can create an instance of this object associated to a Logger, so that
 /// when the object goes out of scope (typically, on return), the emit method
 /// will be invoked.
-template<bool StaticEnabled = true>
+template<bool StaticEnabled = LoggersCompiledIn>
 class LogOnReturn {
 public:
   LogOnReturn(Logger<StaticEnabled> &L) : L(L) {}
@@ -129,8 +161,10 @@ private:
 /// For an example see the next specialization.
 template<bool X, typename T, typename LowPrio>
 inline void writeToLog(Logger<X> &This, const T Other, LowPrio) {
-  if (This.isEnabled())
-    This.Buffer << Other;
+  // Types with a writeToLog overload for Logger<true> only end up here too
+  if constexpr (X)
+    if (This.isEnabled())
+      This.Buffer << Other;
 }
 
 /// \brief Specialization of writeToLog to emit a message
@@ -149,14 +183,17 @@ inline void writeToLog(Logger<X> &This, const llvm::StringRef &S, int Ign) {
 ///
 /// Loggers are usually global static variables in translation units, the role
 /// of this class is collecting them.
+///
+/// The names of compiled out loggers are recorded too, so that enabling them
+/// is not an error.
 class LoggersRegistry {
 public:
   LoggersRegistry() {}
 
   void add(Logger<true> *L) { Loggers.push_back(L); }
-  void add(Logger<false> *) {}
+  void add(Logger<false> *L) { CompiledOut.push_back(L->name()); }
 
-  size_t size() const { return Loggers.size(); }
+  size_t size() const { return Loggers.size() + CompiledOut.size(); }
 
   void enable(llvm::StringRef Name) {
     for (Logger<true> *L : Loggers) {
@@ -166,6 +203,11 @@ public:
       }
     }
 
+    if (isCompiledOut(Name)) {
+      warnCompiledOut(Name);
+      return;
+    }
+
     revng_abort("Requested logger not available");
   }
 
@@ -177,13 +219,27 @@ public:
       }
     }
 
+    if (isCompiledOut(Name))
+      return;
+
     revng_abort("Requested logger not available");
   }
 
   void registerArguments() const;
 
+private:
+  bool isCompiledOut(llvm::StringRef Name) const {
+    for (llvm::StringRef CompiledOutName : CompiledOut)
+      if (CompiledOutName == Name)
+        return true;
+    return false;
+  }
+
+  void warnCompiledOut(llvm::StringRef Name) const;
+
 private:
   std::vector<Logger<true> *> Loggers;
+  std::vector<llvm::StringRef> CompiledOut;
 };
 
 extern llvm::ManagedStatic<LoggersRegistry> Loggers;
@@ -210,18 +266,14 @@ struct DebugLogOptionWrapper {
 };
 extern llvm::ManagedStatic<DebugLogOptionWrapper> DebugLogOption;
 
-template<>
-inline void Logger<true>::init() {
+template<bool StaticEnabled>
+inline void Logger<StaticEnabled>::init() {
   Loggers->add(this);
   DebugLogOption->TheOption.getParser().addLiteralOption(Name.data(),
                                                          Loggers->size(),
                                                          description().data());
 }
 
-template<>
-inline void Logger<false>::init() {
-}
-
 class StreamWrapperBase {
 public:
   virtual void flush(std::stringstream &Buffer) = 0;
@@ -280,5 +332,5 @@ private:
 
 extern Logger<> NRALog;
 extern Logger<> PassesLog;
-extern Logger<> ReleaseLog;
-extern Logger<> VerifyLog;
+extern Logger<true> ReleaseLog;
+extern Logger<true> VerifyLog;
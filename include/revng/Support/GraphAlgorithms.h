@@ -4,9 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
 #include <set>
 #include <vector>
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/STLExtras.h"
@@ -14,12 +19,69 @@
 
 #include "revng/Support/Debug.h"
 
-template<typename GT, typename NodeRef = typename GT::NodeRef>
-inline llvm::SmallPtrSet<NodeRef, 4>
-nodesBetweenImpl(NodeRef Source,
-                 NodeRef Destination,
-                 const llvm::SmallPtrSetImpl<NodeRef> *IgnoreList) {
+namespace detail {
+
+/// Nodes that know their dense index in their graph, e.g., FrozenNode
+template<typename NodeRef>
+concept DenselyIndexedNode = requires(NodeRef N) {
+  { N->index() } -> std::convertible_to<size_t>;
+  { N->getParent()->size() } -> std::convertible_to<size_t>;
+  { N->getParent()->getNodeByIndex(0) } -> std::convertible_to<NodeRef>;
+};
+
+/// \brief Run the forward (0) and the backward (1) visits of the dense
+///        nodesBetweenImpl one after the other
+///
+/// See ParallelGraphAlgorithms.h for the concurrent alternative.
+struct SerialVisits {
+  template<typename VisitT>
+  void operator()(size_t, const VisitT &Visit) const {
+    Visit(0);
+    Visit(1);
+  }
+};
 
+/// \brief Mark in \p Reached all the nodes reachable from \p Start through
+///        \p GT
+///
+/// Nodes in \p Ignore are neither marked nor expanded, with the exception of
+/// \p Start and \p NotIgnored. Nodes in \p Stop are marked but not expanded,
+/// unless they are \p Start.
+template<typename GT, typename NodeRef, typename IsIgnored, typename IsStop>
+inline void markReachable(NodeRef Start,
+                          NodeRef NotIgnored,
+                          const IsIgnored &Ignore,
+                          const IsStop &Stop,
+                          llvm::BitVector &Reached) {
+  std::vector<NodeRef> Stack = { Start };
+  Reached.set(Start->index());
+  while (not Stack.empty()) {
+    NodeRef Node = Stack.back();
+    Stack.pop_back();
+    for (NodeRef Child : llvm::make_range(GT::child_begin(Node),
+                                          GT::child_end(Node))) {
+      size_t Index = Child->index();
+      if (Reached[Index] or (Child != NotIgnored and Ignore(Child)))
+        continue;
+
+      Reached.set(Index);
+      if (not Stop(Child))
+        Stack.push_back(Child);
+    }
+  }
+}
+
+/// \brief The original depth-first visit of nodesBetweenImpl
+///
+/// Once a path reaches \p Destination, \p Source is selected and, even if it's
+/// ignored, paths reaching it later on are selected too. The result therefore
+/// depends on the visit order, which is why nodesBetweenImpl keeps this visit
+/// when \p Source is in \p IgnoreList.
+template<typename GT, typename NodeRef>
+inline llvm::SmallPtrSet<NodeRef, 4>
+nodesBetweenDFS(NodeRef Source,
+                NodeRef Destination,
+                const llvm::SmallPtrSetImpl<NodeRef> *IgnoreList) {
   using Iterator = typename GT::ChildIteratorType;
   using NodeSet = llvm::SmallPtrSet<NodeRef, 4>;
 
@@ -27,14 +89,6 @@ nodesBetweenImpl(NodeRef Source,
     return GT::child_begin(Node) != GT::child_end(Node);
   };
 
-  // Ensure Source has at least one successor
-  if (not HasSuccessors(Source)) {
-    if (Source == Destination)
-      return { Source };
-    else
-      return {};
-  }
-
   NodeSet Selected = { Destination };
   NodeSet VisitedNodes;
 
@@ -129,14 +183,163 @@ nodesBetweenImpl(NodeRef Source,
   return Selected;
 }
 
+} // namespace detail
+
+/// \brief Collect the nodes on the paths from \p Source to \p Destination
+///
+/// Paths do not go through the nodes in \p IgnoreList nor, except at their
+/// end, through \p Destination. \p Destination is always part of the result,
+/// unless \p Source has no successors.
+///
+/// The result is the intersection of the nodes reachable from \p Source
+/// through GT and of those reaching \p Destination. If \p Source is ignored,
+/// the result depends on the visit order (see detail::nodesBetweenDFS), and
+/// the depth-first visit is used instead.
+///
+/// If the nodes know their dense index (e.g., FrozenGraph), the two sets are
+/// bit vectors, filled through GT and InverseGT by \p RunVisits and
+/// intersected a word at a time. Otherwise, the nodes reachable from \p Source
+/// are numbered during the forward visit, which also records the edges, and
+/// the backward visit walks the recorded edges in reverse.
+template<typename GT,
+         typename InverseGT,
+         typename NodeRef = typename GT::NodeRef,
+         typename RunVisits = detail::SerialVisits>
+inline llvm::SmallPtrSet<NodeRef, 4>
+nodesBetweenImpl(NodeRef Source,
+                 NodeRef Destination,
+                 const llvm::SmallPtrSetImpl<NodeRef> *IgnoreList) {
+  using NodeSet = llvm::SmallPtrSet<NodeRef, 4>;
+
+  // Ensure Source has at least one successor
+  if (GT::child_begin(Source) == GT::child_end(Source)) {
+    if (Source == Destination)
+      return { Source };
+    else
+      return {};
+  }
+
+  auto IsIgnored = [IgnoreList](NodeRef Node) {
+    return IgnoreList != nullptr and IgnoreList->count(Node) != 0;
+  };
+
+  if (IsIgnored(Source))
+    return detail::nodesBetweenDFS<GT>(Source, Destination, IgnoreList);
+
+  // The forward visit does not proceed past Destination
+  auto IsDestination = [Destination](NodeRef Node) {
+    return Node == Destination;
+  };
+  auto Never = [](NodeRef) { return false; };
+
+  NodeSet Selected = { Destination };
+
+  if constexpr (detail::DenselyIndexedNode<NodeRef>) {
+    auto *Graph = Source->getParent();
+    size_t Size = Graph->size();
+    llvm::BitVector Forward(Size);
+    llvm::BitVector Backward(Size);
+
+    auto Visit = [&](size_t Direction) {
+      if (Direction == 0) {
+        detail::markReachable<GT>(Source,
+                                  Destination,
+                                  IsIgnored,
+                                  IsDestination,
+                                  Forward);
+      } else {
+        detail::markReachable<InverseGT>(Destination,
+                                         Source,
+                                         IsIgnored,
+                                         Never,
+                                         Backward);
+      }
+    };
+    RunVisits()(Size, Visit);
+
+    Forward &= Backward;
+    for (unsigned Index : Forward.set_bits())
+      Selected.insert(Graph->getNodeByIndex(Index));
+
+  } else {
+    // Visit forward, numbering nodes and recording edges
+    llvm::DenseMap<NodeRef, uint32_t> Indices;
+    std::vector<NodeRef> Nodes;
+    std::vector<std::pair<uint32_t, uint32_t>> Edges;
+
+    auto GetIndex = [&](NodeRef Node) -> std::pair<uint32_t, bool> {
+      auto [It, New] = Indices.try_emplace(Node, Nodes.size());
+      if (New)
+        Nodes.push_back(Node);
+      return { It->second, New };
+    };
+
+    std::vector<NodeRef> Stack = { Source };
+    GetIndex(Source);
+    while (not Stack.empty()) {
+      NodeRef Node = Stack.back();
+      Stack.pop_back();
+      uint32_t NodeIndex = Indices[Node];
+      for (NodeRef Child : llvm::make_range(GT::child_begin(Node),
+                                            GT::child_end(Node))) {
+        if (Child != Destination and IsIgnored(Child))
+          continue;
+
+        auto [ChildIndex, New] = GetIndex(Child);
+        Edges.emplace_back(ChildIndex, NodeIndex);
+        if (New and Child != Destination)
+          Stack.push_back(Child);
+      }
+    }
+
+    auto DestinationIt = Indices.find(Destination);
+    if (DestinationIt == Indices.end())
+      return Selected;
+
+    // Build the predecessors lists
+    std::vector<uint32_t> Offsets(Nodes.size() + 1, 0);
+    for (auto [To, From] : Edges)
+      ++Offsets[To + 1];
+    for (size_t I = 1; I < Offsets.size(); ++I)
+      Offsets[I] += Offsets[I - 1];
+    std::vector<uint32_t> Predecessors(Edges.size());
+    std::vector<uint32_t> Next(Offsets.begin(), --Offsets.end());
+    for (auto [To, From] : Edges)
+      Predecessors[Next[To]++] = From;
+
+    // Visit backward from Destination
+    llvm::BitVector Backward(Nodes.size());
+    std::vector<uint32_t> IndexStack = { DestinationIt->second };
+    Backward.set(DestinationIt->second);
+    while (not IndexStack.empty()) {
+      uint32_t Index = IndexStack.back();
+      IndexStack.pop_back();
+      for (uint32_t I = Offsets[Index]; I < Offsets[Index + 1]; ++I) {
+        uint32_t Predecessor = Predecessors[I];
+        if (Backward[Predecessor])
+          continue;
+
+        Backward.set(Predecessor);
+        IndexStack.push_back(Predecessor);
+      }
+    }
+
+    for (unsigned Index : Backward.set_bits())
+      Selected.insert(Nodes[Index]);
+  }
+
+  return Selected;
+}
+
 template<class G>
 inline llvm::SmallPtrSet<G, 4>
 nodesBetween(G Source,
              G Destination,
              const llvm::SmallPtrSetImpl<G> *IgnoreList = nullptr) {
-  return nodesBetweenImpl<llvm::GraphTraits<G>>(Source,
-                                                Destination,
-                                                IgnoreList);
+  using namespace llvm;
+  return nodesBetweenImpl<GraphTraits<G>, GraphTraits<Inverse<G>>>(Source,
+                                                                   Destination,
+                                                                   IgnoreList);
 }
 
 template<class G>
@@ -145,9 +348,9 @@ nodesBetweenReverse(G Source,
                     G Destination,
                     const llvm::SmallPtrSetImpl<G> *IgnoreList = nullptr) {
   using namespace llvm;
-  return nodesBetweenImpl<GraphTraits<Inverse<G>>>(Source,
-                                                   Destination,
-                                                   IgnoreList);
+  return nodesBetweenImpl<GraphTraits<Inverse<G>>, GraphTraits<G>>(Source,
+                                                                   Destination,
+                                                                   IgnoreList);
 }
 
 template<typename T>
@@ -160,39 +363,101 @@ struct scc_iterator_traits {
   using difference_type = size_t;
 };
 
+/// \brief Collect the SCCs reachable from \p Entry that have at least an edge
+///        and no edges leaving them
+///
+/// SCCs are computed through an iterative version of Tarjan's algorithm, on
+/// dense indices assigned during the visit. An SCC has an exit if one of its
+/// nodes has an edge towards a node no longer on the Tarjan stack, i.e.,
+/// belonging to an SCC that has already been completed.
+///
+/// \return the SCCs in the same order as llvm::scc_iterator, i.e., reverse
+///         topological order.
 template<typename NodeTy>
-auto exitless_scc_range(NodeTy Entry) {
-  using namespace llvm;
+std::vector<std::vector<NodeTy>> exitless_scc_range(NodeTy Entry) {
+  using GT = llvm::GraphTraits<NodeTy>;
+  using ChildIterator = typename GT::ChildIteratorType;
 
-  auto Range = make_range(scc_begin(Entry), scc_end(Entry));
+  struct Frame {
+    uint32_t Index;
+    ChildIterator Next;
+    ChildIterator End;
+  };
 
-  using NodesVector = std::vector<NodeTy>;
-  using GT = llvm::GraphTraits<NodeTy>;
+  std::vector<std::vector<NodeTy>> Result;
+
+  llvm::DenseMap<NodeTy, uint32_t> Indices;
+  std::vector<NodeTy> Nodes;
+  std::vector<uint32_t> Low;
+  llvm::BitVector OnStack;
+  llvm::BitVector HasExit;
+  llvm::BitVector HasEdges;
+  std::vector<uint32_t> SCCStack;
+  std::vector<Frame> CallStack;
+
+  auto Enter = [&](NodeTy Node) {
+    uint32_t Index = Nodes.size();
+    Indices[Node] = Index;
+    Nodes.push_back(Node);
+    Low.push_back(Index);
+    OnStack.push_back(true);
+    HasExit.push_back(false);
+    auto Begin = GT::child_begin(Node);
+    auto End = GT::child_end(Node);
+    HasEdges.push_back(Begin != End);
+    SCCStack.push_back(Index);
+    CallStack.push_back({ Index, Begin, End });
+  };
 
-  auto Filter = [](const NodesVector &SCC) {
-    std::set<NodeTy> SCCNodes;
-    SCCNodes.clear();
-    for (NodeTy BB : SCC)
-      SCCNodes.insert(BB);
-
-    bool HasExit = false;
-    bool AtLeastOneEdge = false;
-    for (NodeTy BB : SCC) {
-      auto Successors = make_range(GT::child_begin(BB), GT::child_end(BB));
-      for (NodeTy Successor : Successors) {
-        AtLeastOneEdge = true;
-        if (SCCNodes.count(Successor) == 0) {
-          HasExit = true;
-          break;
-        }
+  Enter(Entry);
+  while (not CallStack.empty()) {
+    Frame &Top = CallStack.back();
+    if (Top.Next != Top.End) {
+      NodeTy Child = *Top.Next;
+      ++Top.Next;
+
+      auto It = Indices.find(Child);
+      if (It == Indices.end()) {
+        Enter(Child);
+      } else if (OnStack[It->second]) {
+        Low[Top.Index] = std::min(Low[Top.Index], It->second);
+      } else {
+        HasExit.set(Top.Index);
       }
 
-      if (HasExit)
-        break;
+      continue;
     }
 
-    return (not HasExit) and AtLeastOneEdge;
-  };
+    uint32_t Index = Top.Index;
+    CallStack.pop_back();
+
+    if (Low[Index] == Index) {
+      // Index is the root of an SCC, pop it
+      std::vector<NodeTy> SCC;
+      bool SCCHasExit = false;
+      bool SCCHasEdges = false;
+      uint32_t Member = 0;
+      do {
+        Member = SCCStack.back();
+        SCCStack.pop_back();
+        OnStack.reset(Member);
+        SCC.push_back(Nodes[Member]);
+        SCCHasExit = SCCHasExit or HasExit[Member];
+        SCCHasEdges = SCCHasEdges or HasEdges[Member];
+      } while (Member != Index);
+
+      if (SCCHasEdges and not SCCHasExit)
+        Result.push_back(std::move(SCC));
+    }
+
+    if (not CallStack.empty()) {
+      uint32_t Parent = CallStack.back().Index;
+      if (OnStack[Index])
+        Low[Parent] = std::min(Low[Parent], Low[Index]);
+      else
+        HasExit.set(Parent);
+    }
+  }
 
-  return make_filter_range(Range, Filter);
+  return Result;
 }
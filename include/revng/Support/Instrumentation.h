@@ -0,0 +1,129 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <atomic>
+#include <cstdint>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+class raw_ostream;
+} // namespace llvm
+
+namespace InstrumentationFormat {
+
+enum Values {
+  /// A JSON object with a list of phases and a dictionary of counters
+  JSON,
+  /// The trace event format of chrome://tracing and Perfetto
+  ChromeTrace
+};
+
+} // namespace InstrumentationFormat
+
+namespace detail {
+
+/// Set by -instrumentation-output and by enableInstrumentation
+extern std::atomic<bool> InstrumentationEnabled;
+
+} // namespace detail
+
+/// \brief Whether phases and counters are being recorded
+///
+/// Recording is enabled by -instrumentation-output or by
+/// enableInstrumentation.
+inline bool isInstrumentationEnabled() {
+  return detail::InstrumentationEnabled.load(std::memory_order_relaxed);
+}
+
+/// \brief Record phases even if -instrumentation-output has not been given
+void enableInstrumentation();
+
+/// \brief Write all the phases completed so far and the current value of the
+///        counters to \p Output
+void writeInstrumentation(llvm::raw_ostream &Output,
+                          InstrumentationFormat::Values Format);
+
+/// \brief Time the scope it lives in as a phase of the current thread
+///
+/// For each phase we record the wall time, the CPU time of the current thread
+/// and the peak resident set size of the process at its end. Phases can be
+/// nested, the nesting depth is recorded too. If instrumentation is disabled,
+/// a PhaseTimer costs a relaxed load and a branch.
+///
+/// If -instrumentation-output is given, the phases are written there upon
+/// exit, in the format selected by -instrumentation-format.
+///
+/// \note Phases are meant to be coarse: completing one takes a lock.
+class PhaseTimer {
+private:
+  /// Copied only if the phase is recorded
+  const char *Name;
+  bool Enabled;
+  unsigned Depth = 0;
+  uint64_t StartMicroseconds = 0;
+  uint64_t StartCPUMicroseconds = 0;
+
+public:
+  /// \param Name the name of the phase, it must outlive the timer (e.g., a
+  ///        string literal).
+  PhaseTimer(const char *Name) :
+    Name(Name), Enabled(isInstrumentationEnabled()) {
+    if (Enabled)
+      start();
+  }
+
+  ~PhaseTimer() {
+    if (Enabled)
+      stop();
+  }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+  void start();
+  void stop();
+};
+
+/// \brief A named counter that can be incremented concurrently
+///
+/// Each thread increments a private copy of the counter, without any
+/// synchronization. The private copies are summed up when the counters are
+/// written out. Counters are meant to be global variables.
+///
+/// If instrumentation is disabled, values are not recorded and add costs a
+/// relaxed load and a branch.
+class InstrumentationCounter {
+public:
+  /// Maximum number of counters in a process
+  static constexpr unsigned MaxCounters = 256;
+
+private:
+  unsigned Index;
+
+public:
+  InstrumentationCounter(llvm::StringRef Name);
+
+  InstrumentationCounter(const InstrumentationCounter &) = delete;
+  InstrumentationCounter &operator=(const InstrumentationCounter &) = delete;
+
+public:
+  void add(uint64_t Value = 1) {
+    if (not isInstrumentationEnabled())
+      return;
+
+    std::atomic<uint64_t> &Slot = threadSlot();
+    Slot.store(Slot.load(std::memory_order_relaxed) + Value,
+               std::memory_order_relaxed);
+  }
+
+  /// \return the sum of the values recorded by all the threads so far
+  uint64_t total() const;
+
+private:
+  std::atomic<uint64_t> &threadSlot() const;
+};
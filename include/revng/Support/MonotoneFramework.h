@@ -4,17 +4,26 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <chrono>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <type_traits>
 #include <vector>
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/TypeName.h"
 
 #include "revng/ADT/Queue.h"
 #include "revng/Support/Debug.h"
+#include "revng/Support/Statistics.h"
 
 /// \brief Backport of std::map::insert_or_assign
 template<typename K, typename V>
@@ -59,164 +68,320 @@ public:
 template<VisitType V>
 concept IsPostOrderLike = V == PostOrder or V == ReversePostOrder;
 
-// (Reverse) post order implementation
-template<typename Iterated, VisitType Visit>
-requires IsPostOrderLike<Visit> class MonotoneFrameworkWorkList<Iterated,
-                                                                Visit> {
+/// \brief Dense numbering of a fixed set of labels
+///
+/// Labels are numbered according to the order in which they are provided.
+template<typename Label>
+class DenseLabelIndex {
 private:
-  /// \brief Class for an entry in the work list
-  ///
-  /// All the basic blocks are always in the list in (reverse) post order. When
-  /// an entry is popped it is simply disabled.
-  class PostOrderEntry {
-  private:
-    Iterated Entry;
-    bool Enabled;
+  std::vector<Label> Labels;
+  llvm::DenseMap<Label, unsigned> IDs;
 
-  public:
-    PostOrderEntry(Iterated Entry) : Entry(Entry), Enabled(true) {}
-    void enable() { Enabled = true; }
-    void disable() { Enabled = false; }
-    bool isEnabled() const { return Enabled; }
-    Iterated entry() const { return Entry; }
-  };
+public:
+  explicit DenseLabelIndex(std::vector<Label> &&Labels) :
+    Labels(std::move(Labels)) {
+    IDs.reserve(this->Labels.size());
+    for (unsigned I = 0; I < this->Labels.size(); I++) {
+      bool New = IDs.try_emplace(this->Labels[I], I).second;
+      revng_assert(New);
+    }
+  }
 
-private:
-  /// List of all basic blocks in the appropriate order
-  std::vector<PostOrderEntry> PostOrderList;
+public:
+  size_t size() const { return Labels.size(); }
 
-  /// Map to quickly find the index of an entry in PostOrderList
-  std::map<Iterated, size_t> PostOrderListIndex;
+  Label label(unsigned ID) const { return Labels[ID]; }
+
+  unsigned id(Label L) const {
+    auto It = IDs.find(L);
+    revng_assert(It != IDs.end());
+    return It->second;
+  }
 
-  /// The next index to consume. This should always point to the lowest enabled
-  /// entry in PostOrderList
-  size_t Next;
+  llvm::Optional<unsigned> tryID(Label L) const {
+    auto It = IDs.find(L);
+    if (It == IDs.end())
+      return llvm::None;
+    return It->second;
+  }
+};
 
-  /// Special value for Next to indicate that the work list is empty
-  const static size_t InvalidIndex = std::numeric_limits<size_t>::max();
+/// \brief Dense numbering of labels, in order of first appearance
+///
+/// Used when the labels are not known in advance, i.e., in breadth first
+/// visits, where labels are discovered during the analysis.
+template<typename Label>
+class GrowingLabelIndex {
+private:
+  std::vector<Label> Labels;
+  llvm::DenseMap<Label, unsigned> IDs;
 
 public:
-  MonotoneFrameworkWorkList(const std::vector<Iterated> &RPOT) {
-    for (Iterated Entry : RPOT)
-      PostOrderList.push_back(PostOrderEntry(Entry));
+  size_t size() const { return Labels.size(); }
 
-    initialize();
-  }
+  Label label(unsigned ID) const { return Labels[ID]; }
 
-  MonotoneFrameworkWorkList(const llvm::SmallVectorImpl<Iterated> &RPOT) {
-    for (Iterated Entry : RPOT)
-      PostOrderList.push_back(PostOrderEntry(Entry));
+  /// \brief Get the ID of \p L, numbering it if it's new
+  unsigned id(Label L) {
+    auto [It, New] = IDs.try_emplace(L, Labels.size());
+    if (New)
+      Labels.push_back(L);
+    return It->second;
+  }
 
-    initialize();
+  llvm::Optional<unsigned> tryID(Label L) const {
+    auto It = IDs.find(L);
+    if (It == IDs.end())
+      return llvm::None;
+    return It->second;
   }
+};
 
-  MonotoneFrameworkWorkList(Iterated Entry) :
-    MonotoneFrameworkWorkList(buildRPOT(Entry)) {}
+// (Reverse) post order implementation
+template<typename Iterated, VisitType Visit>
+requires IsPostOrderLike<Visit> class MonotoneFrameworkWorkList<Iterated,
+                                                                Visit> {
+public:
+  using IndexType = DenseLabelIndex<Iterated>;
 
-  size_t size() const {
-    revng_assert(verify());
+private:
+  /// Dense numbering of all the labels, in the order they have to be visited
+  std::shared_ptr<const IndexType> Index;
 
-    if (empty())
-      return 0;
+  /// The set of enabled labels, by ID
+  ///
+  /// Since IDs follow the visit order, the next label to visit is always the
+  /// lowest enabled one.
+  llvm::BitVector Enabled;
 
-    size_t Result = 0;
-    for (size_t I = Next; I < PostOrderList.size(); I++)
-      if (PostOrderList[I].isEnabled())
-        Result++;
+  /// The next ID to consume, or -1 if the work list is empty. This should
+  /// always point to the lowest enabled entry.
+  int Next;
 
-    return Result;
+public:
+  MonotoneFrameworkWorkList(const std::vector<Iterated> &RPOT) :
+    MonotoneFrameworkWorkList(std::vector<Iterated>(RPOT)) {}
+
+  MonotoneFrameworkWorkList(const llvm::SmallVectorImpl<Iterated> &RPOT) :
+    MonotoneFrameworkWorkList(std::vector<Iterated>(RPOT.begin(), RPOT.end())) {
   }
 
+  MonotoneFrameworkWorkList(Iterated Entry) :
+    MonotoneFrameworkWorkList(buildRPOT(Entry)) {}
+
+  /// \brief The dense numbering of the labels used by this work list
+  const std::shared_ptr<const IndexType> &index() const { return Index; }
+
+  size_t size() const { return Enabled.count(); }
+
   void clear() {
-    for (PostOrderEntry &Entry : PostOrderList)
-      Entry.disable();
-    Next = InvalidIndex;
+    Enabled.reset();
+    Next = -1;
   }
 
   void insert(Iterated Entry) {
-    // Find the entry
-    auto It = PostOrderListIndex.find(Entry);
-    revng_assert(It != PostOrderListIndex.end());
+    unsigned ID = Index->id(Entry);
 
     // Enable it
-    PostOrderList[It->second].enable();
+    Enabled.set(ID);
 
     // Reset next to the lowest enabled index, if necessary
-    Next = std::min(Next, It->second);
+    if (empty() or static_cast<int>(ID) < Next)
+      Next = ID;
   }
 
-  bool empty() const { return Next == InvalidIndex; }
+  bool empty() const { return Next == -1; }
 
   Iterated head() const {
-    revng_assert(Next != InvalidIndex);
-    return PostOrderList[Next].entry();
+    revng_assert(not empty());
+    return Index->label(Next);
   }
 
   Iterated pop() {
     revng_assert(not empty());
-    revng_assert(verify());
+    revng_assert(Enabled.find_first() == Next);
 
-    // Start from the next element and look for an enabled element
-    size_t I = Next + 1;
-    for (; I < PostOrderList.size(); I++)
-      if (PostOrderList[I].isEnabled())
-        break;
+    // Consume the current entry and look for the next enabled one
+    unsigned OldNext = Next;
+    Enabled.reset(OldNext);
+    Next = Enabled.find_next(OldNext);
 
-    // Update Next
-    size_t OldNext = Next;
-    Next = (I >= PostOrderList.size()) ? InvalidIndex : I;
+    return Index->label(OldNext);
+  }
 
-    // Consume the previous next
-    PostOrderList[OldNext].disable();
+private:
+  explicit MonotoneFrameworkWorkList(std::vector<Iterated> &&RPOT) {
+    // Reverse the list in case we don't want the reverse post order
+    if (Visit == PostOrder)
+      std::reverse(RPOT.begin(), RPOT.end());
 
-    // Return the consumed entry
-    return PostOrderList[OldNext].entry();
+    Enabled.resize(RPOT.size(), true);
+    Next = RPOT.size() > 0 ? 0 : -1;
+    Index = std::make_shared<const IndexType>(std::move(RPOT));
   }
 
-private:
   static std::vector<Iterated> buildRPOT(Iterated Entry) {
-    // Populate PostOrderList
     std::vector<Iterated> RPOT;
     for (Iterated I : llvm::ReversePostOrderTraversal<Iterated>(Entry))
       RPOT.push_back(I);
 
     return RPOT;
   }
+};
+
+/// \brief Map from labels to lattice elements backed by a vector
+///
+/// Labels are translated into dense IDs through \p IndexT, either a
+/// DenseLabelIndex, fixed at construction time, or a GrowingLabelIndex, which
+/// numbers new labels upon insertion. The interface mimics the subset of
+/// std::map used by MonotoneFramework and its users.
+///
+/// \note Insertions might invalidate iterators.
+template<typename Label,
+         typename Value,
+         typename IndexT = const DenseLabelIndex<Label>>
+class DenseStateMap {
+public:
+  using IndexType = IndexT;
+  using key_type = Label;
+  using mapped_type = Value;
+  using value_type = std::pair<const Label, Value>;
 
 private:
-  void initialize() {
-    // Reverse the list in case we don't want the reverse post order
-    if (Visit == PostOrder)
-      std::reverse(PostOrderList.begin(), PostOrderList.end());
+  using Slot = std::optional<value_type>;
+
+  template<typename SlotIterator, typename T>
+  class IteratorImpl {
+  private:
+    SlotIterator It;
+    SlotIterator End;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+  public:
+    IteratorImpl() = default;
+    IteratorImpl(SlotIterator It, SlotIterator End) : It(It), End(End) {
+      skipEmpty();
+    }
+
+    template<typename OtherIterator, typename OtherT>
+    IteratorImpl(const IteratorImpl<OtherIterator, OtherT> &Other) :
+      It(Other.It), End(Other.End) {}
+
+    bool operator==(const IteratorImpl &Other) const { return It == Other.It; }
+    bool operator!=(const IteratorImpl &Other) const { return It != Other.It; }
 
-    // Populate the index, used for faster lookups
-    for (unsigned I = 0; I < PostOrderList.size(); I++)
-      PostOrderListIndex[PostOrderList[I].entry()] = I;
+    reference operator*() const { return **It; }
+    pointer operator->() const { return &**It; }
 
-    // Initialize the next index
-    Next = (PostOrderList.size() > 0) ? 0 : InvalidIndex;
+    IteratorImpl &operator++() {
+      ++It;
+      skipEmpty();
+      return *this;
+    }
+
+    IteratorImpl operator++(int) {
+      IteratorImpl Result = *this;
+      ++*this;
+      return Result;
+    }
+
+  private:
+    template<typename, typename>
+    friend class IteratorImpl;
+
+    void skipEmpty() {
+      while (It != End and not It->has_value())
+        ++It;
+    }
+  };
+
+public:
+  using iterator = IteratorImpl<typename std::vector<Slot>::iterator,
+                                value_type>;
+  using const_iterator = IteratorImpl<
+    typename std::vector<Slot>::const_iterator,
+    const value_type>;
+
+private:
+  std::shared_ptr<IndexType> Index;
+  std::vector<Slot> Slots;
+  size_t Count = 0;
+
+public:
+  explicit DenseStateMap(std::shared_ptr<IndexType> Index) :
+    Index(std::move(Index)), Slots(this->Index->size()) {}
+
+public:
+  iterator begin() { return iterator(Slots.begin(), Slots.end()); }
+  iterator end() { return iterator(Slots.end(), Slots.end()); }
+  const_iterator begin() const {
+    return const_iterator(Slots.begin(), Slots.end());
+  }
+  const_iterator end() const {
+    return const_iterator(Slots.end(), Slots.end());
   }
 
-  bool verify() const {
-    if (PostOrderList.size() == 0 and not empty())
-      return false;
+  size_t size() const { return Count; }
+  bool empty() const { return Count == 0; }
 
-    if (empty()) {
-      // If the worklist is empty, no elements should be enabled
-      for (const PostOrderEntry &Entry : PostOrderList)
-        if (Entry.isEnabled())
-          return false;
-    } else {
-      // Otherwise, all the elements up to next should be disabled
-      for (size_t I = 0; I != Next; I++)
-        if (PostOrderList[I].isEnabled())
-          return false;
+  void clear() {
+    for (Slot &S : Slots)
+      S.reset();
+    Count = 0;
+  }
+
+  iterator find(Label L) {
+    auto ID = Index->tryID(L);
+    if (not ID or not Slots[*ID].has_value())
+      return end();
+    return iterator(Slots.begin() + *ID, Slots.end());
+  }
+
+  const_iterator find(Label L) const {
+    auto ID = Index->tryID(L);
+    if (not ID or not Slots[*ID].has_value())
+      return end();
+    return const_iterator(Slots.begin() + *ID, Slots.end());
+  }
 
-      if (not PostOrderList[Next].isEnabled())
-        return false;
+  size_t count(Label L) const { return find(L) != end() ? 1 : 0; }
+
+  Value &operator[](Label L) {
+    Slot &S = Slots[slotID(L)];
+    if (not S.has_value()) {
+      S.emplace(L, Value());
+      ++Count;
     }
+    return S->second;
+  }
 
-    return true;
+  template<typename V>
+  std::pair<iterator, bool> insert_or_assign(Label L, V &&NewValue) {
+    unsigned ID = slotID(L);
+    Slot &S = Slots[ID];
+    bool Inserted = not S.has_value();
+    if (Inserted) {
+      S.emplace(L, std::forward<V>(NewValue));
+      ++Count;
+    } else {
+      S->second = std::forward<V>(NewValue);
+    }
+    return { iterator(Slots.begin() + ID, Slots.end()), Inserted };
+  }
+
+private:
+  /// \brief Get the ID of \p L, making room for it if the index has grown
+  unsigned slotID(Label L) {
+    unsigned ID = Index->id(L);
+    if (ID >= Slots.size())
+      Slots.resize(Index->size());
+    return ID;
   }
 };
 
@@ -323,6 +488,64 @@ struct InterruptCreator<D, LatticeElement, DefaultInterrupt<LatticeElement>> {
     return DefaultInterrupt<LatticeElement>();
   }
 };
+template<typename T>
+concept HasTop = requires {
+  { T::top() } -> std::convertible_to<T>;
+};
+
+/// \brief Data about the convergence of a MonotoneFramework instance
+///
+/// Data is collected since the last call to MonotoneFramework::initialize.
+struct MonotoneFrameworkTelemetry {
+  /// Number of evaluations of the transfer function
+  uint64_t Visits = 0;
+
+  /// Highest number of visits of a single label
+  uint64_t MaxLabelVisits = 0;
+
+  /// Number of times the state associated to a label has grown
+  uint64_t Growths = 0;
+
+  /// Number of times the widening hook has been invoked
+  uint64_t Widenings = 0;
+
+  /// Time spent in MonotoneFramework::run, in microseconds
+  uint64_t Microseconds = 0;
+
+  /// Whether the iterations budget has been exhausted
+  bool BudgetExhausted = false;
+};
+
+/// \brief Statistics about all the runs of a certain MonotoneFramework
+///
+/// These are printed upon program termination if `-statistics` is enabled.
+class MonotoneFrameworkStatistics : public OnQuitInteraface {
+private:
+  std::mutex Lock;
+  std::string Name;
+  uint64_t Runs = 0;
+  uint64_t ExhaustedBudgets = 0;
+  uint64_t Widenings = 0;
+  MonotoneFrameworkTelemetry Worst;
+  RunningStatistics Visits;
+  RunningStatistics LabelVisits;
+  RunningStatistics Growths;
+  RunningStatistics Microseconds;
+
+public:
+  MonotoneFrameworkStatistics(llvm::StringRef Name);
+  virtual ~MonotoneFrameworkStatistics() {}
+
+public:
+  /// \brief Record the telemetry of a run that reached a fixed point
+  ///
+  /// \param VisitsPerLabel number of visits of each label.
+  void record(const MonotoneFrameworkTelemetry &T,
+              const std::vector<uint64_t> &VisitsPerLabel);
+
+  virtual void onQuit();
+};
+
 /// \brief CRTP base class for implementing a monotone framework
 ///
 /// This class provides the base structure to implement an analysis based on a
@@ -369,10 +592,26 @@ protected:
   /// \note Unused if DynamicGraph == true
   bool FirstFinalResult;
 
-  MonotoneFrameworkWorkList<Label, Visit> WorkList;
+  using WorkListType = MonotoneFrameworkWorkList<Label, Visit>;
+  WorkListType WorkList;
+
+  /// \brief Index numbering the labels of the state
+  ///
+  /// For (reverse) post order visits, all the labels are known in advance and
+  /// numbered by the work list, otherwise they're numbered as they're
+  /// discovered.
+  using LabelIndexType = std::conditional_t<IsPostOrderLike<Visit>,
+                                            const DenseLabelIndex<Label>,
+                                            GrowingLabelIndex<Label>>;
+
+  template<typename Value>
+  using LabelMap = DenseStateMap<Label, Value, LabelIndexType>;
+
+  /// \brief Type of the state of the monotone framework
+  using StateType = LabelMap<LatticeElement>;
 
   /// State of the monotone framework, maps a label to a lattice element
-  std::map<Label, LatticeElement> State;
+  StateType State;
 
   /// List of basic blocks we want to be sure to visit again before the end of
   /// the analysis
@@ -399,19 +638,64 @@ protected:
   /// \note Unused if DynamicGraph == false
   std::map<Label, llvm::SmallVector<Label, 2>> SuccessorsMap;
 
+  /// Number of times each label has been visited
+  ///
+  /// \note Used only if CollectTelemetry or WideningThreshold != 0
+  using VisitsMapType = LabelMap<uint64_t>;
+  VisitsMapType LabelVisits;
+
+  /// Collect the per-label visits and the timing of the runs, and record them
+  /// in statistics(). Enabled by `-statistics`.
+  bool CollectTelemetry = false;
+
+  /// Convergence data of the current run
+  MonotoneFrameworkTelemetry Telemetry;
+
+  /// Maximum number of visits before falling back to top, 0 for no limit
+  uint64_t IterationsBudget = 0;
+
+  /// Number of visits of a label after which widen is invoked on it, 0 to
+  /// never invoke it
+  uint64_t WideningThreshold = 0;
+
 public:
   using InterruptType = Interrupt;
 
   MonotoneFramework(Label Entry) :
-    FinalResult(LatticeElement::bottom()), WorkList(Entry) {}
+    FinalResult(LatticeElement::bottom()),
+    WorkList(Entry),
+    State(makeLabelMap<StateType>(WorkList)),
+    LabelVisits(makeLabelMap<VisitsMapType>(WorkList)) {}
 
   MonotoneFramework(const std::vector<Label> &RPOT) :
-    FinalResult(LatticeElement::bottom()), WorkList(RPOT) {}
+    FinalResult(LatticeElement::bottom()),
+    WorkList(RPOT),
+    State(makeLabelMap<StateType>(WorkList)),
+    LabelVisits(makeLabelMap<VisitsMapType>(WorkList)) {}
 
   MonotoneFramework(const llvm::SmallVectorImpl<Label> &RPOT) :
-    FinalResult(LatticeElement::bottom()), WorkList(RPOT) {}
+    FinalResult(LatticeElement::bottom()),
+    WorkList(RPOT),
+    State(makeLabelMap<StateType>(WorkList)),
+    LabelVisits(makeLabelMap<VisitsMapType>(WorkList)) {}
 
 private:
+  template<typename T>
+  static T makeLabelMap(const WorkListType &WorkList) {
+    if constexpr (IsPostOrderLike<Visit>)
+      return T(WorkList.index());
+    else
+      return T(std::make_shared<LabelIndexType>());
+  }
+
+  /// \brief Statistics shared by all the instances of D
+  static MonotoneFrameworkStatistics &statistics() {
+    // Intentionally leaked, since it has to outlive the OnQuit handlers
+    using Statistics = MonotoneFrameworkStatistics;
+    static auto *Result = new Statistics(llvm::getTypeName<D>());
+    return *Result;
+  }
+
   const D &derived() const { return *static_cast<const D *>(this); }
   D &derived() { return *static_cast<D *>(this); }
   InterruptCreator<D, LatticeElement, InterruptType> TheInterruptCreator;
@@ -490,6 +774,43 @@ public:
     return derived().handleEdge(Original, Source, Destination);
   }
 
+  /// \brief Widen the state associated to \p L
+  ///
+  /// This method is invoked when the state of a label that has already been
+  /// visited at least WideningThreshold times grows. \p Previous is the old
+  /// state, \p Current the state after combining the new element, which can
+  /// be further increased to speed up convergence.
+  ///
+  /// \note The derived class D can optionally implement this method, by
+  ///       default no widening is performed
+  void widen(Label L, const LatticeElement &Previous, LatticeElement &Current) {
+  }
+
+  /// \brief Limit the number of visits performed by run
+  ///
+  /// Once \p Budget visits have been performed, any label whose state would
+  /// grow is set to top, which ensures quick convergence to a sound result.
+  ///
+  /// \param Budget the maximum number of visits, 0 means no limit.
+  void setIterationsBudget(uint64_t Budget) {
+    static_assert(HasTop<LatticeElement>,
+                  "Iteration budgets require LatticeElement::top()");
+    IterationsBudget = Budget;
+  }
+
+  /// \brief Invoke widen on labels visited at least \p Threshold times
+  ///
+  /// \param Threshold the number of visits, 0 means widen is never invoked.
+  void setWideningThreshold(uint64_t Threshold) {
+    WideningThreshold = Threshold;
+  }
+
+  /// \brief Data about the convergence of the analysis so far
+  ///
+  /// \note Microseconds is collected only if statistics are enabled,
+  ///       MaxLabelVisits also if a widening threshold is set
+  const MonotoneFrameworkTelemetry &telemetry() const { return Telemetry; }
+
   /// \brief Initialize/reset the analysis
   ///
   /// Call this method before invoking run or if you want to reset the state of
@@ -500,10 +821,13 @@ public:
     State.clear();
     WorkList.clear();
     ToVisit.clear();
+    LabelVisits.clear();
+    Telemetry = MonotoneFrameworkTelemetry();
+    CollectTelemetry = areStatisticsEnabled();
 
     for (Label ExtremalLabel : Extremals) {
       WorkList.insert(ExtremalLabel);
-      insert_or_assign(State, ExtremalLabel, extremalValue(ExtremalLabel));
+      State.insert_or_assign(ExtremalLabel, extremalValue(ExtremalLabel));
     }
   }
 
@@ -530,12 +854,73 @@ public:
 
   /// \brief Resolve the data flow analysis problem using the MFP solution
   Interrupt run() {
+    if (not CollectTelemetry)
+      return runImpl();
+
+    auto StartTime = std::chrono::steady_clock::now();
+    Interrupt Result = runImpl();
+
+    using namespace std::chrono;
+    auto Elapsed = steady_clock::now() - StartTime;
+    Telemetry.Microseconds += duration_cast<microseconds>(Elapsed).count();
+
+    // Record the statistics only if a fixed point has been reached
+    if (WorkList.empty())
+      recordStatistics();
+
+    return Result;
+  }
+
+private:
+  void recordStatistics() {
+    std::vector<uint64_t> VisitsPerLabel;
+    VisitsPerLabel.reserve(LabelVisits.size());
+    for (const auto &P : LabelVisits)
+      VisitsPerLabel.push_back(P.second);
+
+    statistics().record(Telemetry, VisitsPerLabel);
+  }
+
+  /// \brief Merge \p NewElement into \p Target, the state of \p L
+  void grow(Label L, LatticeElement &Target, LatticeElement &NewElement) {
+    ++Telemetry.Growths;
+
+    if (Telemetry.BudgetExhausted) {
+      if constexpr (HasTop<LatticeElement>)
+        Target = LatticeElement::top();
+      else
+        revng_abort();
+      return;
+    }
+
+    auto It = LabelVisits.find(L);
+    if (WideningThreshold != 0 and It != LabelVisits.end()
+        and It->second >= WideningThreshold) {
+      LatticeElement Previous = Target.copy();
+      Target.combine(NewElement);
+      derived().widen(L, Previous, Target);
+      ++Telemetry.Widenings;
+    } else {
+      Target.combine(NewElement);
+    }
+  }
+
+  Interrupt runImpl() {
     using namespace llvm;
 
     // Proceed until there are elements in the work list
     while (not WorkList.empty()) {
       Label ToAnalyze = WorkList.head();
 
+      // Account for this visit
+      ++Telemetry.Visits;
+      if (IterationsBudget != 0 and Telemetry.Visits > IterationsBudget)
+        Telemetry.BudgetExhausted = true;
+      if (CollectTelemetry or WideningThreshold != 0) {
+        uint64_t Visits = ++LabelVisits[ToAnalyze];
+        Telemetry.MaxLabelVisits = std::max(Telemetry.MaxLabelVisits, Visits);
+      }
+
       // If we've been asked to visit this basic block before the end, consider
       // the requested satified
       ToVisit.erase(ToAnalyze);
@@ -607,9 +992,9 @@ public:
           // If this is the only successor or we got a new element we can use
           // move semantics, otherwise create a copy
           if (SuccessorsCount == 1 or GotNewElement)
-            insert_or_assign(State, Successor, std::move(ActualElement));
+            State.insert_or_assign(Successor, std::move(ActualElement));
           else
-            insert_or_assign(State, Successor, ActualElement.copy());
+            State.insert_or_assign(Successor, ActualElement.copy());
 
           // Enqueue the successor
           WorkList.insert(Successor);
@@ -619,7 +1004,7 @@ public:
           // function is larger than its previous initial state
 
           // Update the state merging ActualElement
-          It->second.combine(ActualElement);
+          grow(Successor, It->second, ActualElement);
 
           // Assert we're now actually lower than or equal
           assertLowerThanOrEqual(ActualElement, It->second);
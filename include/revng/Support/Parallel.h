@@ -0,0 +1,124 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+extern llvm::cl::opt<unsigned> ParallelJobs;
+
+/// \return the number of threads to employ, as requested by -parallel-jobs, or
+///         the number of available hardware threads if -parallel-jobs is 0
+unsigned threadsCount();
+
+/// \return a thread pool with at least \p MinThreads threads, private to the
+///         calling thread and reused across calls
+///
+/// Since the pool belongs to the calling thread, waiting on it only waits for
+/// the tasks submitted by this thread, even if the caller is itself a worker
+/// of another pool.
+llvm::ThreadPool &threadPool(unsigned MinThreads);
+
+/// \brief Split [0, Size) in at most MaxShards contiguous shards of roughly
+///        the same size and run \p Callable on each of them in parallel
+///
+/// \p Callable is invoked as `Callable(ShardIndex, Begin, End)`. Shard indices
+/// are assigned in order, so the caller can store per-shard results in a
+/// vector indexed by the shard and merge them deterministically afterwards.
+///
+/// If there's a single shard, \p Callable is invoked on the current thread.
+///
+/// \return the number of shards.
+template<typename L>
+size_t forEachShard(size_t Size, size_t MaxShards, const L &Callable) {
+  size_t Shards = std::min(Size, MaxShards);
+  if (Shards <= 1) {
+    Callable(0, 0, Size);
+    return 1;
+  }
+
+  auto ShardBegin = [Size, Shards](size_t Shard) {
+    return (Size * Shard) / Shards;
+  };
+
+  llvm::ThreadPool &Pool = threadPool(Shards);
+  for (size_t Shard = 0; Shard < Shards; ++Shard) {
+    size_t Begin = ShardBegin(Shard);
+    size_t End = ShardBegin(Shard + 1);
+    Pool.async([&Callable, Shard, Begin, End]() {
+      Callable(Shard, Begin, End);
+    });
+  }
+  Pool.wait();
+
+  return Shards;
+}
+
+/// \brief Shard [0, Size) in as many shards as the available threads
+template<typename L>
+size_t forEachShard(size_t Size, const L &Callable) {
+  return forEachShard(Size, threadsCount(), Callable);
+}
+
+/// \brief Solve a set of independent problems, such as fixed point
+///        computations on different functions, in parallel
+///
+/// \p Solve is invoked as `Solve(Root, State)` on each element of \p Roots.
+/// State is a ThreadStateT (e.g., an allocator or a cache) private to the
+/// worker thread: it's created once per thread and reused for all the roots
+/// handled by it. \p Solve must not access data shared with other roots,
+/// unless it's thread-safe.
+///
+/// Roots are handed out one at a time to the first idle worker, so that a
+/// few expensive roots do not hold back the others. The results are returned
+/// in the order of \p Roots, independently from the order in which they have
+/// been computed, so that merging them afterwards is deterministic.
+///
+/// If a single thread is employed, everything runs on the current thread.
+template<typename ThreadStateT = std::monostate, typename RootsT, typename L>
+auto solveIndependent(const RootsT &Roots,
+                      const L &Solve,
+                      size_t MaxThreads = threadsCount()) {
+  using RootT = decltype(*std::begin(Roots));
+  using ResultT = std::invoke_result_t<const L &, RootT, ThreadStateT &>;
+
+  size_t Size = std::size(Roots);
+  std::vector<std::optional<ResultT>> Results(Size);
+  std::atomic<size_t> NextRoot = 0;
+
+  auto Worker = [&]() {
+    ThreadStateT State;
+    size_t Index;
+    while ((Index = NextRoot.fetch_add(1, std::memory_order_relaxed)) < Size)
+      Results[Index].emplace(Solve(*(std::begin(Roots) + Index), State));
+  };
+
+  size_t Workers = std::min(Size, MaxThreads);
+  if (Workers <= 1) {
+    Worker();
+  } else {
+    llvm::ThreadPool &Pool = threadPool(Workers);
+    for (size_t I = 0; I < Workers; ++I)
+      Pool.async(Worker);
+    Pool.wait();
+  }
+
+  std::vector<ResultT> Result;
+  Result.reserve(Size);
+  for (std::optional<ResultT> &Entry : Results)
+    Result.push_back(std::move(*Entry));
+
+  return Result;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "revng/Support/GraphAlgorithms.h"
+#include "revng/Support/Parallel.h"
+
+namespace detail {
+
+/// Graphs smaller than this are not worth spawning a thread for
+inline constexpr size_t ParallelNodesBetweenThreshold = 1 << 16;
+
+/// \brief Run the forward (0) and the backward (1) visits of the dense
+///        nodesBetweenImpl concurrently, if the graph is large enough
+struct ConcurrentVisits {
+  template<typename VisitT>
+  void operator()(size_t GraphSize, const VisitT &Visit) const {
+    size_t MaxShards = 1;
+    if (GraphSize >= ParallelNodesBetweenThreshold)
+      MaxShards = 2;
+
+    forEachShard(2, MaxShards, [&Visit](size_t, size_t Begin, size_t End) {
+      for (size_t Direction = Begin; Direction < End; ++Direction)
+        Visit(Direction);
+    });
+  }
+};
+
+} // namespace detail
+
+/// \brief nodesBetween, running the forward and the backward visits on two
+///        threads
+///
+/// Only available for nodes knowing their dense index, i.e., FrozenGraph.
+template<class G>
+inline llvm::SmallPtrSet<G, 4>
+parallelNodesBetween(G Source,
+                     G Destination,
+                     const llvm::SmallPtrSetImpl<G> *IgnoreList = nullptr) {
+  using namespace llvm;
+  static_assert(::detail::DenselyIndexedNode<G>);
+  return nodesBetweenImpl<GraphTraits<G>,
+                          GraphTraits<Inverse<G>>,
+                          G,
+                          ::detail::ConcurrentVisits>(Source,
+                                                    Destination,
+                                                    IgnoreList);
+}
+
+/// \brief nodesBetweenReverse, running the forward and the backward visits on
+///        two threads
+///
+/// Only available for nodes knowing their dense index, i.e., FrozenGraph.
+template<class G>
+inline llvm::SmallPtrSet<G, 4>
+parallelNodesBetweenReverse(G Source,
+                            G Destination,
+                            const llvm::SmallPtrSetImpl<G> *IgnoreList =
+                              nullptr) {
+  using namespace llvm;
+  static_assert(::detail::DenselyIndexedNode<G>);
+  return nodesBetweenImpl<GraphTraits<Inverse<G>>,
+                          GraphTraits<G>,
+                          G,
+                          ::detail::ConcurrentVisits>(Source,
+                                                    Destination,
+                                                    IgnoreList);
+}
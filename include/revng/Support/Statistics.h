@@ -4,6 +4,7 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cmath>
 #include <csignal>
 #include <cstdlib>
 #include <map>
@@ -110,7 +111,7 @@ public:
   /// \arg Register whether this object should be registered for being printed
   ///      upon program termination or not.
   RunningStatistics(const llvm::Twine &Name, bool Register) :
-    Name(Name.str()), N(0) {
+    Name(Name.str()), N(0), Sum(0) {
 
     if (Register)
       init();
@@ -118,7 +119,10 @@ public:
 
   virtual ~RunningStatistics() {}
 
-  void clear() { N = 0; }
+  void clear() {
+    N = 0;
+    Sum = 0;
+  }
 
   // TODO: make a template
   /// \brief Record a new value
@@ -210,3 +214,6 @@ inline void CounterMap<K, T>::init() {
 }
 
 extern void installStatistics();
+
+/// \brief Whether statistics will be printed upon exit (i.e., `-statistics`)
+extern bool areStatisticsEnabled();
@@ -4,10 +4,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
 #include <optional>
 
 #include "llvm/IR/PassManager.h"
 
+#include "revng/TypeShrinking/DataFlowGraph.h"
+
 namespace TypeShrinking {
 
 extern const uint32_t Top;
@@ -16,6 +19,13 @@ bool isDataFlowSink(const llvm::Instruction *Ins);
 
 using BitLivenessAnalysisResults = std::map<llvm::Instruction *, uint32_t>;
 
+/// Run the bit liveness analysis on the data-flow graph of a function
+///
+/// \note This only reads the IR, it can run concurrently on different
+///       functions.
+BitLivenessAnalysisResults
+computeBitLiveness(GenericGraph<DataFlowNode> &DataFlowGraph);
+
 class BitLivenessWrapperPass : public llvm::FunctionPass {
 public:
   static char ID; // Pass identification, replacement for typeid
@@ -19,6 +19,16 @@ struct DataFlowNodeData {
 
 using DataFlowNode = BidirectionalNode<DataFlowNodeData>;
 
+} // namespace TypeShrinking
+
+/// Data flow graphs have a node per instruction, allocate them in chunks
+template<>
+struct GenericGraphAllocation<TypeShrinking::DataFlowNode> {
+  using type = ChunkedNodes<>;
+};
+
+namespace TypeShrinking {
+
 /// Builds a data flow graph with edges from uses to definitions
 GenericGraph<DataFlowNode> buildDataFlowGraph(llvm::Function &F);
 
@@ -6,17 +6,20 @@
 
 #include <compare>
 #include <cstddef>
-#include <map>
-#include <queue>
+#include <optional>
 #include <type_traits>
+#include <vector>
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/PostOrderIterator.h"
-#include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/ADT/GenericGraph.h"
 #include "revng/ADT/ReversePostOrderTraversal.h"
+#include "revng/Support/Assert.h"
 #include "revng/Support/Concepts.h"
 
 namespace TypeShrinking {
@@ -51,92 +54,142 @@ concept MonotoneFrameworkInstance = requires(typename MFI::LatticeElement E1,
   // clang-format on
 };
 
+/// Worklist of dense priorities, popping the lowest priority first
+///
+/// Priorities are bucketed in the words of a bit vector: pushing is a bit
+/// set, popping is a scan for the first non-empty bucket starting from the
+/// lowest priority that might be enabled.
+class DensePriorityWorklist {
+private:
+  llvm::BitVector Enabled;
+  size_t Lowest = 0;
+  size_t Count = 0;
+
+public:
+  DensePriorityWorklist(size_t Size) : Enabled(Size), Lowest(Size) {}
+
+public:
+  bool empty() const { return Count == 0; }
+
+  void push(size_t Priority) {
+    if (Enabled.test(Priority))
+      return;
+
+    Enabled.set(Priority);
+    Lowest = std::min(Lowest, Priority);
+    ++Count;
+  }
+
+  size_t pop() {
+    revng_assert(not empty());
+    int Priority = Enabled.find_first_in(Lowest, Enabled.size());
+    revng_assert(Priority != -1);
+    Enabled.reset(Priority);
+    Lowest = Priority + 1;
+    --Count;
+    return Priority;
+  }
+};
+
+template<typename Label, typename LatticeElement>
+using MFPResults = std::vector<std::pair<Label, MFPResult<LatticeElement>>>;
+
 /// Compute the maximum fixed points of an instance of monotone framework
 /// GT an instance of llvm::GraphTraits
+///
+/// Labels are numbered densely in the order in which they're visited (reverse
+/// post order from the extremal labels first), which is also their priority
+/// in the worklist. The results are in the same order.
 template<MonotoneFrameworkInstance MFI,
          typename GT = llvm::GraphTraits<typename MFI::GraphType>>
-std::map<typename MFI::Label, MFPResult<typename MFI::LatticeElement>>
+MFPResults<typename MFI::Label, typename MFI::LatticeElement>
 getMaximalFixedPoint(const typename MFI::GraphType &Flow,
                      typename MFI::LatticeElement InitialValue,
                      typename MFI::LatticeElement ExtremalValue,
                      const std::vector<typename MFI::Label> &ExtremalLabels) {
   typedef typename MFI::Label Label;
   typedef typename MFI::LatticeElement LatticeElement;
-  std::map<Label, LatticeElement> PartialAnalysis;
-  std::map<Label, MFPResult<LatticeElement>> AnalysisResult;
-
-  struct WorklistItem {
-    size_t Priority;
-    Label Item;
 
-    std::strong_ordering operator<=>(const WorklistItem &) const = default;
-  };
-  std::set<WorklistItem> Worklist;
+  size_t NodesCount = std::distance(GT::nodes_begin(Flow), GT::nodes_end(Flow));
 
-  llvm::SmallSet<Label, 8> Visited{};
-  std::map<Label, size_t> LabelPriority;
+  // Labels in order of priority, and the other way around
+  std::vector<Label> Labels;
+  llvm::DenseMap<Label, size_t> LabelPriority;
+  Labels.reserve(NodesCount);
+  LabelPriority.reserve(NodesCount);
 
-  // Step 1 initialize the worklist and extremal labels
-  for (Label ExtremalLabel : ExtremalLabels) {
-    PartialAnalysis[ExtremalLabel] = ExtremalValue;
-  }
+  llvm::DenseSet<Label> Visited;
+  Visited.reserve(NodesCount);
 
-  // Handle the special case that the graph has a single entry node
-  if (GT::getEntryNode(Flow) != nullptr) {
-    ReversePostOrderTraversalExt RPOTE(GT::getEntryNode(Flow), Visited);
+  // Step 1 number the labels
+  auto Enumerate = [&](Label Start) {
+    ReversePostOrderTraversalExt RPOTE(Start, Visited);
     for (Label Node : RPOTE) {
-      LabelPriority[Node] = LabelPriority.size();
-      Worklist.insert({ LabelPriority.at(Node), Node });
-      // initialize the analysis value for non extremal nodes
-      if (PartialAnalysis.find(Node) == PartialAnalysis.end()) {
-        PartialAnalysis[Node] = InitialValue;
-      }
+      LabelPriority[Node] = Labels.size();
+      Labels.push_back(Node);
     }
-  }
+  };
+
+  // Handle the special case that the graph has a single entry node
+  if (GT::getEntryNode(Flow) != nullptr)
+    Enumerate(GT::getEntryNode(Flow));
+
   // Start visits for nodes that we still haven't visited
   // prioritizing extremal nodes
-  std::vector<Label> Nodes(ExtremalLabels);
-  for (Label Node : llvm::nodes(Flow)) {
-    Nodes.push_back(Node);
-  }
-  for (Label Start : Nodes) {
-    if (Visited.count(Start) == 0) {
-      // Fill the worklist with nodes in reverse post order
-      // lauching a visit from each remaining node
-      ReversePostOrderTraversalExt RPOTE(Start, Visited);
-      for (Label Node : RPOTE) {
-        LabelPriority[Node] = LabelPriority.size();
-        Worklist.insert({ LabelPriority.at(Node), Node });
-        // initialize the analysis value for non extremal nodes
-        if (PartialAnalysis.find(Node) == PartialAnalysis.end()) {
-          PartialAnalysis[Node] = InitialValue;
-        }
-      }
-    }
-  }
+  for (Label Start : ExtremalLabels)
+    if (Visited.count(Start) == 0)
+      Enumerate(Start);
+
+  for (Label Start : llvm::nodes(Flow))
+    if (Visited.count(Start) == 0)
+      Enumerate(Start);
+
+  // Initialize the analysis values and fill the worklist
+  std::vector<LatticeElement> PartialAnalysis(Labels.size(), InitialValue);
+  for (Label ExtremalLabel : ExtremalLabels)
+    PartialAnalysis[LabelPriority.lookup(ExtremalLabel)] = ExtremalValue;
+
+  DensePriorityWorklist Worklist(Labels.size());
+  for (size_t Priority = 0; Priority < Labels.size(); ++Priority)
+    Worklist.push(Priority);
 
   // Step 2 iteration
-  while (!Worklist.empty()) {
-    WorklistItem First = *Worklist.begin();
-    Label Start = First.Item;
-    Worklist.erase(First);
+  while (not Worklist.empty()) {
+    size_t StartPriority = Worklist.pop();
+    Label Start = Labels[StartPriority];
+
+    // The transfer function is applied once per label, unless the label is
+    // its own successor and its value changes
+    std::optional<LatticeElement> UpdatedEndAnalysis;
     for (Label End : successors<GT>(Start)) {
-      auto &PartialStart = PartialAnalysis.at(Start);
-      LatticeElement
+      if (not UpdatedEndAnalysis.has_value()) {
+        const LatticeElement &PartialStart = PartialAnalysis[StartPriority];
         UpdatedEndAnalysis = MFI::applyTransferFunction(Start, PartialStart);
-      auto &PartialEnd = PartialAnalysis.at(End);
-      if (!MFI::isLessOrEqual(UpdatedEndAnalysis, PartialEnd)) {
-        PartialEnd = MFI::combineValues(PartialEnd, UpdatedEndAnalysis);
-        Worklist.insert({ LabelPriority.at(End), End });
+      }
+
+      size_t EndPriority = LabelPriority.find(End)->second;
+      auto &PartialEnd = PartialAnalysis[EndPriority];
+      if (!MFI::isLessOrEqual(*UpdatedEndAnalysis, PartialEnd)) {
+        PartialEnd = MFI::combineValues(PartialEnd, *UpdatedEndAnalysis);
+        Worklist.push(EndPriority);
+        if (EndPriority == StartPriority)
+          UpdatedEndAnalysis.reset();
       }
     }
   }
 
   // Step 3 presenting the results
-  for (auto &[Node, Analysis] : PartialAnalysis) {
-    AnalysisResult[Node] = { Analysis,
-                             MFI::applyTransferFunction(Node, Analysis) };
+  MFPResults<Label, LatticeElement> AnalysisResult;
+  AnalysisResult.reserve(Labels.size());
+  for (size_t Priority = 0; Priority < Labels.size(); ++Priority) {
+    LatticeElement &Analysis = PartialAnalysis[Priority];
+    Label Node = Labels[Priority];
+    AnalysisResult.push_back({ Node,
+                               { Analysis,
+                                 MFI::applyTransferFunction(Node,
+                                                            Analysis) } });
   }
+
   return AnalysisResult;
 }
 
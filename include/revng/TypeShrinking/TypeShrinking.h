@@ -28,6 +28,20 @@ public:
   void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
 };
 
+/// \brief Run TypeShrinking on all the functions of a module
+///
+/// The data-flow graph of each function is built once. Building it, running
+/// BitLiveness on it and choosing the instructions to shrink happen in
+/// parallel across functions (see -type-shrinking-jobs). The IR is then
+/// rewritten serially, function by function.
+class TypeShrinkingModulePass : public llvm::ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  TypeShrinkingModulePass() : ModulePass(ID) {}
+
+  bool runOnModule(llvm::Module &M) override;
+};
+
 void applyTypeShrinking(llvm::legacy::FunctionPassManager &PM);
 
 } // namespace TypeShrinking
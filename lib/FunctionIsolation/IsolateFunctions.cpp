@@ -23,6 +23,7 @@
 #include "revng/Support/Debug.h"
 #include "revng/Support/FunctionTags.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/Support/Instrumentation.h"
 
 using namespace llvm;
 
@@ -954,6 +955,8 @@ void IFI::run() {
 }
 
 bool IF::runOnModule(Module &TheModule) {
+  PhaseTimer Timer("isolate");
+
   // Retrieve analyses
   auto &GCBI = getAnalysis<GeneratedCodeBasicInfoWrapperPass>().getGCBI();
   const auto &ModelWrapper = getAnalysis<LoadModelWrapperPass>().get();
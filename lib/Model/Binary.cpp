@@ -5,6 +5,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/Support/DOTGraphTraits.h"
 #include "llvm/Support/GraphWriter.h"
@@ -12,9 +14,22 @@
 
 #include "revng/ADT/GenericGraph.h"
 #include "revng/Model/Binary.h"
+#include "revng/Support/Parallel.h"
 
 using namespace llvm;
 
+static Logger<> ModelVerifyLog("model-verify");
+
+/// Minimum number of functions to verify or serialize in a single shard
+static constexpr size_t MinFunctionsPerShard = 64;
+
+/// \return the number of shards to employ to process \p Functions functions
+static size_t shardsFor(size_t Functions) {
+  size_t Result = std::min<size_t>(threadsCount(),
+                                   Functions / MinFunctionsPerShard);
+  return std::max<size_t>(Result, 1);
+}
+
 namespace model {
 
 struct FunctionCFGNodeData {
@@ -70,9 +85,8 @@ public:
   }
 };
 
-bool Binary::verify() const {
-  for (const Function &F : Functions) {
-
+std::vector<Binary::VerificationFailure> Binary::verificationFailures() const {
+  auto VerifyFunction = [this](const Function &F) {
     // Verify individual functions
     if (not F.verify())
       return false;
@@ -86,9 +100,131 @@ bool Binary::verify() const {
         }
       }
     }
+
+    return true;
+  };
+
+  std::vector<const Function *> AllFunctions;
+  AllFunctions.reserve(Functions.size());
+  for (const Function &F : Functions)
+    AllFunctions.push_back(&F);
+
+  // Verify each shard of functions independently, collecting the failures
+  size_t MaxShards = shardsFor(AllFunctions.size());
+  std::vector<std::vector<MetaAddress>> Failures(MaxShards);
+  auto VerifyShard = [&](size_t Shard, size_t Begin, size_t End) {
+    for (size_t I = Begin; I < End; ++I)
+      if (not VerifyFunction(*AllFunctions[I]))
+        Failures[Shard].push_back(AllFunctions[I]->Entry);
+  };
+  size_t Shards = forEachShard(AllFunctions.size(), MaxShards, VerifyShard);
+
+  // Merge the failures, in order
+  std::vector<VerificationFailure> Result;
+  for (size_t Shard = 0; Shard < Shards; ++Shard)
+    for (const MetaAddress &Entry : Failures[Shard])
+      Result.push_back({ Shard, Entry });
+
+  return Result;
+}
+
+bool Binary::verify() const {
+  std::vector<VerificationFailure> Failures = verificationFailures();
+
+  for (const VerificationFailure &Failure : Failures) {
+    revng_log(ModelVerifyLog,
+              "Function " << Failure.Entry.toString() << " (shard "
+                          << Failure.Shard << ") failed verification");
   }
 
-  return true;
+  return Failures.empty();
+}
+
+} // namespace model
+
+namespace {
+
+/// A subset of the functions of a model::Binary
+struct FunctionsShard {
+  llvm::ArrayRef<model::Function *> Functions;
+};
+
+/// A model::Binary containing only a subset of its functions
+struct BinaryShard {
+  FunctionsShard Functions;
+};
+
+} // namespace
+
+template<>
+struct llvm::yaml::SequenceTraits<FunctionsShard> {
+  static size_t size(IO &, FunctionsShard &Shard) {
+    return Shard.Functions.size();
+  }
+
+  static model::Function &element(IO &, FunctionsShard &Shard, size_t I) {
+    return *Shard.Functions[I];
+  }
+};
+
+template<>
+struct llvm::yaml::MappingTraits<BinaryShard> {
+  static void mapping(IO &TheIO, BinaryShard &Shard) {
+    const char *Name = TupleLikeTraits<model::Binary>::fieldName<0>();
+    TheIO.mapRequired(Name, Shard.Functions);
+  }
+};
+
+namespace model {
+
+void Binary::serialize(llvm::raw_ostream &Stream) const {
+  static_assert(std::tuple_size_v<Binary> == 1,
+                "Binary::serialize only handles the Functions field");
+
+  // YAML output requires non-const references, but it does not alter the
+  // serialized object
+  auto &This = const_cast<Binary &>(*this);
+
+  size_t MaxShards = shardsFor(Functions.size());
+  if (MaxShards == 1) {
+    ::serialize(Stream, This);
+    return;
+  }
+
+  std::vector<Function *> AllFunctions;
+  AllFunctions.reserve(Functions.size());
+  for (Function &F : This.Functions)
+    AllFunctions.push_back(&F);
+
+  // Serialize each shard in its own buffer
+  std::vector<std::string> Buffers(MaxShards);
+  auto SerializeShard = [&](size_t Shard, size_t Begin, size_t End) {
+    llvm::raw_string_ostream ShardStream(Buffers[Shard]);
+    auto Slice = makeArrayRef(AllFunctions).slice(Begin, End - Begin);
+    BinaryShard ToSerialize{ { Slice } };
+    ::serialize(ShardStream, ToSerialize);
+  };
+  size_t Shards = forEachShard(AllFunctions.size(), MaxShards, SerializeShard);
+
+  // Each buffer is a document with a single key, mapped to a block sequence
+  // of functions. Check this is the case, so that a change in the emitter
+  // cannot go unnoticed, and concatenate the elements of all the shards.
+  const char *Name = TupleLikeTraits<Binary>::fieldName<0>();
+  const std::string Header = std::string("---\n") + Name + ":\n";
+  const llvm::StringRef Footer = "...\n";
+  const llvm::StringRef ElementPrefix = "  - ";
+  Stream << Header;
+  for (size_t Shard = 0; Shard < Shards; ++Shard) {
+    llvm::StringRef Elements = Buffers[Shard];
+
+    bool HasHeader = Elements.consume_front(Header);
+    bool HasFooter = Elements.consume_back(Footer);
+    revng_assert(HasHeader and HasFooter
+                 and Elements.startswith(ElementPrefix));
+
+    Stream << Elements;
+  }
+  Stream << Footer;
 }
 
 static FunctionCFG getGraph(const Function &F) {
@@ -0,0 +1,143 @@
+/// \file BinaryIndexes.cpp
+/// \brief Reverse indexes over the model
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "revng/Model/BinaryIndexes.h"
+
+namespace model {
+
+static const BinaryIndexes::CallSitesSet EmptyCallSites;
+static const BinaryIndexes::FunctionsSet EmptyFunctions;
+
+const BinaryIndexes::CallSitesSet &
+BinaryIndexes::callSites(const MetaAddress &Callee) {
+  ensureUpToDate();
+
+  auto It = CallSites.find(Callee);
+  if (It == CallSites.end())
+    return EmptyCallSites;
+
+  return It->second;
+}
+
+const BinaryIndexes::FunctionsSet &
+BinaryIndexes::functionsAt(const MetaAddress &Address) {
+  ensureUpToDate();
+
+  auto It = Ranges.find(Address);
+  if (It == Ranges.end())
+    return EmptyFunctions;
+
+  return It->second;
+}
+
+void BinaryIndexes::update(const TupleTreeDiff<Binary> &Diff) {
+  // If the indexes have never been built or the model has been changed behind
+  // our back, we can't proceed incrementally
+  if (Generation == 0 or Generation != Model.previousGeneration()) {
+    invalidate();
+    return;
+  }
+
+  // Collect the functions affected by the diff
+  std::set<MetaAddress> Dirty;
+  bool HasRemovedFunctions = false;
+  for (const auto &C : Diff.Changes) {
+    revng_assert(C.Path.size() > 0);
+
+    if (C.Path.size() > 1) {
+      // Something changed within a function
+      Dirty.insert(C.Path[1].get<MetaAddress>());
+    } else if (C.New != nullptr) {
+      // A function has been added
+      Dirty.insert(reinterpret_cast<const Function *>(C.New)->Entry);
+    } else {
+      // A function has been removed. Note that C.Old might point to the
+      // function that has just been erased, so we cannot inspect it.
+      HasRemovedFunctions = true;
+    }
+  }
+
+  if (HasRemovedFunctions)
+    for (const auto &[Entry, _] : Contributions)
+      if (Model->Functions.count(Entry) == 0)
+        Dirty.insert(Entry);
+
+  // Re-index the affected functions
+  for (const MetaAddress &Entry : Dirty) {
+    unindexFunction(Entry);
+
+    auto It = Model->Functions.find(Entry);
+    if (It != Model->Functions.end())
+      indexFunction(*It);
+  }
+
+  Generation = Model.generation();
+}
+
+void BinaryIndexes::ensureUpToDate() {
+  if (Generation != Model.generation())
+    rebuild();
+}
+
+void BinaryIndexes::rebuild() {
+  CallSites.clear();
+  Ranges.clear();
+  Contributions.clear();
+
+  for (const Function &F : Model->Functions)
+    indexFunction(F);
+
+  Generation = Model.generation();
+}
+
+void BinaryIndexes::indexFunction(const Function &F) {
+  Contribution &Record = Contributions[F.Entry];
+  revng_assert(Record.CallSites.empty() and Record.Ranges.empty());
+
+  for (const BasicBlock &Block : F.CFG) {
+    // Register the address range of the block
+    if (Block.End.isValid() and Block.Start.addressLowerThan(Block.End)) {
+      auto Range = interval::right_open(Block.Start, Block.End);
+      Ranges += std::make_pair(Range, FunctionsSet{ F.Entry });
+      Record.Ranges.push_back(Range);
+    }
+
+    // Register call sites
+    for (const auto &Edge : Block.Successors) {
+      if (not llvm::isa<CallEdge>(Edge.get()) or not Edge->Destination.isValid())
+        continue;
+
+      CallSite Site{ F.Entry, Block.Start };
+      CallSites[Edge->Destination].insert(Site);
+      Record.CallSites.emplace_back(Edge->Destination, Site);
+    }
+  }
+}
+
+void BinaryIndexes::unindexFunction(const MetaAddress &Entry) {
+  auto It = Contributions.find(Entry);
+  if (It == Contributions.end())
+    return;
+
+  for (const interval_type &Range : It->second.Ranges)
+    Ranges -= std::make_pair(Range, FunctionsSet{ Entry });
+
+  for (const auto &[Callee, Site] : It->second.CallSites) {
+    // The same call site might have been recorded more than once
+    auto CalleeIt = CallSites.find(Callee);
+    if (CalleeIt == CallSites.end())
+      continue;
+
+    CalleeIt->second.erase(Site);
+    if (CalleeIt->second.empty())
+      CallSites.erase(CalleeIt);
+  }
+
+  Contributions.erase(It);
+}
+
+} // namespace model
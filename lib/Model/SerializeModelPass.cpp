@@ -31,7 +31,7 @@ void writeModel(model::Binary &Model, llvm::Module &M) {
   std::string Buffer;
   {
     llvm::raw_string_ostream Stream(Buffer);
-    serialize(Stream, Model);
+    Model.serialize(Stream);
   }
 
   LLVMContext &Context = M.getContext();
@@ -12,7 +12,8 @@
 #include "revng/Support/Debug.h"
 #include "revng/Support/IRHelpers.h"
 
-extern Logger<> SaDiffLog;
+// Always available: assertLowerThanOrEqual enables it in release builds too
+extern Logger<true> SaDiffLog;
 
 // #define EXPENSIVE_ASSERTIONS
 
@@ -11,7 +11,7 @@
 
 using llvm::Module;
 
-Logger<> SaDiffLog("sa-diff");
+Logger<true> SaDiffLog("sa-diff");
 
 RunningStatistics AddressSpaceSizeStats("AddressSpaceSizeStats");
 
@@ -35,7 +35,7 @@ template<bool Diff, bool EarlyExit>
 unsigned ASSlot::cmp(const ASSlot &Other, const Module *M) const {
   revng_assert(!this->isInvalid() and !Other.isInvalid());
 
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   bool Result = not(AS.lowerThanOrEqual(Other.AS) && Offset == Other.Offset);
 
   if (SaDiffLog.isEnabled() && Result && Diff) {
@@ -60,7 +60,7 @@ bool Value::lowerThanOrEqual(const Value &Other) const {
 
 template<bool Diff, bool EarlyExit>
 unsigned Value::cmp(const Value &Other, const Module *M) const {
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   unsigned Result = 0;
 
   if (hasDirectContent() && Other.hasDirectContent()) {
@@ -111,7 +111,7 @@ bool AddressSpace::lowerThanOrEqual(const AddressSpace &Other) const {
 
 template<bool Diff, bool EarlyExit>
 unsigned AddressSpace::cmp(const AddressSpace &Other, const Module *M) const {
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   unsigned Result = 0;
 
   for (auto &P : ASOContent) {
@@ -172,7 +172,7 @@ bool Element::lowerThanOrEqual(const Element &Other) const {
 
 template<bool Diff, bool EarlyExit>
 unsigned Element::cmp(const Element &Other, const Module *M) const {
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   unsigned Result = 0;
 
   if (Other.State.size() == 0)
@@ -59,7 +59,7 @@ static inline Comparison compare(T A, T B) {
 template<typename K, typename V, bool Diff, bool EarlyExit, size_t N>
 unsigned
 cmp(const DefaultMap<K, V, N> &This, const DefaultMap<K, V, N> &Other) {
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   unsigned Result = 0;
 
   This.sort();
@@ -101,7 +101,7 @@ unsigned cmpWithModule(const DefaultMap<K, V, N> &This,
                        const DefaultMap<K, V, N> &Other,
                        ASID ID,
                        const Module *M) {
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   unsigned Result = 0;
 
   This.sort();
@@ -161,7 +161,7 @@ unsigned nestedCmpWithModule(const MapOfMaps<FunctionCall, N1, K, V, N2> &This,
                              const MapOfMaps<FunctionCall, N1, K, V, N2> &Other,
                              ASID ID,
                              const Module *M) {
-  LoggerIndent<> Y(SaDiffLog);
+  LoggerIndent<true> Y(SaDiffLog);
   unsigned Result = 0;
 
   This.sort();
@@ -641,7 +641,7 @@ public:
   template<bool Diff, bool EarlyExit>
   unsigned cmp(const AnalysesWrapper &Other) const {
     using H = AnalysesWrapperHelpers<Tuple, int, Diff, EarlyExit>;
-    LoggerIndent<> Y(SaDiffLog);
+    LoggerIndent<true> Y(SaDiffLog);
     return H::cmp(this->Analyses, Other.Analyses);
   }
 
@@ -731,7 +731,7 @@ public:
   template<bool Diff, bool EarlyExit>
   unsigned cmp(const Element &Other, const Module *M = nullptr) const {
     using namespace MapHelpers;
-    LoggerIndent<> Y(SaDiffLog);
+    LoggerIndent<true> Y(SaDiffLog);
     unsigned Result = 0;
 
     auto registerCmp = cmpWithModule<int32_t, AWF, Diff, EarlyExit, 20>;
@@ -22,6 +22,7 @@
 #include "revng/StackAnalysis/StackAnalysis.h"
 #include "revng/Support/CommandLine.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/Support/Instrumentation.h"
 
 #include "Cache.h"
 #include "InterproceduralAnalysis.h"
@@ -33,7 +34,8 @@ using llvm::Module;
 using llvm::RegisterPass;
 
 static Logger<> ClobberedLog("clobbered");
-static Logger<> StackAnalysisLog("stackanalysis");
+// Always available: it also produces the output of -abi-analysis-output
+static Logger<true> StackAnalysisLog("stackanalysis");
 static Logger<> CFEPLog("cfep");
 
 using namespace llvm::cl;
@@ -165,12 +167,11 @@ void commitToModel(GeneratedCodeBasicInfo &GCBI,
     }
 
     auto MakeEdge = [](MetaAddress Destination, FunctionEdgeType::Values Type) {
-      FunctionEdge *Result = nullptr;
+      using ResultType = UpcastablePointer<FunctionEdge>;
       if (FunctionEdgeType::isCall(Type))
-        Result = new CallEdge(Destination, Type);
+        return ResultType::make<CallEdge>(Destination, Type);
       else
-        Result = new FunctionEdge(Destination, Type);
-      return UpcastablePointer<FunctionEdge>(Result);
+        return ResultType::make<FunctionEdge>(Destination, Type);
     };
 
     // Handle the situation in which we found no basic blocks at all
@@ -325,6 +326,7 @@ void commitToModel(GeneratedCodeBasicInfo &GCBI,
 }
 
 bool StackAnalysis::runOnModule(Module &M) {
+  PhaseTimer Timer("stack-analysis");
   Function &F = *M.getFunction("root");
 
   revng_log(PassesLog, "Starting StackAnalysis");
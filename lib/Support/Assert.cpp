@@ -12,6 +12,7 @@
 #include "llvm/Support/raw_os_ostream.h"
 
 #include "revng/Support/Assert.h"
+#include "revng/Support/Debug.h"
 
 static void print_stack_trace() {
   llvm::raw_os_ostream Output(std::cerr);
@@ -26,6 +27,9 @@ static void print_stack_trace() {
 
 static void
 report(const char *Type, const char *File, unsigned Line, const char *What) {
+  // Make sure the debug output preceding the failure is not lost
+  flushLogs();
+
   fprintf(stderr, "%s at %s:%d", Type, File, Line);
   if (What != nullptr)
     fprintf(stderr, ":\n\n%s", What);
@@ -6,12 +6,27 @@
 //
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <unistd.h>
+
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/IR/Value.h"
+#include "llvm/Support/ErrorHandling.h"
 
 #include "revng/Support/Debug.h"
 #include "revng/Support/revng.h"
@@ -27,14 +42,350 @@ static cl::opt<unsigned> MaxLocationLength("debug-location-max-length",
                                            cl::cat(MainCategory),
                                            cl::init(0));
 
+static cl::opt<bool> SynchronousLogs("debug-log-sync",
+                                     cl::desc("write debug output "
+                                              "synchronously, e.g., to "
+                                              "retain it in case of a crash"),
+                                     cl::cat(MainCategory),
+                                     cl::init(false));
+
 size_t MaxLoggerNameLength = 0;
 llvm::ManagedStatic<LoggersRegistry> Loggers;
 
-std::ostream &dbg(std::cerr);
+namespace {
+
+/// \brief Single producer, single consumer ring buffer of characters
+class LogRing {
+public:
+  static constexpr size_t Capacity = 1 << 18;
+
+private:
+  std::unique_ptr<char[]> Data = std::make_unique<char[]>(Capacity);
+  /// Total number of characters ever written, only the producer changes it
+  std::atomic<size_t> Head = 0;
+  /// Total number of characters ever read, only the consumer changes it
+  std::atomic<size_t> Tail = 0;
+
+public:
+  /// Set by the producer when it terminates
+  std::atomic<bool> Retired = false;
+
+public:
+  /// \brief Append \p Size characters, if there's room for them
+  ///
+  /// \return the number of characters that have been appended
+  size_t tryPush(const char *Source, size_t Size) {
+    size_t H = Head.load(std::memory_order_relaxed);
+    size_t Free = Capacity - (H - Tail.load(std::memory_order_acquire));
+    Size = std::min(Size, Free);
+
+    size_t Start = H % Capacity;
+    size_t First = std::min(Size, Capacity - Start);
+    std::memcpy(Data.get() + Start, Source, First);
+    std::memcpy(Data.get(), Source + First, Size - First);
+
+    Head.store(H + Size, std::memory_order_release);
+    return Size;
+  }
+
+  size_t used() const {
+    return Head.load(std::memory_order_acquire)
+           - Tail.load(std::memory_order_acquire);
+  }
+
+  /// \brief Hand everything has been pushed so far to \p Write
+  ///
+  /// \p Write is called with a pointer and a size, at most twice.
+  template<typename WriterT>
+  void drain(WriterT &&Write) {
+    size_t H = Head.load(std::memory_order_acquire);
+    size_t T = Tail.load(std::memory_order_relaxed);
+    if (H == T)
+      return;
+
+    size_t Start = T % Capacity;
+    size_t First = std::min(H - T, Capacity - Start);
+    Write(Data.get() + Start, First);
+    if (H - T != First)
+      Write(Data.get(), H - T - First);
+
+    Tail.store(H, std::memory_order_release);
+  }
+};
+
+/// \brief Collects the rings of all the threads and drains them to stderr
+///
+/// Each thread pushes complete lines in its own ring, without locking. A
+/// background thread, started upon the first line, periodically drains all the
+/// rings. Lines of a thread are kept in order, lines of different threads are
+/// not. Draining takes DrainLock, so there's a single consumer.
+///
+/// Upon exit, the rings are drained, the sink becomes synchronous and the
+/// background thread terminates.
+class LogSink {
+private:
+  std::mutex RingsLock;
+  std::vector<std::shared_ptr<LogRing>> Rings;
+  std::mutex DrainLock;
+  std::mutex WakeLock;
+  std::condition_variable Wake;
+  std::once_flag Started;
+  std::atomic<bool> Synchronous = false;
+
+public:
+  std::shared_ptr<LogRing> createRing() {
+    auto Result = std::make_shared<LogRing>();
+    std::lock_guard<std::mutex> Guard(RingsLock);
+    Rings.push_back(Result);
+    return Result;
+  }
+
+  void commit(LogRing &Ring, llvm::StringRef Text) {
+    if (not Synchronous and not SynchronousLogs) {
+      std::call_once(Started, [this]() { start(); });
+      pushAll(Ring, Text);
+    } else {
+      write(Text);
+    }
+  }
+
+  /// \brief Write \p Text right away, after what's already been queued
+  void write(llvm::StringRef Text) {
+    std::lock_guard<std::mutex> Guard(DrainLock);
+    drainAll();
+    std::fwrite(Text.data(), 1, Text.size(), stderr);
+  }
+
+  void flush() {
+    std::lock_guard<std::mutex> Guard(DrainLock);
+    drainAll();
+    std::fflush(stderr);
+  }
+
+  /// \brief Drain the rings without ever blocking, using only write(2)
+  ///
+  /// If another thread holds the locks, possibly the one that has been
+  /// interrupted, nothing is written. Retired rings are left in place.
+  void flushFromSignalHandler() {
+    std::unique_lock<std::mutex> Drain(DrainLock, std::try_to_lock);
+    if (not Drain.owns_lock())
+      return;
+
+    std::unique_lock<std::mutex> Guard(RingsLock, std::try_to_lock);
+    if (not Guard.owns_lock())
+      return;
+
+    for (const std::shared_ptr<LogRing> &Ring : Rings)
+      Ring->drain(writeToStderr);
+  }
+
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> Guard(WakeLock);
+      Synchronous = true;
+    }
+    Wake.notify_one();
+    flush();
+  }
+
+private:
+  void start();
+
+  void pushAll(LogRing &Ring, llvm::StringRef Text) {
+    while (not Text.empty()) {
+      Text = Text.drop_front(Ring.tryPush(Text.data(), Text.size()));
+
+      // Wake up the consumer if the ring is filling up, and wait for it if
+      // it's full
+      if (Ring.used() > LogRing::Capacity / 2)
+        Wake.notify_one();
+      if (not Text.empty())
+        std::this_thread::yield();
+    }
+  }
+
+  /// \note DrainLock must be held
+  void drainAll() {
+    std::vector<std::shared_ptr<LogRing>> Snapshot;
+    {
+      std::lock_guard<std::mutex> Guard(RingsLock);
+      Snapshot = Rings;
+    }
+
+    auto Write = [](const char *Data, size_t Size) {
+      std::fwrite(Data, 1, Size, stderr);
+    };
+
+    for (const std::shared_ptr<LogRing> &Ring : Snapshot) {
+      // Check before draining: a ring is retired after its last push
+      bool Retired = Ring->Retired;
+      Ring->drain(Write);
+      if (Retired) {
+        std::lock_guard<std::mutex> Guard(RingsLock);
+        llvm::erase_value(Rings, Ring);
+      }
+    }
+  }
+
+  static void writeToStderr(const char *Data, size_t Size) {
+    while (Size != 0) {
+      ssize_t Written = ::write(STDERR_FILENO, Data, Size);
+      if (Written < 0 and errno == EINTR)
+        continue;
+      if (Written <= 0)
+        return;
+      Data += Written;
+      Size -= Written;
+    }
+  }
+};
+
+} // namespace
+
+static LogSink &logSink() {
+  // Never destroyed, threads might outlive static destructors
+  static LogSink *Result = new LogSink;
+  return *Result;
+}
+
+void LogSink::start() {
+  std::thread Consumer([this]() {
+    using namespace std::chrono_literals;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> Lock(WakeLock);
+        // Upon shutdown the sink becomes synchronous, we're no longer needed
+        if (Synchronous)
+          return;
+        Wake.wait_for(Lock, 20ms);
+      }
+
+      std::lock_guard<std::mutex> Guard(DrainLock);
+      drainAll();
+    }
+  });
+  Consumer.detach();
+}
+
+// Registered early, so that it runs after the exit handlers registered later
+// on, which might still log
+static int ShutdownRegistration = std::atexit([]() { logSink().shutdown(); });
+
+static void
+onFatalError(void *, const char *Reason, bool GenerateCrashDiagnostics) {
+  // Mimic LLVM's default handler, after writing out the pending debug output
+  flushLogs();
+  std::fprintf(stderr, "LLVM ERROR: %s\n", Reason);
+  if (GenerateCrashDiagnostics)
+    std::abort();
+}
+
+static int FatalErrorHandlerRegistration = []() {
+  llvm::install_fatal_error_handler(onFatalError);
+  return 0;
+}();
+
+/// Set when the ThreadLog of this thread has been destroyed: exit handlers and
+/// static destructors run after the destruction of the thread locals
+static thread_local bool ThreadLogDestroyed = false;
+
+namespace {
+
+/// \brief The current line of a thread and its ring
+class ThreadLog {
+private:
+  std::string Pending;
+  std::shared_ptr<LogRing> Ring;
+
+public:
+  ThreadLog() : Ring(logSink().createRing()) {}
+
+  ~ThreadLog() {
+    commitAll();
+    Ring->Retired = true;
+    ThreadLogDestroyed = true;
+  }
+
+public:
+  void write(const char *Data, size_t Size) {
+    Pending.append(Data, Size);
+
+    // Commit only complete lines
+    if (std::memchr(Data, '\n', Size) == nullptr)
+      return;
+
+    size_t End = Pending.rfind('\n') + 1;
+    logSink().commit(*Ring, llvm::StringRef(Pending.data(), End));
+    Pending.erase(0, End);
+  }
+
+  void commitAll() {
+    if (Pending.empty())
+      return;
+
+    logSink().commit(*Ring, Pending);
+    Pending.clear();
+  }
+};
+
+/// \brief The stream buffer of dbg, it forwards everything to ThreadLog
+class ThreadLogBuffer : public std::streambuf {
+protected:
+  int overflow(int C) override {
+    if (C != traits_type::eof()) {
+      char Character = C;
+      xsputn(&Character, 1);
+    }
+    return C;
+  }
+
+  std::streamsize xsputn(const char *Data, std::streamsize Size) override {
+    if (ThreadLog *Log = threadLog())
+      Log->write(Data, Size);
+    else
+      logSink().write(llvm::StringRef(Data, Size));
+    return Size;
+  }
+
+  int sync() override {
+    if (ThreadLog *Log = threadLog())
+      Log->commitAll();
+    return 0;
+  }
+
+private:
+  static ThreadLog *threadLog() {
+    if (ThreadLogDestroyed)
+      return nullptr;
+
+    static thread_local ThreadLog Result;
+    return &Result;
+  }
+};
+
+} // namespace
+
+static ThreadLogBuffer DbgBuffer;
+static std::ostream DbgStream(&DbgBuffer);
+std::ostream &dbg(DbgStream);
+
+void flushLogs() {
+  dbg.flush();
+  logSink().flush();
+}
+
+void flushLogsFromSignalHandler() {
+  logSink().flushFromSignalHandler();
+}
 
 Logger<> PassesLog("passes");
-Logger<> ReleaseLog("release");
-Logger<> VerifyLog("verify");
+Logger<true> ReleaseLog("release");
+Logger<true> VerifyLog("verify");
+
+void LoggersRegistry::warnCompiledOut(llvm::StringRef Name) const {
+  dbg << "Warning: the " << Name.data() << " logger has been compiled out, "
+      << "rebuild with -DREVNG_LOGGERS_IN_RELEASE=ON to use it\n";
+}
 
 template<bool X>
 void Logger<X>::flush(const LogTerminator &LineInfo) {
@@ -0,0 +1,288 @@
+/// \file Instrumentation.cpp
+/// \brief Phase timers and counters, exported as JSON or as a Chrome trace
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/Assert.h"
+#include "revng/Support/CommandLine.h"
+#include "revng/Support/Instrumentation.h"
+
+#include <sys/resource.h>
+
+namespace cl = llvm::cl;
+
+std::atomic<bool> detail::InstrumentationEnabled = false;
+
+static auto EnableIfNotEmpty = [](const std::string &Path) {
+  if (not Path.empty())
+    enableInstrumentation();
+};
+
+static cl::opt<std::string> OutputPath("instrumentation-output",
+                                       cl::desc("upon exit, write the time "
+                                                "spent in each phase and the "
+                                                "instrumentation counters to "
+                                                "this file"),
+                                       cl::value_desc("path"),
+                                       cl::callback(EnableIfNotEmpty),
+                                       cl::cat(MainCategory));
+
+using IF = InstrumentationFormat::Values;
+static cl::opt<IF> Format("instrumentation-format",
+                          cl::desc("format of -instrumentation-output"),
+                          cl::values(clEnumValN(IF::JSON, "json", "JSON"),
+                                     clEnumValN(IF::ChromeTrace,
+                                                "chrome-trace",
+                                                "Chrome trace event format")),
+                          cl::init(IF::JSON),
+                          cl::cat(MainCategory));
+
+namespace {
+
+struct PhaseRecord {
+  std::string Name;
+  unsigned Thread;
+  unsigned Depth;
+  uint64_t StartMicroseconds;
+  uint64_t WallMicroseconds;
+  uint64_t CPUMicroseconds;
+  uint64_t PeakRSSKiB;
+};
+
+using CounterSlots = std::array<std::atomic<uint64_t>,
+                                InstrumentationCounter::MaxCounters>;
+
+/// \brief The counters of a thread, folded in the registry upon thread exit
+class ThreadCounters {
+public:
+  CounterSlots Slots = {};
+
+public:
+  ThreadCounters();
+  ~ThreadCounters();
+};
+
+/// \brief Global state: completed phases, counter names and live threads
+class Registry {
+public:
+  std::mutex Lock;
+  bool ExitHandlerInstalled = false;
+  std::vector<PhaseRecord> Phases;
+  std::vector<std::string> CounterNames;
+  std::vector<ThreadCounters *> LiveThreads;
+  /// Values of the counters of the threads that already terminated
+  std::array<uint64_t, InstrumentationCounter::MaxCounters> Retired = {};
+
+public:
+  uint64_t total(unsigned Index) {
+    uint64_t Result = Retired[Index];
+    for (ThreadCounters *Thread : LiveThreads)
+      Result += Thread->Slots[Index].load(std::memory_order_relaxed);
+    return Result;
+  }
+};
+
+} // namespace
+
+static Registry &registry() {
+  // Never destroyed, threads might outlive static destructors
+  static Registry *Result = new Registry;
+  return *Result;
+}
+
+static const auto ProcessStart = std::chrono::steady_clock::now();
+static std::atomic<unsigned> NextThreadIndex = 0;
+static thread_local unsigned CurrentDepth = 0;
+
+static unsigned threadIndex() {
+  static thread_local unsigned Index = NextThreadIndex++;
+  return Index;
+}
+
+static uint64_t microsecondsSinceStart() {
+  using namespace std::chrono;
+  auto Elapsed = steady_clock::now() - ProcessStart;
+  return duration_cast<microseconds>(Elapsed).count();
+}
+
+static uint64_t threadCPUMicroseconds() {
+  struct timespec Time;
+  int Result = clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time);
+  revng_assert(Result == 0);
+  return Time.tv_sec * 1000000 + Time.tv_nsec / 1000;
+}
+
+static uint64_t peakRSSKiB() {
+  struct rusage Usage;
+  int Result = getrusage(RUSAGE_SELF, &Usage);
+  revng_assert(Result == 0);
+  return Usage.ru_maxrss;
+}
+
+static void writeOnExit() {
+  std::error_code EC;
+  llvm::raw_fd_ostream Output(OutputPath, EC, llvm::sys::fs::OF_Text);
+  if (EC) {
+    llvm::errs() << "Couldn't open " << OutputPath << ": " << EC.message()
+                 << "\n";
+    return;
+  }
+
+  writeInstrumentation(Output, Format);
+}
+
+ThreadCounters::ThreadCounters() {
+  Registry &R = registry();
+  std::lock_guard<std::mutex> Guard(R.Lock);
+  R.LiveThreads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+  Registry &R = registry();
+  std::lock_guard<std::mutex> Guard(R.Lock);
+  for (unsigned I = 0; I < InstrumentationCounter::MaxCounters; ++I)
+    R.Retired[I] += Slots[I].load(std::memory_order_relaxed);
+  llvm::erase_value(R.LiveThreads, this);
+}
+
+void enableInstrumentation() {
+  detail::InstrumentationEnabled.store(true, std::memory_order_relaxed);
+}
+
+void writeInstrumentation(llvm::raw_ostream &Output,
+                          InstrumentationFormat::Values Format) {
+  Registry &R = registry();
+  std::lock_guard<std::mutex> Guard(R.Lock);
+  llvm::json::OStream JSON(Output, 2);
+
+  // Phases are recorded as they complete, sort them by start time, outer
+  // phases first
+  auto Phases = R.Phases;
+  auto Compare = [](const PhaseRecord &A, const PhaseRecord &B) {
+    return std::tie(A.StartMicroseconds, A.Depth)
+           < std::tie(B.StartMicroseconds, B.Depth);
+  };
+  std::stable_sort(Phases.begin(), Phases.end(), Compare);
+
+  auto WriteCounters = [&R, &JSON]() {
+    for (unsigned I = 0; I < R.CounterNames.size(); ++I)
+      JSON.attribute(R.CounterNames[I], R.total(I));
+  };
+
+  JSON.object([&]() {
+    switch (Format) {
+    case InstrumentationFormat::JSON:
+      JSON.attributeArray("phases", [&]() {
+        for (const PhaseRecord &Phase : Phases) {
+          JSON.object([&]() {
+            JSON.attribute("name", Phase.Name);
+            JSON.attribute("thread", Phase.Thread);
+            JSON.attribute("depth", Phase.Depth);
+            JSON.attribute("start-us", Phase.StartMicroseconds);
+            JSON.attribute("wall-us", Phase.WallMicroseconds);
+            JSON.attribute("cpu-us", Phase.CPUMicroseconds);
+            JSON.attribute("peak-rss-kib", Phase.PeakRSSKiB);
+          });
+        }
+      });
+      JSON.attributeObject("counters", WriteCounters);
+      break;
+
+    case InstrumentationFormat::ChromeTrace:
+      JSON.attributeArray("traceEvents", [&]() {
+        // Phases are complete events
+        for (const PhaseRecord &Phase : Phases) {
+          JSON.object([&]() {
+            JSON.attribute("name", Phase.Name);
+            JSON.attribute("cat", "phase");
+            JSON.attribute("ph", "X");
+            JSON.attribute("ts", Phase.StartMicroseconds);
+            JSON.attribute("dur", Phase.WallMicroseconds);
+            JSON.attribute("pid", llvm::sys::Process::getProcessId());
+            JSON.attribute("tid", Phase.Thread);
+            JSON.attributeObject("args", [&]() {
+              JSON.attribute("cpu-us", Phase.CPUMicroseconds);
+              JSON.attribute("peak-rss-kib", Phase.PeakRSSKiB);
+            });
+          });
+        }
+
+        // Counters are a single counter event at the end of the trace
+        JSON.object([&]() {
+          JSON.attribute("name", "counters");
+          JSON.attribute("ph", "C");
+          JSON.attribute("ts", microsecondsSinceStart());
+          JSON.attribute("pid", llvm::sys::Process::getProcessId());
+          JSON.attributeObject("args", WriteCounters);
+        });
+      });
+      JSON.attribute("displayTimeUnit", "ms");
+      break;
+    }
+  });
+
+  Output << "\n";
+}
+
+void PhaseTimer::start() {
+  Depth = CurrentDepth++;
+  StartMicroseconds = microsecondsSinceStart();
+  StartCPUMicroseconds = threadCPUMicroseconds();
+}
+
+void PhaseTimer::stop() {
+  --CurrentDepth;
+  PhaseRecord Record{ Name,
+                      threadIndex(),
+                      Depth,
+                      StartMicroseconds,
+                      microsecondsSinceStart() - StartMicroseconds,
+                      threadCPUMicroseconds() - StartCPUMicroseconds,
+                      peakRSSKiB() };
+
+  Registry &R = registry();
+  std::lock_guard<std::mutex> Guard(R.Lock);
+  R.Phases.push_back(std::move(Record));
+
+  if (not R.ExitHandlerInstalled and not OutputPath.empty()) {
+    std::atexit(writeOnExit);
+    R.ExitHandlerInstalled = true;
+  }
+}
+
+InstrumentationCounter::InstrumentationCounter(llvm::StringRef Name) {
+  Registry &R = registry();
+  std::lock_guard<std::mutex> Guard(R.Lock);
+  Index = R.CounterNames.size();
+  revng_assert(Index < MaxCounters, "Too many instrumentation counters");
+  R.CounterNames.push_back(Name.str());
+}
+
+uint64_t InstrumentationCounter::total() const {
+  Registry &R = registry();
+  std::lock_guard<std::mutex> Guard(R.Lock);
+  return R.total(Index);
+}
+
+std::atomic<uint64_t> &InstrumentationCounter::threadSlot() const {
+  static thread_local ThreadCounters Counters;
+  return Counters.Slots[Index];
+}
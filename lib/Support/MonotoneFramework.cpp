@@ -0,0 +1,66 @@
+/// \file MonotoneFramework.cpp
+/// \brief Statistics about the convergence of monotone frameworks
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "revng/Support/MonotoneFramework.h"
+
+MonotoneFrameworkStatistics::MonotoneFrameworkStatistics(llvm::StringRef Name) :
+  Name(Name.str()) {
+  OnQuitStatistics->add(this);
+}
+
+using Telemetry = MonotoneFrameworkTelemetry;
+
+void MonotoneFrameworkStatistics::record(
+  const Telemetry &T,
+  const std::vector<uint64_t> &VisitsPerLabel) {
+  std::lock_guard<std::mutex> Guard(Lock);
+
+  ++Runs;
+  Widenings += T.Widenings;
+  if (T.BudgetExhausted)
+    ++ExhaustedBudgets;
+
+  if (T.Visits > Worst.Visits)
+    Worst = T;
+
+  Visits.push(T.Visits);
+  Growths.push(T.Growths);
+  Microseconds.push(T.Microseconds);
+  for (uint64_t Count : VisitsPerLabel)
+    LabelVisits.push(Count);
+}
+
+void MonotoneFrameworkStatistics::onQuit() {
+  std::lock_guard<std::mutex> Guard(Lock);
+
+  if (Runs == 0)
+    return;
+
+  dbg << Name << ":\n";
+  dbg << "  Runs: " << Runs << "\n";
+  dbg << "  Exhausted budgets: " << ExhaustedBudgets << "\n";
+  dbg << "  Widenings: " << Widenings << "\n";
+
+  dbg << "  Visits per run: ";
+  Visits.dump(dbg);
+  dbg << "\n";
+
+  dbg << "  Visits per label: ";
+  LabelVisits.dump(dbg);
+  dbg << "\n";
+
+  dbg << "  State growths per run: ";
+  Growths.dump(dbg);
+  dbg << "\n";
+
+  dbg << "  Time to fixed point (us): ";
+  Microseconds.dump(dbg);
+  dbg << "\n";
+
+  dbg << "  Worst run: " << Worst.Visits << " visits, " << Worst.MaxLabelVisits
+      << " visits of a single label, " << Worst.Microseconds << " us\n";
+}
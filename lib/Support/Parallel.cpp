@@ -0,0 +1,38 @@
+/// \file Parallel.cpp
+/// \brief Helpers to run independent tasks in parallel
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <memory>
+
+#include "revng/Support/CommandLine.h"
+#include "revng/Support/Parallel.h"
+
+namespace cl = llvm::cl;
+
+cl::opt<unsigned> ParallelJobs("parallel-jobs",
+                               cl::desc("number of threads to use for "
+                                        "parallel tasks, 0 to use all the "
+                                        "available hardware threads"),
+                               cl::init(0),
+                               cl::cat(MainCategory));
+
+unsigned threadsCount() {
+  if (ParallelJobs != 0)
+    return ParallelJobs;
+
+  return std::max(1U, llvm::hardware_concurrency().compute_thread_count());
+}
+
+llvm::ThreadPool &threadPool(unsigned MinThreads) {
+  // Threads are spawned lazily, so a large pool costs nothing until used
+  thread_local std::unique_ptr<llvm::ThreadPool> Pool;
+  if (not Pool or Pool->getThreadCount() < MinThreads) {
+    auto Strategy = llvm::hardware_concurrency(MinThreads);
+    Pool = std::make_unique<llvm::ThreadPool>(Strategy);
+  }
+
+  return *Pool;
+}
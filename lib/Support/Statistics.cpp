@@ -5,6 +5,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cerrno>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
 #include "revng/Support/CommandLine.h"
 #include "revng/Support/Statistics.h"
 
@@ -42,11 +49,103 @@ void installStatistics() {
     OnQuitStatistics->install();
 }
 
-static void onQuit() {
+bool areStatisticsEnabled() {
+  return Statistics;
+}
+
+static void dumpStatistics() {
   dbg << "\n";
   OnQuitStatistics->dump();
 }
 
+static void onQuit() {
+  dumpStatistics();
+  flushLogs();
+}
+
+namespace {
+
+/// \brief Dumps the statistics on behalf of the signal handlers
+///
+/// Dumping the statistics allocates memory and takes the locks of the debug
+/// output, which is not safe in a signal handler: the interrupted thread might
+/// be in malloc or holding those locks. The signal handlers therefore only ask
+/// a dedicated thread to dump the statistics, through a pipe, and wait for it
+/// for a limited amount of time.
+class SignalDumper {
+private:
+  /// How long a signal handler waits for the statistics to be dumped
+  static constexpr int TimeoutMilliseconds = 1000;
+
+private:
+  int RequestPipe[2] = { -1, -1 };
+  int DonePipe[2] = { -1, -1 };
+
+public:
+  void start() {
+    int Result = pipe2(RequestPipe, O_CLOEXEC);
+    revng_assert(Result == 0);
+    Result = pipe2(DonePipe, O_CLOEXEC | O_NONBLOCK);
+    revng_assert(Result == 0);
+
+    // Start the thread with all the signals blocked, so that the handlers
+    // never run on it
+    sigset_t All, Old;
+    sigfillset(&All);
+    Result = pthread_sigmask(SIG_SETMASK, &All, &Old);
+    revng_assert(Result == 0);
+    std::thread([this]() { serve(); }).detach();
+    Result = pthread_sigmask(SIG_SETMASK, &Old, nullptr);
+    revng_assert(Result == 0);
+  }
+
+  /// \brief Dump the statistics and wait for it to be done
+  ///
+  /// \note Only async-signal-safe functions are used here
+  ///
+  /// \return true if the statistics have been dumped in time
+  bool dump() {
+    // Discard the notifications of dumps we gave up on
+    char Byte = 0;
+    while (read(DonePipe[0], &Byte, 1) == 1)
+      ;
+
+    if (write(RequestPipe[1], &Byte, 1) != 1)
+      return false;
+
+    struct pollfd Done = { DonePipe[0], POLLIN, 0 };
+    int Result = 0;
+    do {
+      Result = poll(&Done, 1, TimeoutMilliseconds);
+    } while (Result < 0 and errno == EINTR);
+
+    return Result == 1 and read(DonePipe[0], &Byte, 1) == 1;
+  }
+
+private:
+  void serve() {
+    while (true) {
+      char Byte = 0;
+      ssize_t Result = read(RequestPipe[0], &Byte, 1);
+      if (Result < 0 and errno == EINTR)
+        continue;
+      if (Result != 1)
+        return;
+
+      dumpStatistics();
+      flushLogs();
+
+      // If the pipe is full, the handler has given up on many dumps already
+      // and it will discard these notifications anyway
+      Result = write(DonePipe[1], &Byte, 1);
+    }
+  }
+};
+
+} // namespace
+
+static SignalDumper Dumper;
+
 static void onQuitSignalHandler(int Signal) {
   Handler *SignalHandler = nullptr;
   for (Handler &H : Handlers)
@@ -56,7 +155,10 @@ static void onQuitSignalHandler(int Signal) {
   // Assert we were notified of the signal we expected
   revng_assert(SignalHandler != nullptr);
 
-  onQuit();
+  // If the dump didn't complete in time, the interrupted thread is likely
+  // holding the locks of the debug output: write out what we can
+  if (not Dumper.dump())
+    flushLogsFromSignalHandler();
 
   if (not SignalHandler->Restore)
     return;
@@ -70,6 +172,8 @@ void OnQuitRegistry::install() {
   // Dump on normal exit
   std::atexit(onQuit);
 
+  Dumper.start();
+
   // Register signal handlers
   for (Handler &H : Handlers) {
     H.NewHandler.sa_handler = &onQuitSignalHandler;
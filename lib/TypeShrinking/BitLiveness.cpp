@@ -253,9 +253,8 @@ BitLivenessAnalysis::applyTransferFunction(DataFlowNode *L, const uint32_t E) {
   }
 }
 
-BitLivenessPass::Result
-BitLivenessPass::run(llvm::Function &F, llvm::FunctionAnalysisManager &) {
-  GenericGraph<DataFlowNode> DataFlowGraph = buildDataFlowGraph(F);
+BitLivenessAnalysisResults
+computeBitLiveness(GenericGraph<DataFlowNode> &DataFlowGraph) {
   std::vector<DataFlowNode *> ExtremalLabels;
   for (DataFlowNode *Node : DataFlowGraph.nodes()) {
     if (isDataFlowSink(Node->Instruction)) {
@@ -267,13 +266,19 @@ BitLivenessPass::run(llvm::Function &F, llvm::FunctionAnalysisManager &) {
                                                               0,
                                                               Top,
                                                               ExtremalLabels);
-  BitLivenessPass::Result Result;
+  BitLivenessAnalysisResults Result;
   for (auto &[Label, MFPResult] : MFPResults)
     Result[Label->Instruction] = MFPResult.OutValue;
 
   return Result;
 }
 
+BitLivenessPass::Result
+BitLivenessPass::run(llvm::Function &F, llvm::FunctionAnalysisManager &) {
+  GenericGraph<DataFlowNode> DataFlowGraph = buildDataFlowGraph(F);
+  return computeBitLiveness(DataFlowGraph);
+}
+
 bool BitLivenessWrapperPass::runOnFunction(llvm::Function &F) {
   llvm::FunctionAnalysisManager FAM;
   Result = BitLivenessPass().run(F, FAM);
@@ -22,6 +22,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 
+#include "revng/Support/Parallel.h"
 #include "revng/TypeShrinking/BitLiveness.h"
 #include "revng/TypeShrinking/DataFlowGraph.h"
 #include "revng/TypeShrinking/MFP.h"
@@ -38,12 +39,30 @@ static cl::opt<uint32_t> MinimumWidth("min-width",
                                       cl::value_desc("min-width"),
                                       cl::cat(MainCategory));
 
+static cl::opt<unsigned> TypeShrinkingJobs("type-shrinking-jobs",
+                                           cl::init(0),
+                                           cl::desc("number of functions to "
+                                                    "analyze in parallel in "
+                                                    "type-shrinking-module, 0 "
+                                                    "to follow "
+                                                    "-parallel-jobs"),
+                                           cl::value_desc("jobs"),
+                                           cl::cat(MainCategory));
+
 char TypeShrinking::TypeShrinkingWrapperPass::ID = 0;
+char TypeShrinking::TypeShrinkingModulePass::ID = 0;
 
 using Register = RegisterPass<TypeShrinking::TypeShrinkingWrapperPass>;
 static Register
   X("type-shrinking", "Run the type shrinking analysis", true, true);
 
+using RegisterModule = RegisterPass<TypeShrinking::TypeShrinkingModulePass>;
+static RegisterModule Y("type-shrinking-module",
+                        "Run the type shrinking analysis on all the functions, "
+                        "analyzing them in parallel",
+                        false,
+                        false);
+
 namespace TypeShrinking {
 
 void TypeShrinkingWrapperPass::getAnalysisUsage(AnalysisUsage &AU) const {
@@ -65,70 +84,86 @@ static bool isAddLike(const Instruction *Ins) {
   return false;
 }
 
-static bool
-runTypeShrinking(Function &F, const BitLivenessAnalysisResults &FixedPoints) {
-  bool HasChanges = false;
+/// The instructions to shrink and the width to shrink them to
+using ShrinkingPlan = std::vector<std::pair<Instruction *, uint32_t>>;
+
+/// Choose the instructions to shrink, without changing the IR
+static ShrinkingPlan
+planTypeShrinking(const BitLivenessAnalysisResults &FixedPoints) {
+  ShrinkingPlan Result;
 
   const std::array<uint32_t, 4> Ranks = { 8, 16, 32, 64 };
-  for (auto &[Ins, Result] : FixedPoints) {
+  for (auto &[Ins, AliveBits] : FixedPoints) {
     // Find the closest rank that contains all the alive bits.
     // If there is a known rank and this is an instruction that behaves like add
     // (the least significant bits of the result depend only on the least
     // significant bits of the operands) we can down cast the operands and then
     // upcast the result
-    if (Result >= MinimumWidth.getValue() && isAddLike(Ins)) {
-      auto ClosestRank = std::lower_bound(Ranks.begin(), Ranks.end(), Result);
+    if (AliveBits >= MinimumWidth.getValue() && isAddLike(Ins)) {
+      auto ClosestRank = std::lower_bound(Ranks.begin(),
+                                          Ranks.end(),
+                                          AliveBits);
       if (ClosestRank != Ranks.end()
           && Ins->getType()->getScalarSizeInBits() > *ClosestRank) {
-        auto Rank = *ClosestRank;
-        HasChanges = true;
-        llvm::Value *NewIns = nullptr;
-
-        llvm::IRBuilder<> BuilderPre(Ins);
-        llvm::IRBuilder<> BuilderPost(Ins->getNextNode());
-
-        using CastOps = llvm::Instruction::CastOps;
-        auto *Lhs = BuilderPre.CreateCast(CastOps::Trunc,
-                                          Ins->getOperand(0),
-                                          BuilderPre.getIntNTy(Rank));
-        auto *Rhs = BuilderPre.CreateCast(CastOps::Trunc,
-                                          Ins->getOperand(1),
-                                          BuilderPre.getIntNTy(Rank));
-
-        NewIns = BuilderPost.CreateBinOp((Instruction::BinaryOps)
-                                           Ins->getOpcode(),
-                                         Lhs,
-                                         Rhs);
-
-        // Emit ZExts, as late as possible
-        SmallVector<std::pair<Use *, Value *>, 4> Replacements;
-        for (Use &TheUse : Ins->uses()) {
-          if (auto *U = cast<Instruction>(TheUse.getUser())) {
-            IRBuilder<> B(U);
-
-            // Fix insert point for PHIs
-            if (auto *Phi = dyn_cast<PHINode>(U)) {
-              auto *BB = Phi->getIncomingBlock(TheUse);
-              auto It = BB->getTerminator()->getIterator();
-              B.SetInsertPoint(BB, It);
-            }
-
-            auto *LateUpcast = B.CreateZExt(NewIns, Ins->getType());
-            Replacements.emplace_back(&TheUse, LateUpcast);
-          }
-        }
+        Result.emplace_back(Ins, *ClosestRank);
+      }
+    }
+  }
 
-        // Apply replacements
-        for (auto &[Use, I] : Replacements)
-          Use->set(I);
+  return Result;
+}
+
+static bool shrinkInstructions(const ShrinkingPlan &Plan) {
+  for (auto &[Ins, Rank] : Plan) {
+    llvm::Value *NewIns = nullptr;
+
+    llvm::IRBuilder<> BuilderPre(Ins);
+    llvm::IRBuilder<> BuilderPost(Ins->getNextNode());
+
+    using CastOps = llvm::Instruction::CastOps;
+    auto *Lhs = BuilderPre.CreateCast(CastOps::Trunc,
+                                      Ins->getOperand(0),
+                                      BuilderPre.getIntNTy(Rank));
+    auto *Rhs = BuilderPre.CreateCast(CastOps::Trunc,
+                                      Ins->getOperand(1),
+                                      BuilderPre.getIntNTy(Rank));
+
+    NewIns = BuilderPost.CreateBinOp((Instruction::BinaryOps) Ins->getOpcode(),
+                                     Lhs,
+                                     Rhs);
+
+    // Emit ZExts, as late as possible
+    SmallVector<std::pair<Use *, Value *>, 4> Replacements;
+    for (Use &TheUse : Ins->uses()) {
+      if (auto *U = cast<Instruction>(TheUse.getUser())) {
+        IRBuilder<> B(U);
+
+        // Fix insert point for PHIs
+        if (auto *Phi = dyn_cast<PHINode>(U)) {
+          auto *BB = Phi->getIncomingBlock(TheUse);
+          auto It = BB->getTerminator()->getIterator();
+          B.SetInsertPoint(BB, It);
+        }
 
-        // Drop the original instruction
-        Ins->eraseFromParent();
+        auto *LateUpcast = B.CreateZExt(NewIns, Ins->getType());
+        Replacements.emplace_back(&TheUse, LateUpcast);
       }
     }
+
+    // Apply replacements
+    for (auto &[Use, I] : Replacements)
+      Use->set(I);
+
+    // Drop the original instruction
+    Ins->eraseFromParent();
   }
 
-  return HasChanges;
+  return not Plan.empty();
+}
+
+static bool
+runTypeShrinking(Function &F, const BitLivenessAnalysisResults &FixedPoints) {
+  return shrinkInstructions(planTypeShrinking(FixedPoints));
 }
 
 bool TypeShrinkingWrapperPass::runOnFunction(Function &F) {
@@ -137,6 +172,29 @@ bool TypeShrinkingWrapperPass::runOnFunction(Function &F) {
   return runTypeShrinking(F, FixedPoints);
 }
 
+bool TypeShrinkingModulePass::runOnModule(Module &M) {
+  std::vector<Function *> Functions;
+  for (Function &F : M)
+    if (not F.isDeclaration())
+      Functions.push_back(&F);
+
+  // Build the data-flow graph, run BitLiveness and pick the instructions to
+  // shrink in parallel: none of this changes the IR
+  auto Analyze = [](Function *F, std::monostate &) {
+    GenericGraph<DataFlowNode> DataFlowGraph = buildDataFlowGraph(*F);
+    return planTypeShrinking(computeBitLiveness(DataFlowGraph));
+  };
+  unsigned Jobs = TypeShrinkingJobs != 0 ? TypeShrinkingJobs : threadsCount();
+  std::vector<ShrinkingPlan> Plans = solveIndependent(Functions, Analyze, Jobs);
+
+  // Rewrite the IR serially
+  bool HasChanges = false;
+  for (const ShrinkingPlan &Plan : Plans)
+    HasChanges = shrinkInstructions(Plan) or HasChanges;
+
+  return HasChanges;
+}
+
 PreservedAnalyses
 TypeShrinkingPass::run(Function &F, FunctionAnalysisManager &FAM) {
   const auto &FixedPoints = FAM.getResult<BitLivenessPass>(F);
@@ -260,6 +260,35 @@ void unknownPC(PlainMetaAddress *PC) {
   abort();
 }
 
+// Dispatcher hits counting support, incremented by the translated code if it
+// has been lifted with -count-dispatcher-hits
+uint64_t dispatcher_hits = 0;
+static int dispatcher_hits_fd = -1;
+
+static void write_dispatcher_hits(void) {
+  if (dispatcher_hits_fd == -1)
+    return;
+
+  dprintf(dispatcher_hits_fd, "%" PRIu64 "\n", dispatcher_hits);
+  close(dispatcher_hits_fd);
+  dispatcher_hits_fd = -1;
+}
+
+void init_dispatcher_hits(void) {
+  // If REVNG_DISPATCHER_HITS_PATH contains a path, write the number of
+  // dispatcher hits there upon exit
+  char *hits_path = getenv("REVNG_DISPATCHER_HITS_PATH");
+  if (hits_path != NULL && strlen(hits_path) > 0) {
+    dispatcher_hits_fd = open(hits_path,
+                              O_WRONLY | O_CREAT | O_TRUNC,
+                              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    assert(dispatcher_hits_fd != -1);
+
+    int result = atexit(write_dispatcher_hits);
+    assert(result == 0);
+  }
+}
+
 #ifdef TRACE
 
 // Execution tracing support
@@ -330,6 +359,7 @@ void flush_trace_buffer_signal_handler(int signal) {
 // This function is called by the syscall helpers in case of exit/exit_group
 void on_exit_syscall(void) {
   flush_trace_buffer();
+  write_dispatcher_hits();
 }
 
 void newpc(uint64_t pc,
@@ -355,6 +385,7 @@ void init_tracing(void) {
 }
 
 void on_exit_syscall(void) {
+  write_dispatcher_hits();
 }
 
 void newpc(uint64_t pc,
@@ -412,6 +443,9 @@ int main(int argc, char *argv[]) {
   // Initialize the tracing system
   init_tracing();
 
+  // Initialize dispatcher hits counting
+  init_dispatcher_hits();
+
   // Allocate and initialize the stack
   void *stack = mmap((void *) NULL,
                      16 * 0x100000,
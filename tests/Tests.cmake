@@ -6,6 +6,7 @@ enable_testing()
 
 # Give control to the various subdirectories
 include(${CMAKE_SOURCE_DIR}/tests/unit/UnitTests.cmake)
+include(${CMAKE_SOURCE_DIR}/tests/benchmark/BenchmarkTests.cmake)
 include(${CMAKE_SOURCE_DIR}/tests/analysis/AnalysisTests.cmake)
 include(${CMAKE_SOURCE_DIR}/tests/runtime/RuntimeTests.cmake)
 
@@ -63,6 +63,13 @@ macro(artifact_handler CATEGORY INPUT_FILE CONFIGURATION OUTPUT TARGET_NAME)
 
     endforeach()
 
+    # Measure lifting and the analyses, and replay the analyses based on
+    # MonotoneFramework on the lifted module, see BenchmarkTests.cmake
+    add_lift_benchmark("${CATEGORY}-${TARGET_NAME}" "${INPUT_FILE}"
+      analysis ${CATEGORY} ${CONFIGURATION})
+    add_monotone_framework_benchmark("${CATEGORY}-${TARGET_NAME}" "${OUTPUT}"
+      analysis ${CATEGORY} ${CONFIGURATION})
+
   endif()
 endmacro()
 register_derived_artifact("compiled" "lifted" ".ll" "FILE")
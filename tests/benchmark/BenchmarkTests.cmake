@@ -0,0 +1,247 @@
+#
+# This file is distributed under the MIT License. See LICENSE.md for details.
+#
+
+# Lift-time benchmarks: each benchmark lifts a binary and runs the analyses on
+# it, recording time and peak memory of each step and of each phase in
+# ${BENCHMARK_RESULTS_DIR}.
+#
+# MonotoneFramework benchmarks: each benchmark replays the analyses based on
+# MonotoneFramework on a module lifted by the analysis tests, use `ctest -L
+# monotone-framework` to run only these.
+#
+# Runtime benchmarks: each benchmark translates a program, with and without
+# function isolation, and runs it, recording time, instructions retired and
+# dispatcher hits. As a reference, the program is also run natively and with
+# QEMU-user.
+#
+# Microbenchmarks: each benchmark times a data structure or an algorithm on
+# large inputs, recording the time of each step.
+#
+# Finally, benchmark-compare checks the results against a baseline. The
+# benchmarks are registered only if REVNG_ENABLE_BENCHMARKS is set, use `make
+# benchmark` (or `ctest -L benchmark`) to run them.
+#
+# Timings depend on the machine, so no baseline is shipped and
+# benchmark-compare fails until one is recorded: run the benchmarks on a
+# known-good revision, then `make benchmark-update-baseline`.
+
+option(REVNG_ENABLE_BENCHMARKS
+  "Register the benchmarks, run them with `make benchmark`" OFF)
+
+if(NOT REVNG_ENABLE_BENCHMARKS)
+  # AnalysisTests.cmake calls add_lift_benchmark and
+  # add_monotone_framework_benchmark on each of its inputs
+  macro(add_lift_benchmark NAME INPUT_FILE)
+  endmacro()
+  macro(add_monotone_framework_benchmark NAME LIFTED_FILE)
+  endmacro()
+  return()
+endif()
+
+set(REVNG_BENCHMARK_BASELINE "${CMAKE_SOURCE_DIR}/tests/benchmark/baseline.json"
+  CACHE FILEPATH "Results the benchmarks are compared against")
+set(REVNG_BENCHMARK_THRESHOLD "0.1"
+  CACHE STRING "Maximum relative increase of time or memory of a benchmark")
+
+set(BENCHMARK_RESULTS_DIR "${CMAKE_BINARY_DIR}/benchmark-results")
+
+# The analyses to run on the lifted module, in the OPT[:OUTPUT_OPT] form
+set(BENCHMARK_ANALYSES
+  "collect-cfg:collect-cfg-output"
+  "detect-abi:detect-function-boundaries-output"
+  "abi-analysis:abi-analysis-output")
+
+set(BENCHMARK_ANALYSES_ARGS "")
+foreach(ANALYSIS ${BENCHMARK_ANALYSES})
+  list(APPEND BENCHMARK_ANALYSES_ARGS --analysis "${ANALYSIS}")
+endforeach()
+
+# Remove the results of previous runs
+add_test(NAME benchmark-clean
+  COMMAND "${CMAKE_COMMAND}" -E remove_directory "${BENCHMARK_RESULTS_DIR}")
+set_tests_properties(benchmark-clean PROPERTIES
+  LABELS "benchmark"
+  FIXTURES_SETUP benchmark-clean)
+
+macro(add_lift_benchmark NAME INPUT_FILE)
+  set(BENCHMARK_TEST_NAME benchmark-lift-${NAME})
+  add_test(NAME ${BENCHMARK_TEST_NAME}
+    COMMAND "./bin/revng-benchmark" run
+      --revng "./bin/revng"
+      --name "${NAME}"
+      --output-dir "${BENCHMARK_RESULTS_DIR}"
+      ${BENCHMARK_ANALYSES_ARGS}
+      "${INPUT_FILE}")
+  set_tests_properties(${BENCHMARK_TEST_NAME} PROPERTIES
+    LABELS "benchmark;lift;${ARGN}"
+    RUN_SERIAL TRUE
+    FIXTURES_REQUIRED benchmark-clean
+    FIXTURES_SETUP benchmark-results)
+endmacro()
+
+macro(add_monotone_framework_benchmark NAME LIFTED_FILE)
+  set(BENCHMARK_TEST_NAME benchmark-lifted-${NAME}-monotone-framework)
+  add_test(NAME ${BENCHMARK_TEST_NAME}
+    COMMAND sh -c "./bin/revng opt --abi-analysis ${LIFTED_FILE} -o /dev/null")
+  set_tests_properties(${BENCHMARK_TEST_NAME} PROPERTIES
+    LABELS "benchmark;monotone-framework;${ARGN}"
+    RUN_SERIAL TRUE)
+endmacro()
+
+#
+# Microbenchmarks, in tests/benchmark/micro
+#
+macro(add_micro_benchmark NAME SOURCE)
+  set(BENCHMARK_TARGET benchmark-micro-${NAME})
+  revng_add_private_executable(${BENCHMARK_TARGET}
+    "${CMAKE_SOURCE_DIR}/tests/benchmark/micro/${SOURCE}")
+  target_include_directories(${BENCHMARK_TARGET}
+    PRIVATE "${CMAKE_SOURCE_DIR}")
+  target_link_libraries(${BENCHMARK_TARGET} ${ARGN} ${LLVM_LIBRARIES})
+  add_test(NAME ${BENCHMARK_TARGET}
+    COMMAND "./bin/${BENCHMARK_TARGET}" "${BENCHMARK_RESULTS_DIR}")
+  set_tests_properties(${BENCHMARK_TARGET} PROPERTIES
+    LABELS "benchmark;micro"
+    RUN_SERIAL TRUE
+    FIXTURES_REQUIRED benchmark-clean
+    FIXTURES_SETUP benchmark-results)
+endmacro()
+
+add_micro_benchmark(frozen-graph FrozenGraph.cpp revngSupport)
+add_micro_benchmark(generic-graph GenericGraph.cpp revngSupport)
+add_micro_benchmark(graph-algorithms GraphAlgorithms.cpp revngSupport)
+add_micro_benchmark(lazy-small-bit-vector LazySmallBitVector.cpp revngSupport)
+add_micro_benchmark(mfp MFP.cpp revngSupport)
+add_micro_benchmark(model Model.cpp revngModel revngSupport)
+add_micro_benchmark(parallel-fixed-point ParallelFixedPoint.cpp revngSupport)
+add_micro_benchmark(queue Queue.cpp revngSupport)
+add_micro_benchmark(recursive-coroutine RecursiveCoroutine.cpp revngSupport)
+add_micro_benchmark(recursive-coroutine-fallback
+  RecursiveCoroutine.cpp
+  revngSupport)
+target_compile_definitions(benchmark-micro-recursive-coroutine-fallback
+  PRIVATE DISABLE_RECURSIVE_COROUTINES)
+add_micro_benchmark(sorted-vector SortedVector.cpp revngSupport)
+
+set(BENCHMARK_BINARIES "")
+file(MAKE_DIRECTORY "${CMAKE_BINARY_DIR}/tests/benchmark")
+
+#
+# Synthetic programs, compiled for the host
+#
+set(SYNTHETIC_BENCHMARK_SIZES 1000 5000)
+foreach(SIZE ${SYNTHETIC_BENCHMARK_SIZES})
+  set(SOURCE "${CMAKE_BINARY_DIR}/tests/benchmark/synthetic-${SIZE}.c")
+  set(BINARY "${CMAKE_BINARY_DIR}/tests/benchmark/synthetic-${SIZE}")
+  add_custom_command(OUTPUT "${SOURCE}"
+    COMMAND "${CMAKE_BINARY_DIR}/bin/revng-benchmark" generate
+      --functions ${SIZE}
+      -o "${SOURCE}"
+    DEPENDS "${CMAKE_BINARY_DIR}/bin/revng-benchmark")
+  add_custom_command(OUTPUT "${BINARY}"
+    COMMAND "${CMAKE_C_COMPILER}" -O2 ${NO_PIE} "${SOURCE}" -o "${BINARY}"
+    DEPENDS "${SOURCE}")
+  list(APPEND BENCHMARK_BINARIES "${BINARY}")
+
+  add_lift_benchmark(synthetic-${SIZE} "${BINARY}" synthetic)
+  set_property(TEST benchmark-lift-synthetic-${SIZE}
+    APPEND PROPERTY FIXTURES_REQUIRED benchmark-binaries)
+endforeach()
+
+#
+# Runtime benchmarks: CPU-bound programs, compiled for each architecture with a
+# configured compiler, run translated, natively (if the host can) and with
+# QEMU-user (if available)
+#
+set(RUNTIME_BENCHMARK_PROGRAMS hash sort interpreter switch)
+set(RUNTIME_BENCHMARK_ARGUMENTS_hash 3000)
+set(RUNTIME_BENCHMARK_ARGUMENTS_sort 200)
+set(RUNTIME_BENCHMARK_ARGUMENTS_interpreter 100000)
+set(RUNTIME_BENCHMARK_ARGUMENTS_switch 1000)
+
+foreach(ARCH aarch64 arm mips mipsel x86_64 i386 s390x)
+  # By default, only the host architecture is enabled
+  if("${ARCH}" STREQUAL "${CMAKE_SYSTEM_PROCESSOR}")
+    set(DEFAULT_COMPILER "${CMAKE_C_COMPILER}")
+  else()
+    set(DEFAULT_COMPILER "")
+  endif()
+  set(REVNG_BENCHMARK_CC_${ARCH} "${DEFAULT_COMPILER}"
+    CACHE STRING "C compiler for the ${ARCH} runtime benchmarks, empty to disable them")
+  set(REVNG_BENCHMARK_CFLAGS_${ARCH} ""
+    CACHE STRING "Additional C flags for the ${ARCH} runtime benchmarks")
+  find_program(QEMU_USER_${ARCH} qemu-${ARCH})
+
+  if(NOT "${REVNG_BENCHMARK_CC_${ARCH}}" STREQUAL "")
+    set(RUNTIME_BENCHMARK_OPTIONS "")
+    if("${ARCH}" STREQUAL "${CMAKE_SYSTEM_PROCESSOR}")
+      list(APPEND RUNTIME_BENCHMARK_OPTIONS --native)
+    endif()
+    if(QEMU_USER_${ARCH})
+      list(APPEND RUNTIME_BENCHMARK_OPTIONS --qemu "${QEMU_USER_${ARCH}}")
+    endif()
+    separate_arguments(RUNTIME_BENCHMARK_CFLAGS UNIX_COMMAND
+      "${REVNG_BENCHMARK_CFLAGS_${ARCH}}")
+
+    foreach(PROGRAM ${RUNTIME_BENCHMARK_PROGRAMS})
+      set(NAME runtime-${ARCH}-${PROGRAM})
+      set(SOURCE "${CMAKE_SOURCE_DIR}/tests/benchmark/runtime/${PROGRAM}.c")
+      set(BINARY "${CMAKE_BINARY_DIR}/tests/benchmark/${NAME}")
+      add_custom_command(OUTPUT "${BINARY}"
+        COMMAND "${REVNG_BENCHMARK_CC_${ARCH}}"
+          -O2 -static ${RUNTIME_BENCHMARK_CFLAGS} "${SOURCE}" -o "${BINARY}"
+        DEPENDS "${SOURCE}")
+      list(APPEND BENCHMARK_BINARIES "${BINARY}")
+
+      add_test(NAME benchmark-${NAME}
+        COMMAND "./bin/revng-benchmark" runtime
+          --revng "./bin/revng"
+          --name "${NAME}"
+          --output-dir "${BENCHMARK_RESULTS_DIR}"
+          ${RUNTIME_BENCHMARK_OPTIONS}
+          "${BINARY}"
+          ${RUNTIME_BENCHMARK_ARGUMENTS_${PROGRAM}})
+      set_tests_properties(benchmark-${NAME} PROPERTIES
+        LABELS "benchmark;runtime;${ARCH}"
+        RUN_SERIAL TRUE
+        FIXTURES_REQUIRED "benchmark-clean;benchmark-binaries"
+        FIXTURES_SETUP benchmark-results)
+    endforeach()
+  endif()
+endforeach()
+
+# Build the benchmark programs on demand, they are not part of `all`
+add_custom_target(benchmark-binaries DEPENDS ${BENCHMARK_BINARIES})
+add_test(NAME benchmark-build-binaries
+  COMMAND "${CMAKE_COMMAND}"
+    --build "${CMAKE_BINARY_DIR}"
+    --target benchmark-binaries)
+set_tests_properties(benchmark-build-binaries PROPERTIES
+  LABELS "benchmark"
+  FIXTURES_SETUP benchmark-binaries)
+
+#
+# Comparison against the baseline
+#
+add_test(NAME benchmark-compare
+  COMMAND "./bin/revng-benchmark" compare
+    --baseline "${REVNG_BENCHMARK_BASELINE}"
+    --threshold "${REVNG_BENCHMARK_THRESHOLD}"
+    "${BENCHMARK_RESULTS_DIR}")
+set_tests_properties(benchmark-compare PROPERTIES
+  LABELS "benchmark"
+  FIXTURES_REQUIRED benchmark-results)
+
+add_custom_target(benchmark
+  COMMAND "${CMAKE_CTEST_COMMAND}" -L benchmark --output-on-failure
+  WORKING_DIRECTORY "${CMAKE_BINARY_DIR}"
+  USES_TERMINAL)
+
+add_custom_target(benchmark-update-baseline
+  COMMAND "./bin/revng-benchmark" compare
+    --baseline "${REVNG_BENCHMARK_BASELINE}"
+    --update-baseline
+    "${BENCHMARK_RESULTS_DIR}"
+  WORKING_DIRECTORY "${CMAKE_BINARY_DIR}"
+  USES_TERMINAL)
@@ -0,0 +1,106 @@
+/// \file FrozenGraph.cpp
+/// \brief Visits of a large GenericGraph and of its frozen copy
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SCCIterator.h"
+
+#include "revng/ADT/FilteredGraphTraits.h"
+#include "revng/ADT/FrozenGraph.h"
+#include "revng/ADT/GenericGraph.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+
+using namespace llvm;
+
+struct TestNodeData {
+  TestNodeData(unsigned Rank) : Rank(Rank) {}
+  unsigned Rank;
+};
+
+struct TestEdgeLabel {
+  unsigned Weight;
+};
+
+using TestNode = BidirectionalNode<TestNodeData, TestEdgeLabel>;
+using TestGraph = GenericGraph<TestNode>;
+using FrozenTestGraph = FrozenGraph<TestNode *>;
+using FrozenTestNode = FrozenTestGraph::Node;
+
+static bool isHeavy(Edge<TestNode, TestEdgeLabel> &Edge) {
+  return Edge.Weight > 5;
+}
+
+template<typename T>
+static size_t countSCCs(T Entry) {
+  size_t Result = 0;
+  for (auto &SCC : make_range(scc_begin(Entry), scc_end(Entry)))
+    Result += SCC.size() > 1;
+  return Result;
+}
+
+template<typename GT, typename NodeRef>
+static size_t countReachable(NodeRef Entry) {
+  using DFIterator = df_iterator<NodeRef,
+                                 df_iterator_default_set<NodeRef>,
+                                 false,
+                                 GT>;
+  return std::distance(DFIterator::begin(Entry), DFIterator::end(Entry));
+}
+
+int main(int argc, char *argv[]) {
+  using HeavyEdges = EdgeFilteredGraph<TestNode *, isHeavy>;
+  using GT = GraphTraits<HeavyEdges>;
+  MicroBenchmark Benchmark("frozen-graph");
+
+  const unsigned Size = 200000;
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  TestGraph Graph;
+  std::vector<TestNode *> Nodes;
+  for (unsigned I = 0; I < Size; ++I)
+    Nodes.push_back(Graph.addNode(I));
+  Graph.setEntryNode(Nodes[0]);
+  for (unsigned I = 0; I < Size; ++I) {
+    if (I + 1 < Size)
+      Nodes[I]->addSuccessor(Nodes[I + 1], { Generator() % 10 });
+    Nodes[I]->addSuccessor(Nodes[Distribution(Generator)],
+                           { Generator() % 10 });
+  }
+  TestNode *Entry = Graph.getEntryNode();
+
+  size_t SCCs = 0;
+  size_t Reachable = 0;
+  Benchmark.measure("visit-original", [&]() {
+    SCCs = countSCCs(Entry);
+    Reachable = countReachable<GT>(Entry);
+  });
+
+  Benchmark.measure("freeze", [&]() {
+    auto Frozen = FrozenTestGraph::freeze(&Graph);
+    auto FrozenHeavy = FrozenTestGraph::freezeReachable<GT>(Entry);
+    revng_check(FrozenHeavy.size() == Reachable);
+  });
+
+  auto Frozen = FrozenTestGraph::freeze(&Graph);
+  auto FrozenHeavy = FrozenTestGraph::freezeReachable<GT>(Entry);
+
+  size_t FrozenSCCs = 0;
+  size_t FrozenReachable = 0;
+  Benchmark.measure("visit-frozen", [&]() {
+    using FrozenGT = GraphTraits<FrozenTestNode *>;
+    FrozenSCCs = countSCCs(Frozen.getEntryNode());
+    FrozenReachable = countReachable<FrozenGT>(FrozenHeavy.getEntryNode());
+  });
+
+  revng_check(SCCs == FrozenSCCs);
+  revng_check(Reachable == FrozenReachable);
+
+  return Benchmark.finish(argc, argv);
+}
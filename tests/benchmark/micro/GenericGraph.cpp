@@ -0,0 +1,72 @@
+/// \file GenericGraph.cpp
+/// \brief Building and visiting a large GenericGraph, with and without
+///        ChunkedNodes
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#include "revng/ADT/GenericGraph.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+
+struct BenchmarkNodeData {
+  BenchmarkNodeData(unsigned Rank) : Rank(Rank) {}
+  unsigned Rank;
+};
+
+using BenchmarkNode = ForwardNode<BenchmarkNodeData, Empty, false>;
+
+static constexpr unsigned Size = 1000000;
+
+template<typename GraphT>
+static void build(GraphT &Graph) {
+  using NodeT = typename GraphT::Node;
+  std::vector<NodeT *> Nodes;
+  Nodes.reserve(Size);
+  for (unsigned I = 0; I < Size; ++I)
+    Nodes.push_back(Graph.addNode(I));
+
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  for (unsigned I = 0; I < Size; ++I) {
+    if (I + 1 < Size)
+      Nodes[I]->addSuccessor(Nodes[I + 1]);
+    Nodes[I]->addSuccessor(Nodes[Distribution(Generator)]);
+  }
+  Graph.setEntryNode(Nodes[0]);
+}
+
+template<typename GraphT>
+static void measureAllocation(MicroBenchmark &Benchmark, llvm::StringRef Name) {
+  using NodeT = typename GraphT::Node;
+
+  // Build and destroy the graph
+  Benchmark.measure((Name + "-build").str(), []() {
+    GraphT Graph;
+    build(Graph);
+  });
+
+  GraphT Graph;
+  build(Graph);
+  unsigned Sum = 0;
+  Benchmark.measure((Name + "-visit").str(), [&Graph, &Sum]() {
+    for (NodeT *Node : Graph.nodes())
+      for (NodeT *Successor : Node->successors())
+        Sum += Successor->Rank;
+  });
+  revng_check(Sum != 0);
+}
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("generic-graph");
+
+  measureAllocation<GenericGraph<BenchmarkNode>>(Benchmark, "heap-nodes");
+  using Chunked = GenericGraph<BenchmarkNode, 16, true, ChunkedNodes<>>;
+  measureAllocation<Chunked>(Benchmark, "chunked-nodes");
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,91 @@
+/// \file GraphAlgorithms.cpp
+/// \brief nodesBetween and exitless_scc_range on a large CFG-like graph
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#include "revng/ADT/FrozenGraph.h"
+#include "revng/ADT/GenericGraph.h"
+#include "revng/Support/GraphAlgorithms.h"
+#include "revng/Support/ParallelGraphAlgorithms.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+
+struct TestNodeData {
+  TestNodeData(unsigned Index) : Index(Index) {}
+  unsigned Index;
+};
+
+using TestNode = BidirectionalNode<TestNodeData>;
+using TestGraph = GenericGraph<TestNode>;
+using FrozenTestGraph = FrozenGraph<TestNode *>;
+using FrozenTestNode = FrozenTestGraph::Node;
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("graph-algorithms");
+
+  // A chain with random forward and backward jumps and self loops
+  const unsigned Size = 500000;
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  TestGraph Graph;
+  std::vector<TestNode *> Nodes;
+  for (unsigned I = 0; I < Size; ++I)
+    Nodes.push_back(Graph.addNode(I));
+  Graph.setEntryNode(Nodes[0]);
+  for (unsigned I = 0; I < Size; ++I) {
+    switch (Generator() % 8) {
+    case 1:
+      Nodes[I]->addSuccessor(Nodes[I]);
+      break;
+    case 2:
+    case 3:
+      Nodes[I]->addSuccessor(Nodes[Distribution(Generator)]);
+      break;
+    }
+
+    if (I + 1 < Size)
+      Nodes[I]->addSuccessor(Nodes[I + 1]);
+  }
+
+  TestNode *Source = Nodes.front();
+  TestNode *Destination = Nodes.back();
+
+  size_t Selected = 0;
+  Benchmark.measure("nodes-between", [&]() {
+    Selected = nodesBetween(Source, Destination).size();
+  });
+
+  auto Frozen = FrozenTestGraph::freeze(&Graph);
+  FrozenTestNode *FrozenSource = Frozen.lookup(Source);
+  FrozenTestNode *FrozenDestination = Frozen.lookup(Destination);
+  size_t FrozenSelected = 0;
+  Benchmark.measure("nodes-between-frozen", [&]() {
+    FrozenSelected = nodesBetween(FrozenSource, FrozenDestination).size();
+  });
+  revng_check(Selected == FrozenSelected);
+
+  size_t ParallelSelected = 0;
+  Benchmark.measure("nodes-between-frozen-parallel", [&]() {
+    ParallelSelected = parallelNodesBetween(FrozenSource, FrozenDestination)
+                         .size();
+  });
+  revng_check(Selected == ParallelSelected);
+
+  size_t SCCs = 0;
+  Benchmark.measure("exitless-sccs", [&]() {
+    SCCs = exitless_scc_range(Source).size();
+  });
+
+  size_t FrozenSCCs = 0;
+  Benchmark.measure("exitless-sccs-frozen", [&]() {
+    FrozenSCCs = exitless_scc_range(Frozen.getEntryNode()).size();
+  });
+  revng_check(SCCs == FrozenSCCs);
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,75 @@
+/// \file LazySmallBitVector.cpp
+/// \brief Word operations of LazySmallBitVector on sparse, large bit vectors
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#include "revng/ADT/LazySmallBitVector.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("lazy-small-bit-vector");
+
+  // Sparse bit vectors with 64k bits
+  const unsigned Size = 1 << 16;
+  const unsigned Vectors = 64;
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  std::vector<LazySmallBitVector> BitVectors(Vectors);
+  for (LazySmallBitVector &BitVector : BitVectors) {
+    BitVector.set(Size - 1);
+    for (unsigned I = 0; I < 64; ++I)
+      BitVector.set(Distribution(Generator));
+  }
+
+  unsigned Total = 0;
+  Benchmark.measure("iterate", [&]() {
+    for (unsigned Round = 0; Round < 10; ++Round)
+      for (const LazySmallBitVector &BitVector : BitVectors)
+        for (unsigned Bit : BitVector)
+          Total += Bit & 1;
+  });
+
+  Benchmark.measure("count", [&]() {
+    for (unsigned Round = 0; Round < 100; ++Round)
+      for (const LazySmallBitVector &BitVector : BitVectors)
+        Total += BitVector.count();
+  });
+
+  // Join of all the bit vectors until nothing changes, as a monotone analysis
+  // would do
+  LazySmallBitVector Accumulator;
+  Benchmark.measure("or-and-compare", [&]() {
+    Accumulator = LazySmallBitVector();
+    bool Changed = true;
+    while (Changed) {
+      Changed = false;
+      for (const LazySmallBitVector &BitVector : BitVectors) {
+        LazySmallBitVector Old = Accumulator;
+        Accumulator |= BitVector;
+        Changed = Changed or Old != Accumulator;
+      }
+    }
+  });
+
+  LazySmallBitVector FusedAccumulator;
+  Benchmark.measure("or-in-place-changed", [&]() {
+    FusedAccumulator = LazySmallBitVector();
+    bool Changed = true;
+    while (Changed) {
+      Changed = false;
+      for (const LazySmallBitVector &BitVector : BitVectors)
+        Changed = FusedAccumulator.orInPlaceChanged(BitVector) or Changed;
+    }
+  });
+
+  revng_check(Accumulator == FusedAccumulator);
+  revng_check(Total != 0);
+
+  return Benchmark.finish(argc, argv);
+}
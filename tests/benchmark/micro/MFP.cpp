@@ -0,0 +1,40 @@
+/// \file MFP.cpp
+/// \brief TypeShrinking::getMaximalFixedPoint on a large graph
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#include "revng/TypeShrinking/MFP.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+#include "tests/unit/DistanceAnalysis.h"
+
+using namespace TypeShrinking;
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("mfp");
+
+  constexpr unsigned Size = 200000;
+  std::mt19937 Generator(42);
+  DistanceGraph Graph = createGraph(Generator, Size);
+  std::vector<DistanceNode *> ExtremalLabels;
+  for (DistanceNode *Node : Graph.nodes())
+    if (Node->Index % 1000 == 0)
+      ExtremalLabels.push_back(Node);
+
+  size_t Results = 0;
+  Benchmark.measure("distance", [&]() {
+    Results = getMaximalFixedPoint<DistanceAnalysis>(&Graph,
+                                                     0,
+                                                     1,
+                                                     ExtremalLabels)
+                .size();
+  });
+  revng_check(Results == Size);
+
+  return Benchmark.finish(argc, argv);
+}
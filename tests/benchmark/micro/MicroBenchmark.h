@@ -0,0 +1,113 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/Assert.h"
+
+/// \brief Time the steps of a microbenchmark and write them as a result of
+///        `revng-benchmark`
+///
+/// Each step is run a few times and its fastest run is recorded. The results
+/// are written to `RESULTS_DIR/micro-NAME.json`, where `revng-benchmark
+/// compare` checks them against the baseline along with the other benchmarks.
+class MicroBenchmark {
+private:
+  struct Step {
+    std::string Name;
+    uint64_t WallMicroseconds;
+    uint64_t CPUMicroseconds;
+  };
+
+private:
+  std::string Name;
+  std::vector<Step> Steps;
+
+public:
+  MicroBenchmark(llvm::StringRef Name) : Name(("micro-" + Name).str()) {}
+
+public:
+  /// \brief Run \p Body \p Repetitions times, record the fastest run
+  template<typename T>
+  void measure(llvm::StringRef StepName, T &&Body, unsigned Repetitions = 3) {
+    using namespace std::chrono;
+    Step Result{ StepName.str(),
+                 std::numeric_limits<uint64_t>::max(),
+                 std::numeric_limits<uint64_t>::max() };
+
+    for (unsigned I = 0; I < Repetitions; ++I) {
+      auto Start = steady_clock::now();
+      uint64_t StartCPU = processCPUMicroseconds();
+      Body();
+      uint64_t CPU = processCPUMicroseconds() - StartCPU;
+      auto Wall = duration_cast<microseconds>(steady_clock::now() - Start);
+      Result.WallMicroseconds = std::min<uint64_t>(Result.WallMicroseconds,
+                                                   Wall.count());
+      Result.CPUMicroseconds = std::min(Result.CPUMicroseconds, CPU);
+    }
+
+    llvm::errs() << Name << " " << Result.Name << ": "
+                 << Result.WallMicroseconds << " us\n";
+    Steps.push_back(std::move(Result));
+  }
+
+  /// \brief Write the results to the directory in argv[1], if any
+  ///
+  /// \return the exit code of the benchmark
+  int finish(int Argc, char *Argv[]) {
+    if (Argc < 2)
+      return 0;
+
+    llvm::SmallString<128> Path(Argv[1]);
+    llvm::sys::fs::create_directories(Path);
+    llvm::sys::path::append(Path, Name + ".json");
+
+    std::error_code EC;
+    llvm::raw_fd_ostream Output(Path, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      llvm::errs() << "Couldn't open " << Path << ": " << EC.message() << "\n";
+      return 1;
+    }
+
+    llvm::json::OStream JSON(Output, 2);
+    JSON.object([&]() {
+      JSON.attribute("name", Name);
+      JSON.attributeObject("steps", [&]() {
+        for (const Step &S : Steps) {
+          JSON.attributeObject(S.Name, [&]() {
+            JSON.attribute("wall-us", S.WallMicroseconds);
+            JSON.attribute("cpu-us", S.CPUMicroseconds);
+            JSON.attributeObject("phases", []() {});
+            JSON.attributeObject("counters", []() {});
+          });
+        }
+      });
+    });
+    Output << "\n";
+
+    return 0;
+  }
+
+private:
+  static uint64_t processCPUMicroseconds() {
+    struct timespec Time;
+    int Result = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &Time);
+    revng_assert(Result == 0);
+    return Time.tv_sec * 1000000 + Time.tv_nsec / 1000;
+  }
+};
@@ -0,0 +1,94 @@
+/// \file Model.cpp
+/// \brief The most common operations on a model with many CFG edges
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <string>
+
+#include "revng/Model/Binary.h"
+#include "revng/Model/TupleTreeDiff.h"
+#include "revng/Support/Parallel.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+
+using namespace model;
+
+int main(int argc, char *argv[]) {
+  using namespace model::FunctionEdgeType;
+  MicroBenchmark Benchmark("model");
+
+  constexpr uint64_t FunctionsCount = 200;
+  constexpr uint64_t BlocksPerFunction = 100;
+  constexpr uint64_t BlockSize = 0x10;
+  using EdgePointer = UpcastablePointer<FunctionEdge>;
+  auto ARM1000 = MetaAddress::fromString("0x1000:Code_arm");
+  auto ARM3000 = MetaAddress::fromString("0x3000:Code_arm");
+
+  TupleTree<Binary> Model;
+  Benchmark.measure("build", [&]() {
+    Model = TupleTree<Binary>();
+    for (uint64_t I = 0; I < FunctionsCount; ++I) {
+      auto Entry = ARM1000 + I * BlocksPerFunction * BlockSize;
+      Function &F = Model->Functions[Entry];
+      F.Type = FunctionType::Regular;
+      for (uint64_t J = 0; J < BlocksPerFunction; ++J) {
+        auto Start = Entry + J * BlockSize;
+        BasicBlock &Block = F.CFG[Start];
+        Block.End = Start + BlockSize;
+        auto Inserter = Block.Successors.batch_insert();
+        Inserter.insert(EdgePointer::make<FunctionEdge>(Block.End,
+                                                        DirectBranch));
+        Inserter.insert(EdgePointer::make<FunctionEdge>(Entry, DirectBranch));
+        Inserter.insert(EdgePointer::make<CallEdge>(ARM3000, FunctionCall));
+        Inserter.insert(EdgePointer::make<CallEdge>(MetaAddress::invalid(),
+                                                    IndirectCall));
+      }
+    }
+  });
+
+  size_t CallEdges = 0;
+  Benchmark.measure("lookup", [&]() {
+    CallEdges = 0;
+    for (const Function &F : Model->Functions) {
+      for (const BasicBlock &Block : F.CFG) {
+        auto It = Block.Successors.find({ ARM3000, FunctionCall });
+        if (It != Block.Successors.end() and llvm::isa<CallEdge>(It->get()))
+          ++CallEdges;
+      }
+    }
+  });
+  revng_check(CallEdges == FunctionsCount * BlocksPerFunction);
+
+  Binary Copy;
+  Benchmark.measure("copy", [&]() { Copy = *Model; });
+  Benchmark.measure("diff", [&]() { diff(*Model, Copy); });
+
+  std::string Buffer;
+  ParallelJobs = 1;
+  Benchmark.measure("serialize", [&]() {
+    Buffer.clear();
+    Model.serialize(Buffer);
+  });
+
+  ParallelJobs = 4;
+  std::string ShardedBuffer;
+  Benchmark.measure("serialize-4-shards", [&]() {
+    ShardedBuffer.clear();
+    Model.serialize(ShardedBuffer);
+  });
+  revng_check(ShardedBuffer == Buffer);
+
+  bool Verified = false;
+  Benchmark.measure("verify-4-shards", [&]() { Verified = Model->verify(); });
+  revng_check(not Verified);
+
+  TupleTree<Binary> Deserialized;
+  Benchmark.measure("deserialize", [&]() {
+    Deserialized = TupleTree<Binary>::deserialize(Buffer);
+  });
+  revng_check(Deserialized->Functions == Model->Functions);
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,38 @@
+/// \file ParallelFixedPoint.cpp
+/// \brief Scaling of solveIndependent with the number of threads
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "revng/Support/Parallel.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+#include "tests/unit/ReachingLabels.h"
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("parallel-fixed-point");
+
+  std::mt19937 Generator(42);
+  std::vector<Graph> Graphs;
+  for (int I = 0; I < 128; ++I)
+    Graphs.push_back(createGraph(Generator, 20 + (I * 37) % 100));
+
+  auto Serial = solveIndependent<Arena>(Graphs, solve, 1);
+
+  unsigned MaxThreads = std::max(4U, threadsCount());
+  for (unsigned Threads = 1; Threads <= MaxThreads; Threads *= 2) {
+    std::vector<std::vector<size_t>> Parallel;
+    Benchmark.measure(std::to_string(Threads) + "-threads", [&]() {
+      Parallel = solveIndependent<Arena>(Graphs, solve, Threads);
+    });
+    revng_check(Parallel == Serial);
+  }
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,88 @@
+/// \file Queue.cpp
+/// \brief Breadth first visits of a large graph, as the StackAnalysis does
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "revng/ADT/Queue.h"
+#include "revng/Support/MonotoneFramework.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+
+struct Node {
+  std::vector<Node *> Successors;
+  unsigned Distance = 0;
+};
+
+/// Breadth first work list using the set-backed queue, as a reference
+class SetBreadthFirstWorkList {
+private:
+  SetQueueImpl<Node *, false> Queue;
+
+public:
+  SetBreadthFirstWorkList(Node *) {}
+  void insert(Node *Entry) { Queue.insert(Entry); }
+  bool empty() const { return Queue.empty(); }
+  Node *pop() { return Queue.pop(); }
+};
+
+/// Compute the longest distance of each node from \p Entry, saturating at 32,
+/// as a monotone framework with a BreadthFirst work list would do. Return the
+/// number of visited labels.
+template<typename WorkList>
+static size_t visit(std::vector<Node> &Nodes, Node *Entry) {
+  for (Node &N : Nodes)
+    N.Distance = 0;
+
+  size_t Result = 0;
+  WorkList Queue(Entry);
+  Queue.insert(Entry);
+  while (not Queue.empty()) {
+    Node *Label = Queue.pop();
+    ++Result;
+    unsigned New = std::min(Label->Distance + 1, 32U);
+    for (Node *Successor : Label->Successors) {
+      if (New > Successor->Distance) {
+        Successor->Distance = New;
+        Queue.insert(Successor);
+      }
+    }
+  }
+  return Result;
+}
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("queue");
+
+  // A graph with a fallthrough and two random edges per node
+  constexpr unsigned Size = 100000;
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  std::vector<Node> Nodes(Size);
+  for (unsigned I = 0; I < Size; ++I) {
+    if (I + 1 < Size)
+      Nodes[I].Successors.push_back(&Nodes[I + 1]);
+    Nodes[I].Successors.push_back(&Nodes[Distribution(Generator)]);
+    Nodes[I].Successors.push_back(&Nodes[Distribution(Generator)]);
+  }
+
+  size_t SetVisits = 0;
+  Benchmark.measure("set-breadth-first", [&]() {
+    SetVisits = visit<SetBreadthFirstWorkList>(Nodes, &Nodes[0]);
+  });
+
+  size_t DenseVisits = 0;
+  Benchmark.measure("breadth-first", [&]() {
+    using WorkList = MonotoneFrameworkWorkList<Node *, BreadthFirst>;
+    DenseVisits = visit<WorkList>(Nodes, &Nodes[0]);
+  });
+
+  revng_check(SetVisits == DenseVisits);
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,49 @@
+/// \file RecursiveCoroutine.cpp
+/// \brief Deep recursive walks with RecursiveCoroutine
+///
+/// Built twice: as benchmark-micro-recursive-coroutine, using coroutines, and
+/// as benchmark-micro-recursive-coroutine-fallback, with
+/// DISABLE_RECURSIVE_COROUTINES, i.e., using RecursiveCoroutine-fallback.h.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+#include "tests/unit/DepthFirstVisit.h"
+
+#if defined(DISABLE_RECURSIVE_COROUTINES)
+static const char *const BenchmarkName = "recursive-coroutine-fallback";
+#else
+static const char *const BenchmarkName = "recursive-coroutine";
+#endif
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark(BenchmarkName);
+
+  // Many shallow calls
+  Graph Tree = createBinaryTree(20);
+  size_t Count = 0;
+  Benchmark.measure("binary-tree", [&]() { Count = countNodes(Tree.root()); });
+  revng_check(Count == (1 << 20) - 1);
+
+  // The same walk with an explicit stack, for reference
+  Benchmark.measure("binary-tree-iterative",
+                    [&]() { Count = iterativeCountNodes(Tree.root()); });
+  revng_check(Count == (1 << 20) - 1);
+
+  // Few, deep calls, within the reach of the native stack of the fallback
+  Graph ShortChain = createChain(20000);
+  Benchmark.measure("short-chain",
+                    [&]() { Count = countNodes(ShortChain.root()); });
+  revng_check(Count == 20000);
+
+#if not defined(DISABLE_RECURSIVE_COROUTINES)
+  // Few, very deep calls, which would overflow the native stack
+  Graph Chain = createChain(200000);
+  Benchmark.measure("chain", [&]() { Count = countNodes(Chain.root()); });
+  revng_check(Count == 200000);
+#endif
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,68 @@
+/// \file SortedVector.cpp
+/// \brief Batch insertions in a large SortedVector
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <vector>
+
+#include "revng/ADT/SortedVector.h"
+
+#include "tests/benchmark/micro/MicroBenchmark.h"
+#include "tests/unit/TestKeyedObject.h"
+
+int main(int argc, char *argv[]) {
+  MicroBenchmark Benchmark("sorted-vector");
+
+  constexpr uint64_t Size = 1000000;
+
+  // Two interleaved sorted sequences: the existing elements and the batch
+  std::vector<Element> Existing;
+  std::vector<Element> Batch;
+  for (uint64_t I = 0; I < Size; ++I) {
+    Existing.push_back({ I * 4, 1 });
+    Batch.push_back({ I * 4 + (I % 2 == 0 ? 0 : 2), 2 });
+  }
+
+  // Reference: append, stable_sort and remove duplicates, as if the batch was
+  // unsorted
+  std::vector<Element> Reference;
+  Benchmark.measure("sort-and-unique", [&]() {
+    Reference = Existing;
+    Reference.insert(Reference.end(), Batch.begin(), Batch.end());
+    auto Compare = [](const Element &LHS, const Element &RHS) {
+      return LHS.key() < RHS.key();
+    };
+    auto Equal = [](const Element &LHS, const Element &RHS) {
+      return LHS.key() == RHS.key();
+    };
+    std::stable_sort(Reference.begin(), Reference.end(), Compare);
+    Reference.erase(unique_last(Reference.begin(), Reference.end(), Equal),
+                    Reference.end());
+  });
+
+  SortedVector<Element> Set;
+  Benchmark.measure("merge", [&]() {
+    Set = SortedVector<Element>(Existing.begin(), Existing.end());
+    auto Inserter = Set.batch_insert_or_assign();
+    for (const Element &E : Batch)
+      Inserter.insert_or_assign(E);
+  });
+
+  revng_check(Set.size() == Reference.size());
+  revng_check(std::equal(Set.begin(), Set.end(), Reference.begin()));
+
+  // A small batch into a large container
+  SortedVector<Element> Large;
+  Benchmark.measure("small-batch", [&]() {
+    Large = Set;
+    auto Inserter = Large.batch_insert();
+    for (uint64_t I = 0; I < 100; ++I)
+      Inserter.insert({ I * 40000 + 1, 3 });
+  });
+  revng_check(Large.size() == Reference.size() + 100);
+
+  return Benchmark.finish(argc, argv);
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is distributed under the MIT License. See LICENSE.md for details.
+ */
+
+// Hash a buffer over and over with FNV-1a and with a multiply-rotate hash:
+// tight loops of arithmetic and memory loads
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BUFFER_SIZE (64 * 1024)
+
+static uint8_t buffer[BUFFER_SIZE];
+
+static uint32_t fnv1a(const uint8_t *data, size_t size, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t rotate_left(uint32_t value, unsigned amount) {
+  return (value << amount) | (value >> (32 - amount));
+}
+
+static uint32_t multiply_rotate(const uint8_t *data, size_t size, uint32_t seed) {
+  uint32_t hash = seed;
+  for (size_t i = 0; i + 4 <= size; i += 4) {
+    uint32_t word = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16)
+                    | ((uint32_t) data[i + 3] << 24);
+    word *= 0xcc9e2d51u;
+    word = rotate_left(word, 15);
+    word *= 0x1b873593u;
+    hash ^= word;
+    hash = rotate_left(hash, 13) * 5 + 0xe6546b64u;
+  }
+  return hash;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned rounds = argc > 1 ? strtoul(argv[1], NULL, 0) : 100;
+
+  uint32_t state = 1;
+  for (size_t i = 0; i < BUFFER_SIZE; i++) {
+    state = state * 1103515245u + 12345u;
+    buffer[i] = state >> 16;
+  }
+
+  uint32_t checksum = 0;
+  for (unsigned round = 0; round < rounds; round++) {
+    checksum ^= fnv1a(buffer, BUFFER_SIZE, round);
+    checksum = multiply_rotate(buffer, BUFFER_SIZE, checksum);
+    buffer[round % BUFFER_SIZE] ^= checksum;
+  }
+
+  printf("%08x\n", checksum);
+  return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is distributed under the MIT License. See LICENSE.md for details.
+ */
+
+// A stack-based bytecode interpreter running a loop that computes Collatz
+// sequence lengths: the main loop is a switch on the opcode, which is likely to
+// be compiled as a jump table
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum opcode {
+  PUSH,
+  LOAD,
+  STORE,
+  ADD,
+  SUB,
+  MUL,
+  DIV,
+  MOD,
+  DUP,
+  DROP,
+  JUMP,
+  JUMP_IF_ZERO,
+  HALT
+};
+
+#define VARIABLES 3
+
+enum variable { N, X, STEPS };
+
+// for (; n != 0; n--)
+//   for (x = n; x != 1; steps++)
+//     x = x % 2 == 0 ? x / 2 : x * 3 + 1;
+static const int32_t code[] = {
+  /*  0 */ LOAD, N, JUMP_IF_ZERO, 57,
+  /*  4 */ LOAD, N, STORE, X,
+  /*  8 */ LOAD, X, PUSH, 1, SUB, JUMP_IF_ZERO, 48,
+  /* 15 */ LOAD, X, PUSH, 2, MOD, JUMP_IF_ZERO, 32,
+  /* 22 */ LOAD, X, PUSH, 3, MUL, PUSH, 1, ADD, JUMP, 37,
+  /* 32 */ LOAD, X, PUSH, 2, DIV,
+  /* 37 */ STORE, X, LOAD, STEPS, PUSH, 1, ADD, STORE, STEPS, JUMP, 8,
+  /* 48 */ LOAD, N, PUSH, 1, SUB, STORE, N, JUMP, 0,
+  /* 57 */ HALT
+};
+
+static int64_t run(int64_t n) {
+  int64_t stack[16];
+  int64_t variables[VARIABLES] = { 0 };
+  unsigned sp = 0;
+  int32_t pc = 0;
+  variables[N] = n;
+
+  for (;;) {
+    switch (code[pc++]) {
+    case PUSH:
+      stack[sp++] = code[pc++];
+      break;
+    case LOAD:
+      stack[sp++] = variables[code[pc++]];
+      break;
+    case STORE:
+      variables[code[pc++]] = stack[--sp];
+      break;
+    case ADD:
+      sp--;
+      stack[sp - 1] += stack[sp];
+      break;
+    case SUB:
+      sp--;
+      stack[sp - 1] -= stack[sp];
+      break;
+    case MUL:
+      sp--;
+      stack[sp - 1] *= stack[sp];
+      break;
+    case DIV:
+      sp--;
+      stack[sp - 1] /= stack[sp];
+      break;
+    case MOD:
+      sp--;
+      stack[sp - 1] %= stack[sp];
+      break;
+    case DUP:
+      stack[sp] = stack[sp - 1];
+      sp++;
+      break;
+    case DROP:
+      sp--;
+      break;
+    case JUMP:
+      pc = code[pc];
+      break;
+    case JUMP_IF_ZERO:
+      if (stack[--sp] == 0)
+        pc = code[pc];
+      else
+        pc++;
+      break;
+    case HALT:
+      return variables[STEPS];
+    default:
+      abort();
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int64_t n = argc > 1 ? strtol(argv[1], NULL, 0) : 10000;
+  printf("%lld\n", (long long) run(n));
+  return 0;
+}
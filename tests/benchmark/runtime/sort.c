@@ -0,0 +1,72 @@
+/*
+ * This file is distributed under the MIT License. See LICENSE.md for details.
+ */
+
+// Sort arrays of pseudo-random numbers with qsort, which calls the comparison
+// function indirectly, and with a hand-written merge sort
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ELEMENTS (16 * 1024)
+
+static uint32_t input[ELEMENTS];
+static uint32_t temporary[ELEMENTS];
+
+static int compare(const void *a, const void *b) {
+  uint32_t left = *(const uint32_t *) a;
+  uint32_t right = *(const uint32_t *) b;
+  return (left > right) - (left < right);
+}
+
+static void merge_sort(uint32_t *data, uint32_t *scratch, size_t size) {
+  if (size < 2)
+    return;
+
+  size_t half = size / 2;
+  merge_sort(data, scratch, half);
+  merge_sort(data + half, scratch, size - half);
+
+  size_t left = 0;
+  size_t right = half;
+  size_t output = 0;
+  while (left < half && right < size)
+    scratch[output++] = data[left] <= data[right] ? data[left++] : data[right++];
+  while (left < half)
+    scratch[output++] = data[left++];
+  while (right < size)
+    scratch[output++] = data[right++];
+
+  memcpy(data, scratch, size * sizeof(uint32_t));
+}
+
+static void fill(uint32_t *data, uint32_t seed) {
+  uint32_t state = seed;
+  for (size_t i = 0; i < ELEMENTS; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    data[i] = state;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  unsigned rounds = argc > 1 ? strtoul(argv[1], NULL, 0) : 10;
+
+  uint32_t checksum = 0;
+  for (unsigned round = 0; round < rounds; round++) {
+    fill(input, round + 1);
+    if (round % 2 == 0)
+      qsort(input, ELEMENTS, sizeof(uint32_t), compare);
+    else
+      merge_sort(input, temporary, ELEMENTS);
+
+    for (size_t i = 0; i < ELEMENTS; i += 97)
+      checksum = checksum * 31 + input[i];
+  }
+
+  printf("%08x\n", checksum);
+  return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * This file is distributed under the MIT License. See LICENSE.md for details.
+ */
+
+// A state machine scanning a pseudo-random input, where each state is a case
+// of a large switch, plus calls through a table of function pointers: code
+// dominated by indirect jumps and calls
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define INPUT_SIZE (64 * 1024)
+#define STATES 16
+
+static uint8_t input[INPUT_SIZE];
+
+static uint32_t action_add(uint32_t state, uint8_t value) {
+  return state + value;
+}
+
+static uint32_t action_xor(uint32_t state, uint8_t value) {
+  return state ^ (value * 0x01010101u);
+}
+
+static uint32_t action_multiply(uint32_t state, uint8_t value) {
+  return state * (value | 1);
+}
+
+static uint32_t action_rotate(uint32_t state, uint8_t value) {
+  unsigned amount = value % 31 + 1;
+  return (state << amount) | (state >> (32 - amount));
+}
+
+typedef uint32_t (*action_t)(uint32_t, uint8_t);
+static action_t actions[] = { action_add,
+                              action_xor,
+                              action_multiply,
+                              action_rotate };
+
+static uint32_t scan(uint32_t accumulator) {
+  unsigned state = 0;
+  for (size_t i = 0; i < INPUT_SIZE; i++) {
+    uint8_t value = input[i];
+    switch (state) {
+    case 0:
+      state = value < 128 ? 1 : 2;
+      break;
+    case 1:
+      accumulator += value;
+      state = 3 + value % 4;
+      break;
+    case 2:
+      accumulator ^= value << 3;
+      state = 7 + value % 5;
+      break;
+    case 3:
+      accumulator = actions[value % 4](accumulator, value);
+      state = 12;
+      break;
+    case 4:
+      accumulator -= value * 7;
+      state = 0;
+      break;
+    case 5:
+      accumulator = actions[(value >> 2) % 4](accumulator, value);
+      state = 13;
+      break;
+    case 6:
+      accumulator += accumulator >> 5;
+      state = 1;
+      break;
+    case 7:
+      accumulator ^= 0x9e3779b9u;
+      state = 14;
+      break;
+    case 8:
+      accumulator = actions[accumulator % 4](accumulator, value);
+      state = 2;
+      break;
+    case 9:
+      accumulator *= 33;
+      state = 15;
+      break;
+    case 10:
+      accumulator += value | 0x100;
+      state = 0;
+      break;
+    case 11:
+      accumulator ^= accumulator << 7;
+      state = 4;
+      break;
+    case 12:
+      accumulator -= value;
+      state = value % STATES;
+      break;
+    case 13:
+      accumulator = (accumulator << 1) | (accumulator >> 31);
+      state = 6;
+      break;
+    case 14:
+      accumulator = actions[value % 4](accumulator, ~value);
+      state = 9;
+      break;
+    case 15:
+      accumulator += 0x7f4a7c15u;
+      state = value % 8;
+      break;
+    default:
+      abort();
+    }
+  }
+  return accumulator;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned rounds = argc > 1 ? strtoul(argv[1], NULL, 0) : 100;
+
+  uint32_t state = 42;
+  for (size_t i = 0; i < INPUT_SIZE; i++) {
+    state = state * 1664525u + 1013904223u;
+    input[i] = state >> 24;
+  }
+
+  uint32_t checksum = 0;
+  for (unsigned round = 0; round < rounds; round++)
+    checksum = scan(checksum + round);
+
+  printf("%08x\n", checksum);
+  return 0;
+}
@@ -88,10 +88,21 @@ bool TestAdvancedValueInfoPass::runOnModule(llvm::Module &M) {
   BasicBlock *StopAt = &Root.getEntryBlock();
   AdvancedValueInfo<MockupMemoryOracle> AVI(LVI, SCEV, DT, MO, StopAt);
 
-  for (User *U : M.getGlobalVariable("pc", true)->users()) {
-    if (auto *Store = dyn_cast<StoreInst>(U)) {
-      Value *V = Store->getValueOperand();
-      (*Results)[V] = AVI.explore(Store->getParent(), V);
+  // Querying through a cache must not affect the results, even on the second
+  // round, where everything is a cache hit
+  MaterializedValuesCache Cache;
+  using AVIType = AdvancedValueInfo<MockupMemoryOracle>;
+  AVIType CachedAVI(LVI, SCEV, DT, MO, StopAt, &Cache);
+
+  for (unsigned Round = 0; Round < 2; ++Round) {
+    for (User *U : M.getGlobalVariable("pc", true)->users()) {
+      if (auto *Store = dyn_cast<StoreInst>(U)) {
+        Value *V = Store->getValueOperand();
+        BasicBlock *BB = Store->getParent();
+        MaterializedValues Values = AVI.explore(BB, V);
+        revng_check(CachedAVI.explore(BB, V) == Values);
+        (*Results)[V] = std::move(Values);
+      }
     }
   }
 
@@ -466,3 +477,87 @@ end:
                                AI64(33),
                                AI64(34) } } });
 }
+
+BOOST_AUTO_TEST_CASE(TestDisjointRangesElement) {
+  using DisjointRanges::Element;
+
+  auto Range = [](uint64_t Start, uint64_t End) {
+    return ConstantRangeSet({ { 32, Start }, { 32, End } });
+  };
+
+  Element A;
+  A[2] = Range(10, 20);
+  A[0] = Range(0, 5);
+
+  Element B;
+  B[1] = Range(100, 200);
+  B[2] = Range(30, 40);
+
+  revng_check(not A.lowerThanOrEqual(B));
+  revng_check(not B.lowerThanOrEqual(A));
+
+  Element C = A.copy();
+  C.combine(B);
+  revng_check(A.lowerThanOrEqual(C));
+  revng_check(B.lowerThanOrEqual(C));
+  revng_check(C.hasKey(0) and C.hasKey(1) and C.hasKey(2));
+  revng_check(not C.hasKey(3));
+  revng_check(C[2] == Range(10, 20).unionWith(Range(30, 40)));
+  revng_check(C[1] == Range(100, 200));
+
+  // Combining with a lower element has no effect
+  Element D = C.copy();
+  D.combine(A);
+  revng_check(D.lowerThanOrEqual(C) and C.lowerThanOrEqual(D));
+
+  // Top is greater than any element, the missing entries have the full range
+  Element Top = Element::top();
+  revng_check(C.lowerThanOrEqual(Top) and not Top.lowerThanOrEqual(C));
+  Element E = Element::top();
+  E[1] = Range(100, 200);
+  revng_check(E.lowerThanOrEqual(Top) and not Top.lowerThanOrEqual(E));
+  E.combine(C);
+  revng_check(E.isTop() and E.hasKey(1) and not E.hasKey(0));
+  C.combine(Top);
+  revng_check(C.isTop() and not C.hasKey(0) and not C.hasKey(1));
+}
+
+BOOST_AUTO_TEST_CASE(TestMaterializedValuesCache) {
+  LLVMContext C;
+  auto *Int64 = Type::getInt64Ty(C);
+  auto *A = ConstantInt::get(Int64, 1);
+  auto *B = ConstantInt::get(Int64, 2);
+  auto *D = ConstantInt::get(Int64, 3);
+  auto Any = [](const MaterializedValuesCache::Entry &) { return true; };
+  auto None = [](const MaterializedValuesCache::Entry &) { return false; };
+
+  // Each entry costs 1 + the number of values
+  MaterializedValuesCache Cache(5);
+  Cache.insert({ A, nullptr, {} }, { { AI64(1) }, MaxMaterializedValues, {} });
+  Cache.insert({ B, nullptr, {} }, { { AI64(2) }, MaxMaterializedValues, {} });
+  revng_check(Cache.size() == 2);
+
+  // The same value reached through different edges is a different entry
+  revng_check(Cache.find({ A, nullptr, { { nullptr, nullptr } } }, Any)
+              == nullptr);
+
+  // Refuse unusable entries
+  revng_check(Cache.find({ A, nullptr, {} }, None) == nullptr);
+
+  // Touch A, so that B is the least recently used entry
+  auto *Entry = Cache.find({ A, nullptr, {} }, Any);
+  revng_check(Entry != nullptr and Entry->Values.size() == 1);
+  revng_check(Cache.hits() == 1 and Cache.misses() == 2);
+
+  Cache.insert({ D, nullptr, {} }, { { AI64(3) }, MaxMaterializedValues, {} });
+  revng_check(Cache.size() == 2);
+  revng_check(Cache.find({ B, nullptr, {} }, Any) == nullptr);
+  revng_check(Cache.find({ A, nullptr, {} }, Any) != nullptr);
+  revng_check(Cache.find({ D, nullptr, {} }, Any) != nullptr);
+
+  // Entries larger than the cache are ignored
+  MaterializedValues Large(10, AI64(0));
+  Cache.insert({ B, nullptr, {} }, { Large, MaxMaterializedValues, {} });
+  revng_check(Cache.find({ B, nullptr, {} }, Any) == nullptr);
+  revng_check(Cache.size() == 2);
+}
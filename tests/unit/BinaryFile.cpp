@@ -0,0 +1,271 @@
+/// \file BinaryFile.cpp
+/// \brief Tests for the parsing of binaries in BinaryFile
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE BinaryFile
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/Support/Debug.h"
+#include "revng/Support/Parallel.h"
+#include "revng/UnitTestHelpers/UnitTestHelpers.h"
+
+#include "BinaryFile.h"
+
+/// The binary we parse is the test itself: it has plenty of relocations and,
+/// being C++, of .eh_frame entries and landing pads
+static const char *const SelfPath = "/proc/self/exe";
+static const uint64_t BaseAddress = 0x400000;
+
+/// \brief Everything BinaryFile extracts from relocations and .eh_frame
+struct ParsedBinary {
+  std::string Labels;
+  std::set<MetaAddress> CodePointers;
+  std::set<MetaAddress> LandingPads;
+  std::string Warnings;
+};
+
+static std::string describeLabels(const BinaryFile &Binary) {
+  std::stringstream Result;
+  for (const auto &[Interval, Labels] : Binary.labels()) {
+    Interval.lower().dump(Result);
+    Result << " ";
+    Interval.upper().dump(Result);
+    Result << ":";
+    for (const Label *L : Labels) {
+      Result << " ";
+      L->dump(Result);
+    }
+    Result << "\n";
+  }
+  return Result.str();
+}
+
+/// \brief Parse the test binary with the given sharding parameters, capturing
+///        the warnings printed in the meantime
+static ParsedBinary parseSelf(unsigned ShardSize, unsigned Jobs) {
+  unsigned OldShardSize = BinaryFileShardSize;
+  unsigned OldJobs = ParallelJobs;
+  BinaryFileShardSize = ShardSize;
+  ParallelJobs = Jobs;
+
+  std::FILE *Warnings = std::tmpfile();
+  int OldStderr = dup(2);
+  revng_check(Warnings != nullptr and OldStderr != -1);
+  flushLogs();
+  dup2(fileno(Warnings), 2);
+
+  ParsedBinary Result;
+  {
+    BinaryFile Binary(SelfPath, BaseAddress);
+    Result.Labels = describeLabels(Binary);
+    Result.CodePointers = Binary.codePointers();
+    Result.LandingPads = Binary.landingPads();
+  }
+
+  flushLogs();
+  dup2(OldStderr, 2);
+  close(OldStderr);
+
+  std::rewind(Warnings);
+  char Buffer[256];
+  size_t Read;
+  while ((Read = std::fread(Buffer, 1, sizeof(Buffer), Warnings)) != 0)
+    Result.Warnings.append(Buffer, Read);
+  std::fclose(Warnings);
+
+  BinaryFileShardSize = OldShardSize;
+  ParallelJobs = OldJobs;
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedParsing) {
+  // A single shard
+  ParsedBinary Serial = parseSelf(BinaryFileShardSize, 1);
+  revng_check(not Serial.Labels.empty());
+  revng_check(not Serial.LandingPads.empty());
+
+  // As many shards as possible: the labels of all the shards must end up in
+  // the same places, the landing pads of all the shards must be collected and
+  // the warnings about unhandled relocations must be the same
+  for (unsigned Jobs : { 2, 3, 4 }) {
+    ParsedBinary Sharded = parseSelf(1, Jobs);
+    revng_check(Sharded.Labels == Serial.Labels);
+    revng_check(Sharded.CodePointers == Serial.CodePointers);
+    revng_check(Sharded.LandingPads == Serial.LandingPads);
+    revng_check(Sharded.Warnings == Serial.Warnings);
+  }
+}
+
+//
+// Symbol selection
+//
+
+static bool isBetterThan(const Label *NewCandidate, const Label *OldCandidate) {
+  if (OldCandidate == nullptr)
+    return true;
+
+  if (NewCandidate->address().addressGreaterThan(OldCandidate->address()))
+    return true;
+
+  return (NewCandidate->address() == OldCandidate->address()
+          and OldCandidate->symbolName().size() == 0);
+}
+
+/// \brief Choose the symbol to name an address with scanning the labels map,
+///        as BinaryFile used to do before SymbolIndex
+static const Label *referenceLookup(const BinaryFile::LabelIntervalMap &Map,
+                                    MetaAddress Address,
+                                    uint64_t Size) {
+  using Interval = boost::icl::interval<MetaAddress, compareAddress>;
+  auto It = Map.find(Interval::right_open(Address, Address.toGeneric() + Size));
+  if (It == Map.end())
+    return nullptr;
+
+  const Label *ContainedNonZeroSized = nullptr;
+  const Label *ContainedZeroSized = nullptr;
+  for (const Label *L : It->second) {
+    if (not L->isSymbol())
+      continue;
+
+    if (L->matches(Address, Size))
+      return L;
+
+    if (not L->isSizeVirtual() and L->contains(Address, Size)) {
+      if (isBetterThan(L, ContainedNonZeroSized))
+        ContainedNonZeroSized = L;
+    } else if (L->isSizeVirtual() and L->contains(Address, 0)) {
+      if (isBetterThan(L, ContainedZeroSized))
+        ContainedZeroSized = L;
+    }
+  }
+
+  if (ContainedNonZeroSized != nullptr)
+    return ContainedNonZeroSized;
+  return ContainedZeroSized;
+}
+
+static BinaryFile::LabelList &operator+=(BinaryFile::LabelList &This,
+                                        const BinaryFile::LabelList &Other) {
+  This.insert(std::end(This), std::begin(Other), std::end(Other));
+  return This;
+}
+
+BOOST_AUTO_TEST_CASE(TestSymbolIndexBoundaries) {
+  auto At = [](uint64_t Address) {
+    return MetaAddress::fromGeneric(llvm::Triple::x86_64, Address);
+  };
+  auto Symbol = [&At](uint64_t Address, uint64_t Size, const char *Name) {
+    return Label::createSymbol(LabelOrigin::Unknown,
+                               At(Address),
+                               Size,
+                               Name,
+                               SymbolType::Code);
+  };
+
+  std::vector<Label> Labels;
+  Labels.push_back(Symbol(0x1000, 0x100, "outer"));
+  Labels.push_back(Symbol(0x1040, 0x40, ""));
+  Labels.push_back(Symbol(0x1040, 0x40, "inner"));
+  Labels.push_back(Label::createAbsoluteValue(LabelOrigin::Unknown,
+                                              At(0x1050),
+                                              8,
+                                              0));
+  Labels.push_back(Symbol(0x1100, 0, "tail"));
+  Labels.back().setVirtualSize(0x20);
+  Labels.push_back(Symbol(0x1120, 0x20, "next"));
+
+  SymbolIndex Index;
+  Index.build(Labels);
+
+  BinaryFile::LabelIntervalMap Map;
+  using Interval = boost::icl::interval<MetaAddress, compareAddress>;
+  for (Label &L : Labels) {
+    auto Range = Interval::right_open(L.address(), L.address() + L.size());
+    Map += std::make_pair(Range, BinaryFile::LabelList{ &L });
+  }
+
+  auto NameAt = [&Index, &At](uint64_t Address, uint64_t Size) -> std::string {
+    const Label *Result = Index.lookup(At(Address), Size);
+    return Result == nullptr ? "none" : Result->symbolName().str();
+  };
+
+  // Exact matches win, the first registered one among equal symbols
+  revng_check(NameAt(0x1000, 0x100) == "outer");
+  revng_check(NameAt(0x1040, 0x40) == "");
+
+  // Then the innermost symbol strictly containing the range, preferring named
+  // ones
+  revng_check(NameAt(0x103f, 1) == "outer");
+  revng_check(NameAt(0x1040, 1) == "inner");
+  revng_check(NameAt(0x107e, 1) == "inner");
+  revng_check(NameAt(0x107f, 1) == "outer");
+  revng_check(NameAt(0x1080, 1) == "outer");
+  revng_check(NameAt(0x107c, 8) == "outer");
+
+  // Finally, symbols with a virtual size
+  revng_check(NameAt(0x10fe, 4) == "none");
+  revng_check(NameAt(0x1100, 1) == "tail");
+  revng_check(NameAt(0x111f, 1) == "tail");
+  revng_check(NameAt(0x1120, 4) == "next");
+
+  // Outside of any symbol
+  revng_check(NameAt(0xfff, 1) == "none");
+  revng_check(NameAt(0x1140, 1) == "none");
+
+  // Everywhere around the symbols, the choice matches the one of the labels map
+  for (uint64_t Address = 0xff0; Address < 0x1150; ++Address)
+    for (uint64_t Size = 1; Size < 6; ++Size)
+      revng_check(Index.lookup(At(Address), Size)
+                  == referenceLookup(Map, At(Address), Size));
+}
+
+BOOST_AUTO_TEST_CASE(TestNameForAddress) {
+  BinaryFile Binary(SelfPath, BaseAddress);
+  const BinaryFile::LabelIntervalMap &Map = Binary.labels();
+  auto Arch = Binary.architecture().type();
+
+  auto ReferenceName = [&](MetaAddress Address, uint64_t Size) {
+    std::stringstream Result;
+    const Label *Chosen = referenceLookup(Map, Address, Size);
+    if (Chosen != nullptr and Chosen->symbolName().size() != 0)
+      Address.dumpRelativeTo(Result,
+                             Chosen->address().toPC(Arch),
+                             Chosen->symbolName());
+    else
+      Address.dump(Result);
+    return Result.str();
+  };
+
+  // Name the addresses at the boundaries of each symbol
+  size_t Checked = 0;
+  for (const auto &[Interval, Labels] : Map) {
+    for (const Label *L : Labels) {
+      if (not L->isSymbol() or L->size() == 0)
+        continue;
+
+      MetaAddress Start = L->address().toPC(Arch);
+      MetaAddress End = Start + L->size();
+      for (MetaAddress Address : { Start, Start + 1, End - 1, End }) {
+        for (uint64_t Size : { 1, 4 }) {
+          revng_check(Binary.nameForAddress(Address, Size)
+                      == ReferenceName(Address, Size));
+          ++Checked;
+        }
+      }
+    }
+  }
+
+  revng_check(Checked > 0);
+}
@@ -62,3 +62,36 @@ BOOST_AUTO_TEST_CASE(TestEnumerate) {
     dbg << "\n";
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestWideBitWidths) {
+  using CRS = ConstantRangeSet;
+
+  // Check that sets wider than 64 bits behave as the narrow ones
+  auto Range = [](uint32_t BitWidth, uint64_t Start, uint64_t End) {
+    return CRS({ { BitWidth, Start }, { BitWidth, End } });
+  };
+
+  for (uint32_t BitWidth : { 32, 64, 128 }) {
+    CRS Union = Range(BitWidth, 10, 20).unionWith(Range(BitWidth, 30, 40));
+    CRS Intersection = Union.intersectWith(Range(BitWidth, 15, 35));
+
+    revng_check(Union.size() == llvm::APInt(BitWidth, 20));
+    revng_check(Intersection.size() == llvm::APInt(BitWidth, 10));
+    revng_check(Union.contains(Intersection));
+    revng_check(not Intersection.contains(Union));
+
+    std::vector<uint64_t> Values;
+    for (const llvm::APInt &Value : Intersection)
+      Values.push_back(Value.getLimitedValue());
+
+    std::vector<uint64_t> Expected = { 15, 16, 17, 18, 19, 30, 31, 32, 33, 34 };
+    revng_check(Values == Expected);
+
+    // Wrapping ranges
+    CRS Wrapped(llvm::ConstantRange(llvm::APInt(BitWidth, 5),
+                                    llvm::APInt(BitWidth, 2)));
+    revng_check(Wrapped.size() + 3 == llvm::APInt::getMaxValue(BitWidth));
+    revng_check(CRS(BitWidth, true).contains(Wrapped));
+    revng_check(CRS(BitWidth, true).isFullSet());
+  }
+}
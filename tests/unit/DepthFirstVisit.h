@@ -129,8 +129,8 @@ inline Graph createRandomGraph() {
   return Result;
 }
 
-extern size_t MaxDepth;
-extern size_t Iterations;
+inline size_t MaxDepth = 0;
+inline size_t Iterations = 0;
 
 struct Entry {
   using iterator = std::vector<Node *>::const_iterator;
@@ -262,3 +262,53 @@ inline size_t iterativeFindMaxRet(Node *Root, std::set<Node *> &Stack) {
 
   return Max;
 }
+
+/// \brief Create a complete binary tree with 2^Height - 1 nodes
+inline Graph createBinaryTree(size_t Height) {
+  Graph Result;
+  std::vector<Node *> Level = { Result.root() };
+  for (size_t I = 1; I < Height; ++I) {
+    std::vector<Node *> NextLevel;
+    for (Node *Parent : Level) {
+      for (int J = 0; J < 2; ++J) {
+        NextLevel.push_back(Result.newNode());
+        Parent->addChild(NextLevel.back());
+      }
+    }
+    Level = std::move(NextLevel);
+  }
+  return Result;
+}
+
+/// \brief Create a chain of \p Length nodes
+inline Graph createChain(size_t Length) {
+  Graph Result;
+  Node *Last = Result.root();
+  for (size_t I = 1; I < Length; ++I) {
+    Node *New = Result.newNode();
+    Last->addChild(New);
+    Last = New;
+  }
+  return Result;
+}
+
+/// \brief Count the nodes of a tree
+inline RecursiveCoroutine<size_t> countNodes(Node *Current) {
+  size_t Result = 1;
+  for (Node *Child : Current->children())
+    Result += rc_recur countNodes(Child);
+  rc_return Result;
+}
+
+inline size_t iterativeCountNodes(Node *Root) {
+  size_t Result = 0;
+  std::vector<Node *> Stack = { Root };
+  while (not Stack.empty()) {
+    Node *Current = Stack.back();
+    Stack.pop_back();
+    ++Result;
+    for (Node *Child : Current->children())
+      Stack.push_back(Child);
+  }
+  return Result;
+}
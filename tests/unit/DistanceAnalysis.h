@@ -0,0 +1,58 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "revng/ADT/GenericGraph.h"
+
+struct DistanceNodeData {
+  DistanceNodeData(unsigned Index) : Index(Index) {}
+  unsigned Index;
+};
+
+using DistanceNode = ForwardNode<DistanceNodeData>;
+using DistanceGraph = GenericGraph<DistanceNode>;
+
+inline constexpr uint32_t MaxDistance = 64;
+
+/// Longest distance from an extremal node, saturating at MaxDistance
+struct DistanceAnalysis {
+  using GraphType = DistanceGraph *;
+  using LatticeElement = uint32_t;
+  using Label = DistanceNode *;
+
+  static uint32_t combineValues(const uint32_t &Lh, const uint32_t &Rh) {
+    return std::max(Lh, Rh);
+  }
+
+  static bool isLessOrEqual(const uint32_t &Lh, const uint32_t &Rh) {
+    return Lh <= Rh;
+  }
+
+  static uint32_t applyTransferFunction(DistanceNode *, const uint32_t E) {
+    return std::min(E + 1, MaxDistance);
+  }
+};
+
+inline DistanceGraph createGraph(std::mt19937 &Generator, unsigned Size) {
+  DistanceGraph Result;
+  std::vector<DistanceNode *> Nodes;
+  for (unsigned I = 0; I < Size; ++I)
+    Nodes.push_back(Result.addNode(I));
+
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  for (unsigned I = 0; I < Size; ++I) {
+    if (I + 1 < Size)
+      Nodes[I]->addSuccessor(Nodes[I + 1]);
+    if (I % 8 == 0)
+      Nodes[I]->addSuccessor(Nodes[Distribution(Generator)]);
+  }
+
+  return Result;
+}
@@ -0,0 +1,192 @@
+/// \file FrozenGraph.cpp
+/// \brief Tests for FrozenGraph
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE FrozenGraph
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/Support/GenericDomTree.h"
+#include "llvm/Support/GenericDomTreeConstruction.h"
+
+#include "revng/ADT/FilteredGraphTraits.h"
+#include "revng/ADT/FrozenGraph.h"
+#include "revng/ADT/GenericGraph.h"
+#include "revng/Support/GraphAlgorithms.h"
+
+using namespace llvm;
+
+struct TestNodeData {
+  TestNodeData(unsigned Rank) : Rank(Rank) {}
+  unsigned Rank;
+};
+
+struct TestEdgeLabel {
+  unsigned Weight;
+};
+
+using TestNode = BidirectionalNode<TestNodeData, TestEdgeLabel>;
+using TestGraph = GenericGraph<TestNode>;
+using FrozenTestGraph = FrozenGraph<TestNode *>;
+using FrozenTestNode = FrozenTestGraph::Node;
+
+static bool isHeavy(Edge<TestNode, TestEdgeLabel> &Edge) {
+  return Edge.Weight > 5;
+}
+
+static void createDiamond(TestGraph &Graph) {
+  TestNode *Root = Graph.addNode(0);
+  TestNode *Then = Graph.addNode(1);
+  TestNode *Else = Graph.addNode(2);
+  TestNode *Final = Graph.addNode(3);
+  Graph.setEntryNode(Root);
+
+  Root->addSuccessor(Then, { 7 });
+  Root->addSuccessor(Else, { 1 });
+  Then->addSuccessor(Final, { 8 });
+  Else->addSuccessor(Final, { 3 });
+}
+
+static unsigned getRank(FrozenTestNode *Node) {
+  return Node->original()->Rank;
+}
+
+BOOST_AUTO_TEST_CASE(TestFreeze) {
+  TestGraph Graph;
+  createDiamond(Graph);
+
+  auto Frozen = FrozenTestGraph::freeze(&Graph);
+  revng_check(Frozen.size() == 4);
+  revng_check(getRank(Frozen.getEntryNode()) == 0);
+
+  for (TestNode *Node : Graph.nodes()) {
+    FrozenTestNode *FrozenNode = Frozen.lookup(Node);
+    revng_check(FrozenNode->original() == Node);
+    revng_check(Frozen.getNodeByIndex(FrozenNode->index()) == FrozenNode);
+
+    std::vector<TestNode *> Successors;
+    for (FrozenTestNode *Successor : FrozenNode->successors())
+      Successors.push_back(Successor->original());
+    revng_check(Successors
+                == std::vector<TestNode *>(Node->successors().begin(),
+                                           Node->successors().end()));
+
+    std::vector<TestNode *> Predecessors;
+    for (FrozenTestNode *Predecessor : FrozenNode->predecessors())
+      Predecessors.push_back(Predecessor->original());
+    revng_check(Predecessors
+                == std::vector<TestNode *>(Node->predecessors().begin(),
+                                           Node->predecessors().end()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAlgorithms) {
+  TestGraph Graph;
+  createDiamond(Graph);
+  auto Frozen = FrozenTestGraph::freeze(&Graph);
+  FrozenTestNode *Root = Frozen.getNodeByIndex(0);
+  FrozenTestNode *Then = Frozen.getNodeByIndex(1);
+  FrozenTestNode *Final = Frozen.getNodeByIndex(3);
+
+  ReversePostOrderTraversal<FrozenTestGraph *> RPOT(&Frozen);
+  revng_check(std::distance(RPOT.begin(), RPOT.end()) == 4);
+  revng_check(*RPOT.begin() == Root);
+
+  unsigned SCCCount = 0;
+  for (auto &SCC : make_range(scc_begin(&Frozen), scc_end(&Frozen))) {
+    revng_check(SCC.size() == 1);
+    ++SCCCount;
+  }
+  revng_check(SCCCount == 4);
+
+  DominatorTreeBase<FrozenTestNode, false> DT;
+  DT.recalculate(Frozen);
+  revng_check(DT.dominates(DT.getNode(Root), DT.getNode(Final)));
+  revng_check(not DT.dominates(DT.getNode(Then), DT.getNode(Final)));
+
+  DominatorTreeBase<FrozenTestNode, true> PDT;
+  PDT.recalculate(Frozen);
+  revng_check(PDT.dominates(PDT.getNode(Final), PDT.getNode(Root)));
+
+  revng_check(nodesBetween(Root, Final).size() == 4);
+  revng_check(nodesBetweenReverse(Final, Then).size() == 2);
+  auto InverseVisit = inverse_depth_first(Final);
+  revng_check(std::distance(InverseVisit.begin(), InverseVisit.end()) == 4);
+}
+
+BOOST_AUTO_TEST_CASE(TestFreezeFilteredView) {
+  TestGraph Graph;
+  createDiamond(Graph);
+
+  using HeavyEdges = EdgeFilteredGraph<TestNode *, isHeavy>;
+  using GT = GraphTraits<HeavyEdges>;
+  auto Frozen = FrozenTestGraph::freezeReachable<GT>(Graph.getEntryNode());
+
+  // Root -> Then -> Final
+  revng_check(Frozen.size() == 3);
+  revng_check(Frozen.lookup(Graph.getEntryNode()) == Frozen.getEntryNode());
+  for (FrozenTestNode *Node : depth_first(Frozen.getEntryNode()))
+    revng_check(Node->successorCount() <= 1);
+  revng_check(Frozen.getNodeByIndex(2)->predecessorCount() == 1);
+}
+
+static void createRandomGraph(TestGraph &Graph, unsigned Size) {
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  std::vector<TestNode *> Nodes;
+  for (unsigned I = 0; I < Size; ++I)
+    Nodes.push_back(Graph.addNode(I));
+  Graph.setEntryNode(Nodes[0]);
+
+  for (unsigned I = 0; I < Size; ++I) {
+    if (I + 1 < Size)
+      Nodes[I]->addSuccessor(Nodes[I + 1], { Generator() % 10 });
+    Nodes[I]->addSuccessor(Nodes[Distribution(Generator)],
+                           { Generator() % 10 });
+  }
+}
+
+template<typename T>
+static size_t countSCCs(T Entry) {
+  size_t Result = 0;
+  for (auto &SCC : make_range(scc_begin(Entry), scc_end(Entry)))
+    Result += SCC.size() > 1;
+  return Result;
+}
+
+template<typename GT, typename NodeRef>
+static size_t countReachable(NodeRef Entry) {
+  using DFIterator = df_iterator<NodeRef,
+                                 df_iterator_default_set<NodeRef>,
+                                 false,
+                                 GT>;
+  return std::distance(DFIterator::begin(Entry), DFIterator::end(Entry));
+}
+
+BOOST_AUTO_TEST_CASE(TestRandomGraph) {
+  using HeavyEdges = EdgeFilteredGraph<TestNode *, isHeavy>;
+  using GT = GraphTraits<HeavyEdges>;
+
+  TestGraph Graph;
+  createRandomGraph(Graph, 500);
+  TestNode *Entry = Graph.getEntryNode();
+
+  auto Frozen = FrozenTestGraph::freeze(&Graph);
+  auto FrozenHeavy = FrozenTestGraph::freezeReachable<GT>(Entry);
+
+  revng_check(countSCCs(Entry) == countSCCs(Frozen.getEntryNode()));
+  using FrozenGT = GraphTraits<FrozenTestNode *>;
+  size_t Reachable = countReachable<GT>(Entry);
+  revng_check(Reachable
+              == countReachable<FrozenGT>(FrozenHeavy.getEntryNode()));
+  revng_check(Reachable == FrozenHeavy.size());
+}
@@ -302,3 +302,90 @@ BOOST_AUTO_TEST_CASE(TestSerializeGraph) {
 
   revng_check(Deserialized == Serializable);
 }
+
+struct ChunkedNodeData {
+  ChunkedNodeData(unsigned Rank) : Rank(Rank) {}
+  unsigned Rank;
+};
+
+using ChunkedNode = BidirectionalNode<ChunkedNodeData>;
+
+template<>
+struct GenericGraphAllocation<ChunkedNode> {
+  using type = ChunkedNodes<4>;
+};
+
+using ChunkedGraph = GenericGraph<ChunkedNode>;
+static_assert(ChunkedGraph::hasNodeIndices);
+static_assert(not TestGraph::hasNodeIndices);
+
+BOOST_AUTO_TEST_CASE(TestChunkedNodes) {
+  ChunkedGraph Graph;
+  std::vector<ChunkedNode *> Nodes;
+  for (unsigned I = 0; I < 10; ++I)
+    Nodes.push_back(Graph.addNode(I));
+  Graph.setEntryNode(Nodes[0]);
+  for (unsigned I = 0; I + 1 < 10; ++I)
+    Nodes[I]->addSuccessor(Nodes[I + 1]);
+
+  for (unsigned I = 0; I < 10; ++I) {
+    revng_check(Nodes[I]->getParent() == &Graph);
+    revng_check(Graph.getNodeIndex(Nodes[I]) == I);
+    revng_check(Graph.getNodeByIndex(I) == Nodes[I]);
+  }
+
+  // Remove the nodes with an odd rank, indices of the others do not change
+  for (auto It = Graph.nodes().begin(); It != Graph.nodes().end();) {
+    if ((*It)->Rank % 2 == 1)
+      It = Graph.removeNode(It);
+    else
+      ++It;
+  }
+
+  revng_check(Graph.size() == 5);
+  revng_check(Graph.nodeIndexLimit() == 10);
+  unsigned ExpectedRank = 0;
+  for (ChunkedNode *Node : Graph.nodes()) {
+    revng_check(Node->Rank == ExpectedRank);
+    revng_check(Graph.getNodeIndex(Node) == ExpectedRank);
+    ExpectedRank += 2;
+  }
+
+  // New nodes get new indices
+  ChunkedNode *New = Graph.addNode(10);
+  revng_check(Graph.getNodeIndex(New) == 10);
+
+  // Moving the graph does not move the nodes
+  ChunkedGraph Moved = std::move(Graph);
+  revng_check(Moved.size() == 6);
+  revng_check(Moved.getNodeByIndex(10) == New);
+  revng_check(Graph.size() == 0);
+  revng_check(Graph.nodes().begin() == Graph.nodes().end());
+}
+
+BOOST_AUTO_TEST_CASE(TestChunkedNodesGraphTraits) {
+  ChunkedGraph Graph;
+  ChunkedNode *Root = Graph.addNode(0);
+  ChunkedNode *Then = Graph.addNode(1);
+  ChunkedNode *Else = Graph.addNode(2);
+  ChunkedNode *Final = Graph.addNode(3);
+  Graph.setEntryNode(Root);
+  Root->addSuccessor(Then);
+  Root->addSuccessor(Else);
+  Then->addSuccessor(Final);
+  Else->addSuccessor(Final);
+
+  ReversePostOrderTraversal<ChunkedGraph *> RPOT(&Graph);
+  revng_check(std::distance(RPOT.begin(), RPOT.end()) == 4);
+  revng_check(*RPOT.begin() == Root);
+
+  DominatorTreeBase<ChunkedNode, false> DT;
+  DT.recalculate(Graph);
+  revng_check(DT.dominates(DT.getNode(Root), DT.getNode(Final)));
+  revng_check(not DT.dominates(DT.getNode(Then), DT.getNode(Final)));
+
+  std::vector<ChunkedNode *> Visited;
+  for (ChunkedNode *Node : inverse_depth_first(Final))
+    Visited.push_back(Node);
+  revng_check(Visited.size() == 4);
+}
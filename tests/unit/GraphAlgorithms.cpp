@@ -0,0 +1,440 @@
+/// \file GraphAlgorithms.cpp
+/// \brief Tests for GraphAlgorithms.h and ParallelGraphAlgorithms.h
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE GraphAlgorithms
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SCCIterator.h"
+
+#include "revng/ADT/FrozenGraph.h"
+#include "revng/ADT/GenericGraph.h"
+#include "revng/Support/GraphAlgorithms.h"
+#include "revng/Support/ParallelGraphAlgorithms.h"
+#include "revng/UnitTestHelpers/DotGraphObject.h"
+
+using namespace llvm;
+
+struct TestNodeData {
+  TestNodeData(unsigned Index) : Index(Index) {}
+  unsigned Index;
+};
+
+using TestNode = BidirectionalNode<TestNodeData>;
+using TestGraph = GenericGraph<TestNode>;
+using FrozenTestGraph = FrozenGraph<TestNode *>;
+using FrozenTestNode = FrozenTestGraph::Node;
+
+/// \brief The original, depth-first, implementation of nodesBetween
+///
+/// nodesBetween must return the same nodes, including when Source is ignored.
+template<typename GT, typename NodeRef = typename GT::NodeRef>
+static llvm::SmallPtrSet<NodeRef, 4>
+referenceNodesBetween(NodeRef Source,
+                      NodeRef Destination,
+                      const llvm::SmallPtrSetImpl<NodeRef> *IgnoreList) {
+
+  using Iterator = typename GT::ChildIteratorType;
+  using NodeSet = llvm::SmallPtrSet<NodeRef, 4>;
+
+  auto HasSuccessors = [](const NodeRef Node) {
+    return GT::child_begin(Node) != GT::child_end(Node);
+  };
+
+  // Ensure Source has at least one successor
+  if (not HasSuccessors(Source)) {
+    if (Source == Destination)
+      return { Source };
+    else
+      return {};
+  }
+
+  NodeSet Selected = { Destination };
+  NodeSet VisitedNodes;
+
+  struct StackEntry {
+    StackEntry(NodeRef Node) :
+      Node(Node),
+      Set({ Node }),
+      NextSuccessorIt(GT::child_begin(Node)),
+      EndSuccessorIt(GT::child_end(Node)) {}
+
+    NodeRef Node;
+    NodeSet Set;
+    Iterator NextSuccessorIt;
+    Iterator EndSuccessorIt;
+  };
+  std::vector<StackEntry> Stack;
+
+  Stack.emplace_back(Source);
+
+  while (not Stack.empty()) {
+    StackEntry *Entry = &Stack.back();
+
+    NodeRef CurrentSuccessor = *Entry->NextSuccessorIt;
+
+    bool Visited = (VisitedNodes.count(CurrentSuccessor) != 0);
+    VisitedNodes.insert(CurrentSuccessor);
+
+    if (Selected.count(CurrentSuccessor) != 0) {
+
+      // We reached a selected node, select all the nodes on the stack
+      for (const StackEntry &E : Stack) {
+        Selected.insert(E.Set.begin(), E.Set.end());
+      }
+
+    } else if (Visited) {
+      // We already visited this node, do not proceed in this direction
+
+      auto End = Stack.end();
+      auto IsCurrent = [CurrentSuccessor](const StackEntry &E) {
+        return E.Set.count(CurrentSuccessor) != 0;
+      };
+      auto It = std::find_if(Stack.begin(), End, IsCurrent);
+      bool IsAlreadyOnStack = It != End;
+
+      if (IsAlreadyOnStack) {
+        // It's already on the stack, insert all those on stack until the top
+        StackEntry &Target = *It;
+        Target.Set.insert(CurrentSuccessor);
+        ++It;
+        for (const StackEntry &E : llvm::make_range(It, End)) {
+          Target.Set.insert(E.Set.begin(), E.Set.end());
+        }
+      }
+
+    } else if (IgnoreList != nullptr
+               and IgnoreList->count(CurrentSuccessor) != 0) {
+      // Ignore
+    } else {
+
+      // We never visited this node, proceed to its successors, if any
+      if (HasSuccessors(CurrentSuccessor)) {
+        revng_assert(CurrentSuccessor != nullptr);
+        Stack.emplace_back(CurrentSuccessor);
+      }
+
+      continue;
+    }
+
+    bool TryNext = false;
+    do {
+      // Move to the next successor
+      ++Entry->NextSuccessorIt;
+
+      // Are we done with this entry?
+      TryNext = (Entry->NextSuccessorIt == Entry->EndSuccessorIt);
+
+      if (TryNext) {
+        // Pop from the stack
+        Stack.pop_back();
+
+        // If there's another element process it
+        if (Stack.size() == 0) {
+          TryNext = false;
+        } else {
+          Entry = &Stack.back();
+        }
+      }
+
+    } while (TryNext);
+  }
+
+  return Selected;
+}
+
+/// \brief The SCCs of llvm::scc_iterator with at least an edge and no exits
+template<typename NodeRef>
+static std::vector<std::vector<NodeRef>> referenceExitlessSCCs(NodeRef Entry) {
+  using GT = GraphTraits<NodeRef>;
+  std::vector<std::vector<NodeRef>> Result;
+  for (const std::vector<NodeRef> &SCC :
+       make_range(scc_begin(Entry), scc_end(Entry))) {
+    std::set<NodeRef> SCCNodes(SCC.begin(), SCC.end());
+    bool HasExit = false;
+    bool AtLeastOneEdge = false;
+    for (NodeRef Node : SCC) {
+      for (NodeRef Child : make_range(GT::child_begin(Node),
+                                      GT::child_end(Node))) {
+        AtLeastOneEdge = true;
+        HasExit = HasExit or SCCNodes.count(Child) == 0;
+      }
+    }
+
+    if (AtLeastOneEdge and not HasExit)
+      Result.push_back(SCC);
+  }
+  return Result;
+}
+
+template<typename NodeRef>
+static std::set<NodeRef> toSet(const SmallPtrSet<NodeRef, 4> &Nodes) {
+  return std::set<NodeRef>(Nodes.begin(), Nodes.end());
+}
+
+template<typename NodeRef>
+static std::set<NodeRef> toSet(const std::vector<NodeRef> &Nodes) {
+  return std::set<NodeRef>(Nodes.begin(), Nodes.end());
+}
+
+template<typename NodeRef>
+static void checkExitlessSCCs(NodeRef Entry) {
+  auto Expected = referenceExitlessSCCs(Entry);
+  auto Actual = exitless_scc_range(Entry);
+  revng_check(Actual.size() == Expected.size());
+  for (size_t I = 0; I < Actual.size(); ++I)
+    revng_check(toSet(Actual[I]) == toSet(Expected[I]));
+}
+
+template<typename NodeRef>
+static void checkNodesBetween(NodeRef Source,
+                              NodeRef Destination,
+                              const SmallPtrSetImpl<NodeRef> *IgnoreList) {
+  using Forward = GraphTraits<NodeRef>;
+  using Backward = GraphTraits<Inverse<NodeRef>>;
+
+  auto Expected = toSet(referenceNodesBetween<Forward>(Source,
+                                                       Destination,
+                                                       IgnoreList));
+  revng_check(toSet(nodesBetween(Source, Destination, IgnoreList))
+              == Expected);
+
+  auto ExpectedReverse = toSet(referenceNodesBetween<Backward>(Source,
+                                                              Destination,
+                                                              IgnoreList));
+  revng_check(toSet(nodesBetweenReverse(Source, Destination, IgnoreList))
+              == ExpectedReverse);
+}
+
+/// \brief Create a CFG-like graph: a chain with random forward and backward
+///        jumps and self loops, optionally interrupted by dead ends
+static void createRandomGraph(std::mt19937 &Generator,
+                              TestGraph &Graph,
+                              unsigned Size,
+                              bool DeadEnds = true) {
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  std::vector<TestNode *> Nodes;
+  for (unsigned I = 0; I < Size; ++I)
+    Nodes.push_back(Graph.addNode(I));
+  Graph.setEntryNode(Nodes[0]);
+
+  for (unsigned I = 0; I < Size; ++I) {
+    switch (Generator() % 8) {
+    case 0:
+      if (DeadEnds)
+        continue;
+      break;
+    case 1:
+      Nodes[I]->addSuccessor(Nodes[I]);
+      if (DeadEnds)
+        continue;
+      break;
+    case 2:
+    case 3:
+      Nodes[I]->addSuccessor(Nodes[Distribution(Generator)]);
+      break;
+    }
+
+    if (I + 1 < Size)
+      Nodes[I]->addSuccessor(Nodes[I + 1]);
+  }
+}
+
+template<typename NodeRef, typename Range>
+static void checkAllPairs(std::mt19937 &Generator,
+                          NodeRef Entry,
+                          Range &&Nodes,
+                          unsigned Pairs) {
+  std::vector<NodeRef> All(Nodes.begin(), Nodes.end());
+  std::uniform_int_distribution<size_t> Distribution(0, All.size() - 1);
+
+  checkExitlessSCCs(Entry);
+
+  for (unsigned I = 0; I < Pairs; ++I) {
+    NodeRef Source = All[Distribution(Generator)];
+    NodeRef Destination = All[Distribution(Generator)];
+    checkNodesBetween<NodeRef>(Source, Destination, nullptr);
+
+    SmallPtrSet<NodeRef, 4> IgnoreList;
+    for (unsigned J = 0; J < 1 + All.size() / 8; ++J)
+      IgnoreList.insert(All[Distribution(Generator)]);
+    if (Generator() % 2)
+      IgnoreList.insert(Source);
+    if (Generator() % 2)
+      IgnoreList.insert(Destination);
+    checkNodesBetween<NodeRef>(Source, Destination, &IgnoreList);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestAgainstReference) {
+  std::mt19937 Generator(42);
+  for (unsigned Size : { 1, 2, 3, 5, 10, 50, 300 }) {
+    for (unsigned Round = 0; Round < 20; ++Round) {
+      TestGraph Graph;
+      createRandomGraph(Generator, Graph, Size);
+      checkAllPairs(Generator, Graph.getEntryNode(), Graph.nodes(), 20);
+
+      auto Frozen = FrozenTestGraph::freeze(&Graph);
+      auto FrozenNodes = map_range(Frozen.nodes(),
+                                   [](FrozenTestNode &N) { return &N; });
+      checkAllPairs(Generator, Frozen.getEntryNode(), FrozenNodes, 20);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestIgnoredSource) {
+  // An ignored Source is selected once Destination is reached: the nodes on
+  // the 4 -> 2 -> 0 -> 4 cycle are selected only if 4 -> 3 is visited first
+  for (bool DestinationFirst : { false, true }) {
+    TestGraph Graph;
+    std::vector<TestNode *> Nodes;
+    for (unsigned I = 0; I < 5; ++I)
+      Nodes.push_back(Graph.addNode(I));
+
+    if (DestinationFirst)
+      Nodes[4]->addSuccessor(Nodes[3]);
+    Nodes[4]->addSuccessor(Nodes[2]);
+    Nodes[2]->addSuccessor(Nodes[0]);
+    Nodes[0]->addSuccessor(Nodes[4]);
+    if (not DestinationFirst)
+      Nodes[4]->addSuccessor(Nodes[3]);
+
+    SmallPtrSet<TestNode *, 4> IgnoreList = { Nodes[4] };
+    std::set<TestNode *> Expected = { Nodes[3], Nodes[4] };
+    if (DestinationFirst)
+      Expected.insert({ Nodes[0], Nodes[2] });
+    revng_check(toSet(nodesBetween(Nodes[4], Nodes[3], &IgnoreList))
+                == Expected);
+    checkNodesBetween<TestNode *>(Nodes[4], Nodes[3], &IgnoreList);
+
+    auto Frozen = FrozenTestGraph::freeze(&Graph);
+    FrozenTestNode *Source = Frozen.lookup(Nodes[4]);
+    FrozenTestNode *Destination = Frozen.lookup(Nodes[3]);
+    SmallPtrSet<FrozenTestNode *, 4> FrozenIgnoreList = { Source };
+    checkNodesBetween<FrozenTestNode *>(Source, Destination, &FrozenIgnoreList);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestParallelNodesBetween) {
+  unsigned OldJobs = ParallelJobs;
+  ParallelJobs = 2;
+
+  // Large enough for the forward and backward visits to run concurrently
+  std::mt19937 Generator(42);
+  TestGraph Graph;
+  createRandomGraph(Generator, Graph, ::detail::ParallelNodesBetweenThreshold);
+  auto Frozen = FrozenTestGraph::freeze(&Graph);
+
+  std::vector<TestNode *> All(Graph.nodes().begin(), Graph.nodes().end());
+  std::uniform_int_distribution<size_t> Distribution(0, All.size() - 1);
+  for (unsigned I = 0; I < 20; ++I) {
+    TestNode *Source = All[Distribution(Generator)];
+    TestNode *Destination = All[Distribution(Generator)];
+    FrozenTestNode *FrozenSource = Frozen.lookup(Source);
+    FrozenTestNode *FrozenDestination = Frozen.lookup(Destination);
+
+    SmallPtrSet<FrozenTestNode *, 4> IgnoreList;
+    for (unsigned J = 0; J < 16; ++J)
+      IgnoreList.insert(Frozen.lookup(All[Distribution(Generator)]));
+    IgnoreList.erase(FrozenSource);
+
+    for (auto *Ignored : { &IgnoreList, decltype(&IgnoreList)(nullptr) }) {
+      auto Expected = toSet(nodesBetween(FrozenSource,
+                                         FrozenDestination,
+                                         Ignored));
+      revng_check(toSet(parallelNodesBetween(FrozenSource,
+                                             FrozenDestination,
+                                             Ignored))
+                  == Expected);
+
+      auto ExpectedReverse = toSet(nodesBetweenReverse(FrozenSource,
+                                                       FrozenDestination,
+                                                       Ignored));
+      revng_check(toSet(parallelNodesBetweenReverse(FrozenSource,
+                                                    FrozenDestination,
+                                                    Ignored))
+                  == ExpectedReverse);
+    }
+  }
+
+  ParallelJobs = OldJobs;
+}
+
+static std::set<std::string>
+names(const std::vector<std::vector<DotNode *>> &SCCs) {
+  std::set<std::string> Result;
+  for (const std::vector<DotNode *> &SCC : SCCs) {
+    std::set<std::string> Names;
+    for (DotNode *Node : SCC)
+      Names.insert(Node->getName().str());
+
+    std::string Name;
+    for (const std::string &NodeName : Names)
+      Name += (Name.empty() ? "" : ",") + NodeName;
+    Result.insert(Name);
+  }
+  return Result;
+}
+
+static std::set<std::string> names(const SmallPtrSet<DotNode *, 4> &Nodes) {
+  std::set<std::string> Result;
+  for (DotNode *Node : Nodes)
+    Result.insert(Node->getName().str());
+  return Result;
+}
+
+static void parse(DotGraph &Graph, const char *Name) {
+  using namespace boost::unit_test::framework;
+  revng_check(master_test_suite().argc == 2);
+  std::string FileName = master_test_suite().argv[1];
+  FileName += Name;
+  Graph.parseDotFromFile(FileName, "initial_block");
+}
+
+BOOST_AUTO_TEST_CASE(TestDotGraphs) {
+  std::mt19937 Generator(42);
+  {
+    DotGraph Graph;
+    parse(Graph, "001.dot");
+    DotNode *Entry = Graph.getEntryNode();
+    DotNode *End = Graph.getNodeByName("end");
+    DotNode *False = Graph.getNodeByName("false");
+
+    using Names = std::set<std::string>;
+    revng_check(names(nodesBetween(Entry, End))
+                == Names({ "initial_block", "starter", "false", "end" }));
+    SmallPtrSet<DotNode *, 4> IgnoreList = { False };
+    revng_check(names(nodesBetween(Entry, End, &IgnoreList))
+                == Names({ "initial_block", "starter", "end" }));
+    revng_check(names(nodesBetweenReverse(End, Entry, &IgnoreList))
+                == Names({ "initial_block", "starter", "end" }));
+    revng_check(exitless_scc_range(Entry).empty());
+
+    checkAllPairs(Generator, Entry, Graph.nodes(), 50);
+  }
+
+  {
+    DotGraph Graph;
+    parse(Graph, "002.dot");
+    DotNode *Entry = Graph.getEntryNode();
+    DotNode *Exit = Graph.getNodeByName("exit");
+
+    using Names = std::set<std::string>;
+    revng_check(names(exitless_scc_range(Entry))
+                == Names({ "spin", "trap,trap_loop" }));
+    revng_check(names(nodesBetween(Entry, Exit))
+                == Names({ "initial_block", "header", "body", "latch", "exit" }));
+
+    checkAllPairs(Generator, Entry, Graph.nodes(), 50);
+  }
+}
@@ -0,0 +1,101 @@
+/// \file Instrumentation.cpp
+/// \brief Tests for phase timers and instrumentation counters
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <string>
+
+#define BOOST_TEST_MODULE Instrumentation
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/Assert.h"
+#include "revng/Support/Instrumentation.h"
+#include "revng/Support/Parallel.h"
+
+using namespace llvm;
+
+static InstrumentationCounter Visits("visits");
+
+static json::Value dump(InstrumentationFormat::Values Format) {
+  std::string Buffer;
+  raw_string_ostream Stream(Buffer);
+  writeInstrumentation(Stream, Format);
+  Stream.flush();
+
+  Expected<json::Value> Result = json::parse(Buffer);
+  revng_check(static_cast<bool>(Result));
+  return std::move(*Result);
+}
+
+static const json::Object *findPhase(const json::Array &Phases, StringRef Name) {
+  for (const json::Value &Phase : Phases)
+    if (*Phase.getAsObject()->getString("name") == Name)
+      return Phase.getAsObject();
+  return nullptr;
+}
+
+BOOST_AUTO_TEST_CASE(TestDisabled) {
+  // Nothing is recorded until instrumentation is enabled
+  revng_check(not isInstrumentationEnabled());
+  {
+    PhaseTimer Phase("disabled");
+    Visits.add();
+  }
+  revng_check(Visits.total() == 0);
+
+  json::Value Result = dump(InstrumentationFormat::JSON);
+  revng_check(Result.getAsObject()->getArray("phases")->empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestPhasesAndCounters) {
+  enableInstrumentation();
+
+  {
+    PhaseTimer Outer("outer");
+    {
+      PhaseTimer Inner("inner");
+      Visits.add();
+    }
+  }
+
+  // Each shard runs on its own thread
+  ParallelJobs = 4;
+  forEachShard(4000, [](size_t, size_t Begin, size_t End) {
+    for (size_t I = Begin; I < End; ++I)
+      Visits.add();
+  });
+  ParallelJobs = 0;
+
+  revng_check(Visits.total() == 4001);
+
+  json::Value Result = dump(InstrumentationFormat::JSON);
+  const json::Object *Root = Result.getAsObject();
+  revng_check(*Root->getObject("counters")->getInteger("visits") == 4001);
+
+  const json::Array *Phases = Root->getArray("phases");
+  revng_check(Phases->size() == 2);
+  const json::Object *Outer = findPhase(*Phases, "outer");
+  const json::Object *Inner = findPhase(*Phases, "inner");
+  revng_check(Outer != nullptr and Inner != nullptr);
+  revng_check(*Outer->getInteger("depth") == 0);
+  revng_check(*Inner->getInteger("depth") == 1);
+  revng_check(*Outer->getInteger("wall-us") >= *Inner->getInteger("wall-us"));
+  revng_check(*Inner->getInteger("peak-rss-kib") > 0);
+
+  // The outer phase comes first
+  revng_check(*(*Phases)[0].getAsObject()->getString("name") == "outer");
+
+  json::Value Trace = dump(InstrumentationFormat::ChromeTrace);
+  const json::Array *Events = Trace.getAsObject()->getArray("traceEvents");
+  revng_check(Events->size() == 3);
+  const json::Object *Counters = Events->back().getAsObject();
+  revng_check(*Counters->getString("ph") == "C");
+  revng_check(*Counters->getObject("args")->getInteger("visits") == 4001);
+  revng_check(*findPhase(*Events, "inner")->getString("ph") == "X");
+}
@@ -9,6 +9,9 @@
 bool init_unit_test();
 #include "boost/test/unit_test.hpp"
 
+#include <map>
+#include <random>
+
 #include "revng/ADT/MutableSet.h"
 #include "revng/ADT/SortedVector.h"
 #include "revng/Support/Assert.h"
@@ -201,3 +204,71 @@ BOOST_AUTO_TEST_CASE(TestUniqueLast) {
   Vector Expected = { { 1, 3 }, { 2, 3 } };
   revng_check(TheVector == Expected);
 }
+
+BOOST_AUTO_TEST_CASE(TestGallopingLowerBound) {
+  std::vector<int> Values;
+  for (int I = 0; I < 100; ++I)
+    Values.push_back(I * 2);
+
+  for (int Value = -1; Value < 202; ++Value) {
+    auto Expected = std::lower_bound(Values.begin(), Values.end(), Value);
+    auto Result = galloping_lower_bound(Values.begin(),
+                                        Values.end(),
+                                        Value,
+                                        std::less<int>());
+    revng_check(Result == Expected);
+  }
+}
+
+template<bool InsertOrAssign>
+static void testSortedVectorBatchMerge(unsigned Seed) {
+  std::mt19937 Generator(Seed);
+  std::uniform_int_distribution<uint64_t> Keys(0, 300);
+
+  SortedVector<Element> Set;
+  std::map<uint64_t, uint64_t> Reference;
+  uint64_t Counter = 0;
+
+  for (unsigned Round = 0; Round < 20; ++Round) {
+    // Alternate sorted and unsorted batches of different sizes
+    std::vector<uint64_t> Batch(Round * 7 % 50);
+    for (uint64_t &Key : Batch)
+      Key = Keys(Generator);
+    if (Round % 2 == 0)
+      std::sort(Batch.begin(), Batch.end());
+
+    if constexpr (InsertOrAssign) {
+      auto Inserter = Set.batch_insert_or_assign();
+      for (uint64_t Key : Batch) {
+        Inserter.insert_or_assign({ Key, ++Counter });
+        Reference[Key] = Counter;
+      }
+    } else {
+      auto Inserter = Set.batch_insert();
+      for (uint64_t Key : Batch) {
+        Inserter.insert({ Key, ++Counter });
+        Reference.insert({ Key, Counter });
+      }
+    }
+
+    revng_check(Set.size() == Reference.size());
+    auto It = Reference.begin();
+    for (const Element &E : Set) {
+      revng_check(E.key() == It->first and E.value() == It->second);
+      ++It;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSortedVectorBatchMerge) {
+  for (unsigned Seed = 0; Seed < 10; ++Seed) {
+    testSortedVectorBatchMerge<false>(Seed);
+    testSortedVectorBatchMerge<true>(Seed);
+  }
+
+  // Bulk construction from an unsorted range keeps the last duplicate
+  std::vector<Element> Elements{ { 3, 1 }, { 1, 1 }, { 3, 2 }, { 2, 1 } };
+  SortedVector<Element> Set(Elements.begin(), Elements.end());
+  SortedVector<Element> Expected{ { 1, 1 }, { 2, 1 }, { 3, 2 } };
+  revng_check(Set == Expected);
+}
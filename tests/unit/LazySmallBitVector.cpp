@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <random>
+#include <set>
 #include <vector>
 
 #define BOOST_TEST_MODULE LazySmallBitVector
@@ -219,3 +221,112 @@ BOOST_AUTO_TEST_CASE(TestIterator) {
   std::copy(A.begin(), A.end(), std::back_inserter(Results));
   BOOST_REQUIRE_EQUAL(Results, (std::vector<unsigned>{ 0, 16, 1000 }));
 }
+
+using BitsSet = std::set<unsigned>;
+
+static LazySmallBitVector fromSet(const BitsSet &Bits) {
+  LazySmallBitVector Result;
+  for (unsigned Bit : Bits)
+    Result.set(Bit);
+  return Result;
+}
+
+static BitsSet toSet(const LazySmallBitVector &BitVector) {
+  return BitsSet(BitVector.begin(), BitVector.end());
+}
+
+static BitsSet randomSet(std::mt19937 &Generator) {
+  // Mix small and large bit vectors
+  unsigned Range = (Generator() % 2 == 0) ? FirstLargeBit - 1 : 300;
+  std::uniform_int_distribution<unsigned> Distribution(0, Range - 1);
+  BitsSet Result;
+  unsigned Count = Generator() % 20;
+  for (unsigned I = 0; I < Count; ++I)
+    Result.insert(Distribution(Generator));
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestWordOperations) {
+  std::mt19937 Generator(42);
+  for (unsigned Iteration = 0; Iteration < 1000; ++Iteration) {
+    BitsSet ASet = randomSet(Generator);
+    BitsSet BSet = randomSet(Generator);
+
+    LazySmallBitVector A = fromSet(ASet);
+    LazySmallBitVector B = fromSet(BSet);
+    BOOST_TEST(toSet(A) == ASet);
+    BOOST_TEST(A.count() == ASet.size());
+
+    // isSubsetOf
+    bool Includes = std::includes(BSet.begin(),
+                                  BSet.end(),
+                                  ASet.begin(),
+                                  ASet.end());
+    BOOST_TEST(A.isSubsetOf(B) == Includes);
+
+    // orInPlaceChanged
+    BitsSet Union = ASet;
+    Union.insert(BSet.begin(), BSet.end());
+    LazySmallBitVector C = A;
+    BOOST_TEST(C.orInPlaceChanged(B) == (Union != ASet));
+    BOOST_TEST(toSet(C) == Union);
+    BOOST_TEST(not C.orInPlaceChanged(B));
+
+    // andNot
+    BitsSet Difference;
+    std::set_difference(ASet.begin(),
+                        ASet.end(),
+                        BSet.begin(),
+                        BSet.end(),
+                        std::inserter(Difference, Difference.end()));
+    LazySmallBitVector D = A;
+    D.andNot(B);
+    BOOST_TEST(toSet(D) == Difference);
+
+    // findNext
+    for (unsigned Start = 0; Start < 320; Start += 7) {
+      auto It = ASet.lower_bound(Start);
+      unsigned Expected = It == ASet.end() ? 0 : *It + 1;
+      BOOST_TEST(A.findNext(Start) == Expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestJoinUntilFixedPoint) {
+  // Join sparse bit vectors until nothing changes, as a monotone analysis
+  // would do, with and without orInPlaceChanged
+  const unsigned Size = 1 << 10;
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, Size - 1);
+  std::vector<LazySmallBitVector> BitVectors(8);
+  BitsSet Expected;
+  for (LazySmallBitVector &BitVector : BitVectors) {
+    for (unsigned I = 0; I < 8; ++I) {
+      unsigned Bit = Distribution(Generator);
+      BitVector.set(Bit);
+      Expected.insert(Bit);
+    }
+  }
+
+  LazySmallBitVector Accumulator;
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (const LazySmallBitVector &BitVector : BitVectors) {
+      LazySmallBitVector Old = Accumulator;
+      Accumulator |= BitVector;
+      Changed = Changed or Old != Accumulator;
+    }
+  }
+
+  LazySmallBitVector FusedAccumulator;
+  Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (const LazySmallBitVector &BitVector : BitVectors)
+      Changed = FusedAccumulator.orInPlaceChanged(BitVector) or Changed;
+  }
+
+  BOOST_TEST(Accumulator == FusedAccumulator);
+  BOOST_TEST(toSet(Accumulator) == Expected);
+}
@@ -0,0 +1,122 @@
+/// \file Logger.cpp
+/// \brief Tests for Logger and the debug output sink
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE Logger
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+
+#include "revng/Support/Debug.h"
+#include "revng/Support/Parallel.h"
+
+static Logger<true> TestLog("test-logger");
+static Logger<false> CompiledOutLog("test-compiled-out-logger");
+
+/// \brief Redirect stderr to a temporary file for the lifetime of the object
+class CaptureStderr {
+private:
+  std::FILE *File;
+  int OldStderr;
+
+public:
+  CaptureStderr() : File(std::tmpfile()), OldStderr(dup(2)) {
+    revng_check(File != nullptr and OldStderr != -1);
+    flushLogs();
+    dup2(fileno(File), 2);
+  }
+
+  ~CaptureStderr() {
+    flushLogs();
+    dup2(OldStderr, 2);
+    close(OldStderr);
+    std::fclose(File);
+  }
+
+  std::vector<std::string> lines(bool Flush = true) {
+    if (Flush)
+      flushLogs();
+
+    std::vector<std::string> Result;
+    std::rewind(File);
+    char Line[256];
+    while (std::fgets(Line, sizeof(Line), File) != nullptr)
+      Result.emplace_back(Line);
+    return Result;
+  }
+};
+
+static bool SideEffect = false;
+static int sideEffect() {
+  SideEffect = true;
+  return 0;
+}
+
+BOOST_AUTO_TEST_CASE(TestCompiledOut) {
+  // Enabling a compiled out logger is not an error
+  Loggers->enable("test-compiled-out-logger");
+  revng_check(not CompiledOutLog.isEnabled());
+
+  revng_log(CompiledOutLog, "Never evaluated: " << sideEffect());
+  revng_check(not SideEffect);
+}
+
+BOOST_AUTO_TEST_CASE(TestLinesOrder) {
+  CaptureStderr Capture;
+
+  ScopedDebugFeature Feature("test-logger", true);
+  revng_log(TestLog, "First line");
+  revng_log(TestLog, "Second line");
+
+  const unsigned Shards = 4;
+  const unsigned LinesPerShard = 200;
+  ParallelJobs = Shards;
+  forEachShard(Shards, [](size_t Shard, size_t, size_t) {
+    for (unsigned I = 0; I < LinesPerShard; ++I)
+      dbg << "shard " << Shard << " line " << I << "\n";
+  });
+  ParallelJobs = 0;
+
+  std::vector<std::string> Lines = Capture.lines();
+  revng_check(Lines.size() == 2 + Shards * LinesPerShard);
+  revng_check(Lines[0] == "[test-logger] First line\n");
+  revng_check(Lines[1] == "[test-logger] Second line\n");
+
+  // Lines of different threads can interleave, but each line must be intact
+  // and the lines of a thread must be in order
+  std::vector<unsigned> Next(Shards, 0);
+  for (const std::string &Line : llvm::drop_begin(Lines, 2)) {
+    std::istringstream Stream(Line);
+    std::string ShardWord, LineWord;
+    unsigned Shard, Index;
+    Stream >> ShardWord >> Shard >> LineWord >> Index;
+    revng_check(ShardWord == "shard" and LineWord == "line");
+    revng_check(Shard < Shards);
+    revng_check(Index == Next[Shard]);
+    ++Next[Shard];
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestFlushFromSignalHandler) {
+  CaptureStderr Capture;
+
+  ScopedDebugFeature Feature("test-logger", true);
+  revng_log(TestLog, "Before the signal");
+  flushLogsFromSignalHandler();
+
+  std::vector<std::string> Lines = Capture.lines(false);
+  revng_check(Lines.size() == 1);
+  revng_check(Lines[0] == "[test-logger] Before the signal\n");
+}
@@ -0,0 +1,90 @@
+/// \file MFP.cpp
+/// \brief Tests for TypeShrinking::getMaximalFixedPoint
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <map>
+#include <random>
+
+#define BOOST_TEST_MODULE MFP
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/TypeShrinking/MFP.h"
+
+#include "DistanceAnalysis.h"
+
+using namespace TypeShrinking;
+
+/// Chaotic iteration over all the nodes until nothing changes
+static std::map<DistanceNode *, uint32_t>
+naiveFixedPoint(DistanceGraph &Graph,
+                const std::vector<DistanceNode *> &ExtremalLabels) {
+  std::map<DistanceNode *, uint32_t> Result;
+  for (DistanceNode *Node : Graph.nodes())
+    Result[Node] = 0;
+  for (DistanceNode *Node : ExtremalLabels)
+    Result[Node] = 1;
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (DistanceNode *Node : Graph.nodes()) {
+      auto Out = DistanceAnalysis::applyTransferFunction(Node, Result[Node]);
+      for (DistanceNode *Successor : Node->successors()) {
+        if (not DistanceAnalysis::isLessOrEqual(Out, Result[Successor])) {
+          Result[Successor] = DistanceAnalysis::combineValues(Result[Successor],
+                                                              Out);
+          Changed = true;
+        }
+      }
+    }
+  }
+
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestAgainstNaive) {
+  std::mt19937 Generator(42);
+  for (unsigned Size : { 1, 2, 10, 100, 1000 }) {
+    DistanceGraph Graph = createGraph(Generator, Size);
+    std::vector<DistanceNode *> ExtremalLabels;
+    for (DistanceNode *Node : Graph.nodes())
+      if (Node->Index % 50 == 0)
+        ExtremalLabels.push_back(Node);
+
+    auto Reference = naiveFixedPoint(Graph, ExtremalLabels);
+    auto Results = getMaximalFixedPoint<DistanceAnalysis>(&Graph,
+                                                          0,
+                                                          1,
+                                                          ExtremalLabels);
+
+    revng_check(Results.size() == Size);
+    for (auto &[Label, Result] : Results) {
+      revng_check(Result.InValue == Reference.at(Label));
+      revng_check(Result.OutValue
+                  == DistanceAnalysis::applyTransferFunction(Label,
+                                                             Result.InValue));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestDensePriorityWorklist) {
+  DensePriorityWorklist Worklist(200);
+  revng_check(Worklist.empty());
+
+  Worklist.push(150);
+  Worklist.push(3);
+  Worklist.push(70);
+  Worklist.push(3);
+  revng_check(Worklist.pop() == 3);
+
+  // Lower priorities pushed after a pop are still popped first
+  Worklist.push(1);
+  revng_check(Worklist.pop() == 1);
+  revng_check(Worklist.pop() == 70);
+  revng_check(Worklist.pop() == 150);
+  revng_check(Worklist.empty());
+}
@@ -10,7 +10,10 @@ bool init_unit_test();
 #include "boost/test/unit_test.hpp"
 
 #include "revng/Model/Binary.h"
+#include "revng/Model/BinaryIndexes.h"
 #include "revng/Model/TupleTreeDiff.h"
+#include "revng/Model/TypedTupleTreePath.h"
+#include "revng/Support/Parallel.h"
 
 using namespace model;
 
@@ -204,6 +207,275 @@ BOOST_AUTO_TEST_CASE(TestTupleTreeDiff) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestTypedTupleTreePath) {
+  using FunctionPath = TypedTupleTreePath<Binary,
+                                          TupleFieldStep<0>,
+                                          ContainerKeyStep>;
+  using BlockEndPath = TypedTupleTreePath<Binary,
+                                          TupleFieldStep<0>,
+                                          ContainerKeyStep,
+                                          TupleFieldStep<3>,
+                                          ContainerKeyStep,
+                                          TupleFieldStep<1>>;
+  static_assert(std::is_same_v<FunctionPath::type, Function>);
+  static_assert(std::is_same_v<BlockEndPath::type, MetaAddress>);
+  static_assert(std::is_same_v<BlockEndPath::keys_type,
+                               std::tuple<MetaAddress, MetaAddress>>);
+
+  TupleTree<Binary> Model;
+  Function &F = Model->Functions[ARM1000];
+  BasicBlock &Block = F.CFG[ARM2000];
+
+  // Resolution
+  revng_check(FunctionPath(ARM1000).resolve(*Model) == &F);
+  revng_check(FunctionPath(ARM2000).resolve(*Model) == nullptr);
+  revng_check(BlockEndPath(ARM1000, ARM2000).resolve(*Model) == &Block.End);
+  revng_check(BlockEndPath(ARM1000, ARM3000).resolve(*Model) == nullptr);
+
+  // Conversion from and to TupleTreePath
+  auto Path = stringAsPath<Binary>("/Functions/0x1000:Code_arm/CFG/"
+                                   "0x2000:Code_arm/End");
+  revng_check(BlockEndPath(ARM1000, ARM2000).toPath() == Path.value());
+  auto MaybeTyped = BlockEndPath::fromPath(Path.value());
+  revng_check(MaybeTyped and *MaybeTyped == BlockEndPath(ARM1000, ARM2000));
+  revng_check(not FunctionPath::fromPath(Path.value()));
+
+  // Caching: reading through a const TupleTree keeps the cache, misses are
+  // not cached
+  const TupleTree<Binary> &ReadOnlyModel = Model;
+  TupleTreePathCache<FunctionPath> Cache;
+  revng_check(Cache.get(ReadOnlyModel, FunctionPath(ARM1000)) == &F);
+  revng_check(Cache.get(ReadOnlyModel, FunctionPath(ARM3000)) == nullptr);
+  revng_check(Cache.size() == 1);
+  revng_check(ReadOnlyModel->Functions.size() == 1);
+  revng_check(Cache.get(ReadOnlyModel, FunctionPath(ARM1000)) == &F);
+  revng_check(Cache.size() == 1);
+
+  // Writing through the TupleTree drops the cache
+  Function &NewF = Model->Functions[ARM3000];
+  revng_check(Cache.get(ReadOnlyModel, FunctionPath(ARM3000)) == &NewF);
+  revng_check(Cache.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestBinaryIndexes) {
+  using namespace model::FunctionEdgeType;
+  using EdgePointer = UpcastablePointer<FunctionEdge>;
+
+  auto AddFunction = [](Binary &TheBinary,
+                        MetaAddress Entry,
+                        MetaAddress Callee) {
+    Function &F = TheBinary.Functions[Entry];
+    F.Type = FunctionType::Regular;
+    BasicBlock &Block = F.CFG[Entry];
+    Block.End = Entry + 0x10;
+    Block.Successors.insert(EdgePointer::make<CallEdge>(Callee, FunctionCall));
+  };
+
+  TupleTree<Binary> Model;
+  AddFunction(*Model, ARM1000, ARM3000);
+  AddFunction(*Model, ARM2000, ARM3000);
+  AddFunction(*Model, ARM3000, ARM1000);
+
+  BinaryIndexes Indexes(Model);
+
+  // Call sites
+  using CallSite = BinaryIndexes::CallSite;
+  BinaryIndexes::CallSitesSet Expected{ CallSite{ ARM1000, ARM1000 },
+                                        CallSite{ ARM2000, ARM2000 } };
+  revng_check(Indexes.callSites(ARM3000) == Expected);
+  revng_check(Indexes.callSites(ARM2000).empty());
+
+  // Address ranges
+  revng_check(Indexes.functionsAt(ARM1000 + 4).count(ARM1000) == 1);
+  revng_check(Indexes.functionsAt(ARM1000 + 0x10).empty());
+
+  // Incremental update: drop the function at 0x2000. Read the model through a
+  // const reference, so that the diff is its only mutation.
+  const TupleTree<Binary> &ReadOnlyModel = Model;
+  Binary OldModel = *ReadOnlyModel;
+  Binary NewModel = *ReadOnlyModel;
+  NewModel.Functions.erase(ARM2000);
+  auto Diff = diff(OldModel, NewModel);
+  uint64_t Generation = Model.generation();
+  Diff.apply(Model);
+  revng_check(Model.previousGeneration() == Generation);
+  Indexes.update(Diff);
+
+  Expected.erase(CallSite{ ARM2000, ARM2000 });
+  revng_check(Indexes.callSites(ARM3000) == Expected);
+  revng_check(Indexes.functionsAt(ARM2000 + 4).empty());
+  revng_check(Indexes.functionsAt(ARM1000 + 4).count(ARM1000) == 1);
+
+  // Writing through the model without a diff, the indexes are rebuilt
+  AddFunction(*Model, ARM2000, ARM3000);
+  Expected.insert(CallSite{ ARM2000, ARM2000 });
+  revng_check(Indexes.callSites(ARM3000) == Expected);
+  revng_check(Indexes.functionsAt(ARM2000 + 4).count(ARM2000) == 1);
+
+  Model->Functions.erase(ARM1000);
+  Expected.erase(CallSite{ ARM1000, ARM1000 });
+  revng_check(Indexes.callSites(ARM3000) == Expected);
+  revng_check(Indexes.functionsAt(ARM1000 + 4).empty());
+
+  // Reading the model through a const reference doesn't invalidate them
+  Generation = Model.generation();
+  revng_check(ReadOnlyModel->Functions.size() == 2);
+  revng_check(Model.generation() == Generation);
+}
+
+BOOST_AUTO_TEST_CASE(TestTupleTreeGenerations) {
+  TupleTree<Binary> Model;
+  const TupleTree<Binary> &ReadOnlyModel = Model;
+
+  // Each mutable access changes the generation, const ones don't
+  uint64_t Initial = Model.generation();
+  revng_check(ReadOnlyModel->Functions.empty());
+  revng_check(Model.generation() == Initial);
+  Model->Functions[ARM1000];
+  revng_check(Model.generation() != Initial);
+  revng_check(Model.previousGeneration() == Initial);
+
+  // Generations are never shared among trees
+  TupleTree<Binary> Other;
+  revng_check(Other.generation() != Model.generation());
+  revng_check(Other.generation() != Initial);
+}
+
+BOOST_AUTO_TEST_CASE(TestShardedVerification) {
+  using namespace model::FunctionEdgeType;
+  using EdgePointer = UpcastablePointer<FunctionEdge>;
+  using Failure = Binary::VerificationFailure;
+
+  auto AddFunction = [](Binary &TheBinary, uint64_t Index, bool Broken) {
+    auto Entry = ARM1000 + Index * 0x10;
+    Function &F = TheBinary.Functions[Entry];
+    F.Type = FunctionType::Regular;
+    BasicBlock &Block = F.CFG[Entry];
+    Block.End = Entry + 0x10;
+    auto Invalid = MetaAddress::invalid();
+    Block.Successors.insert(EdgePointer::make<FunctionEdge>(Invalid, Return));
+
+    // Call a function that does not exist
+    if (Broken) {
+      auto Missing = ARM1000 + 0x100000;
+      Block.Successors.insert(EdgePointer::make<CallEdge>(Missing,
+                                                          FunctionCall));
+    }
+    return Entry;
+  };
+
+  unsigned OldThreads = ParallelJobs;
+  ParallelJobs = 4;
+
+  // Small models are verified in a single shard
+  {
+    Binary Small;
+    for (uint64_t I = 0; I < 10; ++I)
+      AddFunction(Small, I, false);
+    auto Broken = AddFunction(Small, 10, true);
+    revng_check(not Small.verify());
+    std::vector<Failure> Expected = { { 0, Broken } };
+    revng_check(Small.verificationFailures() == Expected);
+  }
+
+  // 256 functions are split in 4 shards of 64 functions
+  {
+    Binary Large;
+    std::vector<Failure> Expected;
+    for (uint64_t I = 0; I < 256; ++I) {
+      bool Broken = (I == 10 or I == 200 or I == 201);
+      auto Entry = AddFunction(Large, I, Broken);
+      if (Broken)
+        Expected.push_back({ I / 64, Entry });
+    }
+
+    revng_check(Large.verificationFailures() == Expected);
+    revng_check(not Large.verify());
+  }
+
+  // A valid model has no failures
+  {
+    Binary Valid;
+    for (uint64_t I = 0; I < 256; ++I)
+      AddFunction(Valid, I, false);
+    revng_check(Valid.verificationFailures().empty());
+    revng_check(Valid.verify());
+  }
+
+  ParallelJobs = OldThreads;
+}
+
+/// Build a model with CFG edges and check lookup, copy and YAML round-trip,
+/// with enough functions for serialization to be sharded
+BOOST_AUTO_TEST_CASE(TestModelRoundTrip) {
+  using namespace model::FunctionEdgeType;
+
+  constexpr uint64_t FunctionsCount = 130;
+  constexpr uint64_t BlocksPerFunction = 2;
+  constexpr uint64_t BlockSize = 0x10;
+  using EdgePointer = UpcastablePointer<FunctionEdge>;
+
+  TupleTree<Binary> Model;
+  for (uint64_t I = 0; I < FunctionsCount; ++I) {
+    auto Entry = ARM1000 + I * BlocksPerFunction * BlockSize;
+    Function &F = Model->Functions[Entry];
+    F.Type = FunctionType::Regular;
+    for (uint64_t J = 0; J < BlocksPerFunction; ++J) {
+      auto Start = Entry + J * BlockSize;
+      BasicBlock &Block = F.CFG[Start];
+      Block.End = Start + BlockSize;
+      auto Inserter = Block.Successors.batch_insert();
+      Inserter.insert(EdgePointer::make<FunctionEdge>(Block.End,
+                                                      DirectBranch));
+      Inserter.insert(EdgePointer::make<FunctionEdge>(Entry, DirectBranch));
+      Inserter.insert(EdgePointer::make<CallEdge>(ARM3000, FunctionCall));
+      Inserter.insert(EdgePointer::make<CallEdge>(MetaAddress::invalid(),
+                                                  IndirectCall));
+    }
+  }
+
+  size_t CallEdges = 0;
+  for (const Function &F : Model->Functions) {
+    for (const BasicBlock &Block : F.CFG) {
+      auto It = Block.Successors.find({ ARM3000, FunctionCall });
+      revng_check(It != Block.Successors.end());
+      if (llvm::isa<CallEdge>(It->get()))
+        ++CallEdges;
+    }
+  }
+  revng_check(CallEdges == FunctionsCount * BlocksPerFunction);
+
+  Binary Copy = *Model;
+  revng_check(Copy.Functions == Model->Functions);
+
+  std::string Buffer;
+  Model.serialize(Buffer);
+
+  // Sharded serialization must produce exactly what the plain YAML serializer
+  // produces
+  {
+    unsigned OldThreads = ParallelJobs;
+    ParallelJobs = 4;
+
+    std::string ShardedBuffer;
+    Model.serialize(ShardedBuffer);
+
+    std::string SerialBuffer;
+    {
+      llvm::raw_string_ostream Stream(SerialBuffer);
+      serialize(Stream, *Model);
+    }
+
+    revng_check(ShardedBuffer == SerialBuffer);
+    revng_check(ShardedBuffer == Buffer);
+
+    ParallelJobs = OldThreads;
+  }
+
+  auto Deserialized = TupleTree<Binary>::deserialize(Buffer);
+  revng_check(Deserialized->Functions == Model->Functions);
+}
+
 static_assert(std::is_default_constructible_v<TupleTree<TestTupleTree::Root>>);
 static_assert(not std::is_copy_assignable_v<TupleTree<TestTupleTree::Root>>);
 static_assert(not std::is_copy_constructible_v<TupleTree<TestTupleTree::Root>>);
@@ -0,0 +1,273 @@
+/// \file MonotoneFramework.cpp
+/// \brief Tests for MonotoneFramework and DenseStateMap
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE MonotoneFramework
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/Support/MonotoneFramework.h"
+
+#include "ReachingLabels.h"
+
+struct Node {
+  int Index;
+  std::vector<Node *> Successors;
+};
+
+/// Same as ReachingLabels, but with a breadth first visit on pointer labels
+class BreadthFirstReachingLabels
+  : public MonotoneFramework<BreadthFirstReachingLabels,
+                             Node *,
+                             LabelsSet,
+                             BreadthFirst,
+                             const std::vector<Node *> &> {
+private:
+  using Base = MonotoneFramework<BreadthFirstReachingLabels,
+                                 Node *,
+                                 LabelsSet,
+                                 BreadthFirst,
+                                 const std::vector<Node *> &>;
+
+public:
+  BreadthFirstReachingLabels(Node *Entry) : Base(Entry) {
+    registerExtremal(Entry);
+  }
+
+public:
+  LabelsSet extremalValue(Node *) const { return LabelsSet(); }
+
+  void assertLowerThanOrEqual(const LabelsSet &A, const LabelsSet &B) const {
+    revng_assert(A.lowerThanOrEqual(B));
+  }
+
+  void dumpFinalState() const {}
+
+  DefaultInterrupt<LabelsSet> transfer(Node *L) {
+    LabelsSet Result = State[L].copy();
+    Result.insert(L->Index);
+    return DefaultInterrupt<LabelsSet>::createInterrupt(std::move(Result));
+  }
+
+  llvm::Optional<LabelsSet> handleEdge(const LabelsSet &, Node *, Node *) {
+    return llvm::None;
+  }
+
+  const std::vector<Node *> &
+  successors(Node *L, DefaultInterrupt<LabelsSet> &) const {
+    return L->Successors;
+  }
+
+  size_t successor_size(Node *L, DefaultInterrupt<LabelsSet> &) const {
+    return L->Successors.size();
+  }
+
+  size_t reachingCount(Node *L) { return State[L].size(); }
+};
+
+/// Longest distance of a label from the entry, top if unbounded
+class Distance {
+private:
+  static constexpr unsigned Infinity = std::numeric_limits<unsigned>::max();
+  unsigned Value = 0;
+
+public:
+  static Distance bottom() { return Distance(); }
+  static Distance top() {
+    Distance Result;
+    Result.Value = Infinity;
+    return Result;
+  }
+  Distance copy() const { return *this; }
+
+public:
+  void combine(const Distance &Other) { Value = std::max(Value, Other.Value); }
+
+  bool lowerThanOrEqual(const Distance &Other) const {
+    return Value <= Other.Value;
+  }
+
+  bool isTop() const { return Value == Infinity; }
+  unsigned value() const { return Value; }
+
+  Distance next() const {
+    Distance Result;
+    Result.Value = isTop() ? Infinity : Value + 1;
+    return Result;
+  }
+};
+
+/// Compute the longest distance of each label from the entry, which does not
+/// converge in presence of loops unless it's widened
+class DistanceFromEntry : public MonotoneFramework<DistanceFromEntry,
+                                                   Node *,
+                                                   Distance,
+                                                   BreadthFirst,
+                                                   const std::vector<Node *> &> {
+private:
+  using Base = MonotoneFramework<DistanceFromEntry,
+                                 Node *,
+                                 Distance,
+                                 BreadthFirst,
+                                 const std::vector<Node *> &>;
+
+public:
+  DistanceFromEntry(Node *Entry) : Base(Entry) { registerExtremal(Entry); }
+
+public:
+  Distance extremalValue(Node *) const { return Distance(); }
+
+  void assertLowerThanOrEqual(const Distance &A, const Distance &B) const {
+    revng_assert(A.lowerThanOrEqual(B));
+  }
+
+  void widen(Node *, const Distance &, Distance &Current) {
+    Current = Distance::top();
+  }
+
+  void dumpFinalState() const {}
+
+  DefaultInterrupt<Distance> transfer(Node *L) {
+    return DefaultInterrupt<Distance>::createInterrupt(State[L].next());
+  }
+
+  llvm::Optional<Distance> handleEdge(const Distance &, Node *, Node *) {
+    return llvm::None;
+  }
+
+  const std::vector<Node *> &
+  successors(Node *L, DefaultInterrupt<Distance> &) const {
+    return L->Successors;
+  }
+
+  size_t successor_size(Node *L, DefaultInterrupt<Distance> &) const {
+    return L->Successors.size();
+  }
+
+  const Distance &distance(Node *L) { return State[L]; }
+};
+
+/// A chain of \p Size nodes, with an edge from the last one to \p LoopStart
+static std::vector<Node> createChain(int Size, int LoopStart = -1) {
+  std::vector<Node> Result(Size);
+  for (int I = 0; I < Size; ++I) {
+    Result[I].Index = I;
+    if (I + 1 < Size)
+      Result[I].Successors.push_back(&Result[I + 1]);
+  }
+
+  if (LoopStart >= 0)
+    Result.back().Successors.push_back(&Result[LoopStart]);
+
+  return Result;
+}
+
+BOOST_AUTO_TEST_CASE(TestNoLoops) {
+  std::vector<Node> Nodes = createChain(10);
+  DistanceFromEntry Analysis(&Nodes[0]);
+  Analysis.setIterationsBudget(100);
+  Analysis.setWideningThreshold(2);
+  Analysis.initialize();
+  Analysis.run();
+
+  for (int I = 0; I < 10; ++I)
+    revng_check(Analysis.distance(&Nodes[I]).value() == unsigned(I));
+  revng_check(Analysis.telemetry().Visits == 10);
+  revng_check(Analysis.telemetry().Widenings == 0);
+  revng_check(not Analysis.telemetry().BudgetExhausted);
+}
+
+BOOST_AUTO_TEST_CASE(TestWidening) {
+  std::vector<Node> Nodes = createChain(10, 5);
+  DistanceFromEntry Analysis(&Nodes[0]);
+  Analysis.setWideningThreshold(3);
+  Analysis.initialize();
+  Analysis.run();
+
+  // The labels before the loop are exact, the ones in the loop are widened
+  for (int I = 0; I < 5; ++I)
+    revng_check(Analysis.distance(&Nodes[I]).value() == unsigned(I));
+  for (int I = 5; I < 10; ++I)
+    revng_check(Analysis.distance(&Nodes[I]).isTop());
+  revng_check(Analysis.telemetry().Widenings > 0);
+  revng_check(not Analysis.telemetry().BudgetExhausted);
+}
+
+BOOST_AUTO_TEST_CASE(TestIterationsBudget) {
+  std::vector<Node> Nodes = createChain(10, 5);
+  DistanceFromEntry Analysis(&Nodes[0]);
+  Analysis.setIterationsBudget(30);
+  Analysis.initialize();
+  Analysis.run();
+
+  revng_check(Analysis.telemetry().BudgetExhausted);
+  revng_check(Analysis.telemetry().Visits <= 30 + 10);
+  for (int I = 0; I < 5; ++I)
+    revng_check(Analysis.distance(&Nodes[I]).value() == unsigned(I));
+  for (int I = 5; I < 10; ++I)
+    revng_check(Analysis.distance(&Nodes[I]).isTop());
+
+  // Once reset, the analysis runs within the budget again
+  Analysis.initialize();
+  revng_check(not Analysis.telemetry().BudgetExhausted);
+}
+
+BOOST_AUTO_TEST_CASE(TestGrowingStateMap) {
+  using Map = DenseStateMap<int *, int, GrowingLabelIndex<int *>>;
+  std::vector<int> Labels(100);
+  Map State(std::make_shared<GrowingLabelIndex<int *>>());
+
+  // Insert in reverse order, growing the index
+  for (int I = 99; I >= 0; --I)
+    if (I % 3 == 0)
+      State.insert_or_assign(&Labels[I], I);
+
+  revng_check(State.size() == 34);
+  for (int I = 0; I < 100; ++I) {
+    auto It = State.find(&Labels[I]);
+    revng_check((It != State.end()) == (I % 3 == 0));
+    if (It != State.end())
+      revng_check(It->second == I);
+  }
+
+  int Sum = 0;
+  for (auto &[Label, Value] : State)
+    Sum += Value;
+  revng_check(Sum == 1683);
+
+  // Clearing retains the numbering
+  State.clear();
+  revng_check(State.empty());
+  State[&Labels[1]] = 1;
+  revng_check(State.size() == 1 and State.count(&Labels[1]) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestBreadthFirstMatchesReversePostOrder) {
+  std::mt19937 Generator(42);
+  for (int Size : { 1, 10, 200 }) {
+    Graph G = createGraph(Generator, Size);
+    Arena A;
+    std::vector<size_t> Expected = solve(G, A);
+
+    std::vector<Node> Nodes(Size);
+    for (int I = 0; I < Size; ++I) {
+      Nodes[I].Index = I;
+      for (int Successor : G.Successors[I])
+        Nodes[I].Successors.push_back(&Nodes[Successor]);
+    }
+
+    BreadthFirstReachingLabels Analysis(&Nodes[0]);
+    Analysis.initialize();
+    Analysis.run();
+    for (int I = 0; I < Size; ++I)
+      revng_check(Analysis.reachingCount(&Nodes[I]) == Expected[I]);
+  }
+}
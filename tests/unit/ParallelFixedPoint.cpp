@@ -0,0 +1,74 @@
+/// \file ParallelFixedPoint.cpp
+/// \brief Tests for solveIndependent on monotone frameworks
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE ParallelFixedPoint
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/Support/Parallel.h"
+
+#include "ReachingLabels.h"
+
+BOOST_AUTO_TEST_CASE(TestResultsOrder) {
+  std::vector<int> Roots;
+  for (int I = 0; I < 1000; ++I)
+    Roots.push_back(I);
+
+  Arena::Instances = 0;
+  auto Square = [](int Root, Arena &) { return Root * Root; };
+  std::vector<int> Result = solveIndependent<Arena>(Roots, Square, 4);
+
+  revng_check(Arena::Instances <= 4);
+  revng_check(Result.size() == Roots.size());
+  for (int I = 0; I < 1000; ++I)
+    revng_check(Result[I] == I * I);
+
+  // No roots
+  revng_check(solveIndependent<Arena>(std::vector<int>(), Square).empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestParallelMatchesSerial) {
+  std::mt19937 Generator(42);
+  std::vector<Graph> Graphs;
+  for (int I = 0; I < 16; ++I)
+    Graphs.push_back(createGraph(Generator, 20 + (I * 37) % 100));
+
+  auto Serial = solveIndependent<Arena>(Graphs, solve, 1);
+  for (unsigned Threads : { 2, 3, 4 })
+    revng_check(solveIndependent<Arena>(Graphs, solve, Threads) == Serial);
+}
+
+BOOST_AUTO_TEST_CASE(TestNestedParallelism) {
+  // The pool of each thread is reused as long as it is large enough
+  llvm::ThreadPool &Pool = threadPool(4);
+  revng_check(&threadPool(2) == &Pool);
+
+  // Shards within a worker use the pool of the worker, waiting on it does
+  // not wait for the tasks of the outer pool
+  std::vector<int> Roots = { 1, 2, 3, 4 };
+  auto SumShards = [](int Root, Arena &) {
+    std::vector<size_t> Sums(4, 0);
+    forEachShard(Root * 100, 4, [&](size_t Shard, size_t Begin, size_t End) {
+      for (size_t I = Begin; I < End; ++I)
+        Sums[Shard] += I;
+    });
+
+    size_t Sum = 0;
+    for (size_t ShardSum : Sums)
+      Sum += ShardSum;
+    return Sum;
+  };
+
+  std::vector<size_t> Result = solveIndependent<Arena>(Roots, SumShards, 4);
+  for (size_t I = 0; I < Roots.size(); ++I) {
+    size_t Size = Roots[I] * 100;
+    revng_check(Result[I] == Size * (Size - 1) / 2);
+  }
+}
@@ -0,0 +1,99 @@
+/// \file Queue.cpp
+/// \brief Tests for UniquedQueue and OnceQueue
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE Queue
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "revng/ADT/Queue.h"
+
+namespace {
+
+/// A type with a custom dense numbering
+struct Block {
+  unsigned Index;
+  bool operator<(const Block &Other) const { return Index < Other.Index; }
+  bool operator==(const Block &Other) const = default;
+};
+
+} // namespace
+
+template<>
+struct DenseQueueKey<Block> {
+  static constexpr bool IsDense = true;
+  static size_t toID(Block B) { return B.Index; }
+  static Block fromID(size_t ID) { return { static_cast<unsigned>(ID) }; }
+};
+
+static_assert(std::is_same_v<OnceQueue<Block>,
+                             DenseQueueImpl<Block, true, KeyNumbering<Block>>>);
+using PointerQueue = DenseQueueImpl<int *, false, InsertionNumbering<int *>>;
+static_assert(std::is_same_v<UniquedQueue<int *>, PointerQueue>);
+static_assert(std::is_same_v<OnceQueue<unsigned>, SetQueueImpl<unsigned, true>>);
+
+/// Perform the same random operations on a pointer and a set-backed queue
+template<bool Once>
+static void compareQueues() {
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Distribution(0, 299);
+  std::vector<int> Labels(300);
+
+  QueueImpl<int *, Once> Dense;
+  SetQueueImpl<int *, Once> Reference;
+  for (unsigned I = 0; I < 10000; ++I) {
+    if (Generator() % 3 != 0) {
+      int *Element = &Labels[Distribution(Generator)];
+      Dense.insert(Element);
+      Reference.insert(Element);
+    } else if (not Reference.empty()) {
+      revng_check(Dense.pop() == Reference.pop());
+    }
+
+    revng_check(Dense.size() == Reference.size());
+    revng_check(Dense.empty() == Reference.empty());
+  }
+
+  while (not Reference.empty())
+    revng_check(Dense.pop() == Reference.pop());
+  revng_check(Dense.empty());
+
+  if constexpr (Once)
+    revng_check(Dense.visited() == Reference.visited());
+}
+
+BOOST_AUTO_TEST_CASE(TestUniquedQueue) {
+  compareQueues<false>();
+}
+
+BOOST_AUTO_TEST_CASE(TestOnceQueue) {
+  compareQueues<true>();
+}
+
+BOOST_AUTO_TEST_CASE(TestCustomKey) {
+  OnceQueue<Block> Queue;
+  Queue.insert({ 1000 });
+  Queue.insert({ 3 });
+  Queue.insert({ 1000 });
+  revng_check(Queue.size() == 2);
+  revng_check(Queue.pop() == Block{ 1000 });
+
+  // Once popped, an element cannot be inserted again
+  Queue.insert({ 1000 });
+  revng_check(Queue.pop() == Block{ 3 });
+  revng_check(Queue.empty());
+
+  std::set<Block> Visited = Queue.visited();
+  revng_check(Visited.size() == 2);
+
+  // Clearing allows to reuse the queue
+  Queue.clear();
+  Queue.insert({ 1000 });
+  revng_check(Queue.size() == 1);
+}
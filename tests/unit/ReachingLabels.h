@@ -0,0 +1,108 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <atomic>
+#include <random>
+#include <vector>
+
+#include "revng/Support/MonotoneFramework.h"
+
+/// A graph whose nodes are numbered in reverse post order
+struct Graph {
+  std::vector<std::vector<int>> Successors;
+};
+
+using LabelsSet = UnionMonotoneSet<int>;
+
+/// For each label, collect the set of labels that can reach it
+class ReachingLabels : public MonotoneFramework<ReachingLabels,
+                                                int,
+                                                LabelsSet,
+                                                ReversePostOrder,
+                                                const std::vector<int> &> {
+private:
+  using Base = MonotoneFramework<ReachingLabels,
+                                 int,
+                                 LabelsSet,
+                                 ReversePostOrder,
+                                 const std::vector<int> &>;
+
+private:
+  const Graph &G;
+
+public:
+  ReachingLabels(const std::vector<int> &RPOT, const Graph &G) :
+    Base(RPOT), G(G) {
+    registerExtremal(0);
+  }
+
+public:
+  LabelsSet extremalValue(int) const { return LabelsSet(); }
+
+  void assertLowerThanOrEqual(const LabelsSet &A, const LabelsSet &B) const {
+    revng_assert(A.lowerThanOrEqual(B));
+  }
+
+  void dumpFinalState() const {}
+
+  DefaultInterrupt<LabelsSet> transfer(int L) {
+    LabelsSet Result = State[L].copy();
+    Result.insert(L);
+    return DefaultInterrupt<LabelsSet>::createInterrupt(std::move(Result));
+  }
+
+  llvm::Optional<LabelsSet> handleEdge(const LabelsSet &, int, int) {
+    return llvm::None;
+  }
+
+  const std::vector<int> &
+  successors(int L, DefaultInterrupt<LabelsSet> &) const {
+    return G.Successors[L];
+  }
+
+  size_t successor_size(int L, DefaultInterrupt<LabelsSet> &) const {
+    return G.Successors[L].size();
+  }
+
+  size_t reachingCount(int L) { return State[L].size(); }
+};
+
+inline Graph createGraph(std::mt19937 &Generator, int Size) {
+  Graph Result;
+  Result.Successors.resize(Size);
+  std::uniform_int_distribution<int> Distribution(0, Size - 1);
+  for (int I = 0; I < Size; ++I) {
+    // Fallthrough and a random, possibly backward, edge
+    if (I + 1 < Size)
+      Result.Successors[I].push_back(I + 1);
+    if (I % 4 == 0)
+      Result.Successors[I].push_back(Distribution(Generator));
+  }
+  return Result;
+}
+
+/// Per-thread state: the buffer for the RPO, reused across roots
+struct Arena {
+  static inline std::atomic<unsigned> Instances = 0;
+  std::vector<int> RPOT;
+
+  Arena() { ++Instances; }
+};
+
+inline std::vector<size_t> solve(const Graph &G, Arena &A) {
+  A.RPOT.clear();
+  for (int I = 0; I < static_cast<int>(G.Successors.size()); ++I)
+    A.RPOT.push_back(I);
+
+  ReachingLabels Analysis(A.RPOT, G);
+  Analysis.initialize();
+  Analysis.run();
+
+  std::vector<size_t> Result;
+  for (int I = 0; I < static_cast<int>(G.Successors.size()); ++I)
+    Result.push_back(Analysis.reachingCount(I));
+  return Result;
+}
@@ -17,9 +17,6 @@
 #include "DepthFirstVisit.h"
 #include "SimpleRecursiveCoroutine.h"
 
-size_t MaxDepth = 0;
-size_t Iterations = 0;
-
 int main(int, char *[]) {
 
   //
@@ -137,6 +134,31 @@ int main(int, char *[]) {
 
   std::cout << "Average: " << Average << std::endl;
 
+  //
+  // Destroy coroutines in a different order than they have been created in
+  //
+  {
+    auto *First = new RecursiveCoroutine<int>(get10());
+    RecursiveCoroutine<int> Second = get10();
+    revng_check(static_cast<int>(*First) == 10);
+    delete First;
+    RecursiveCoroutine<int> Third = get10();
+    revng_check(static_cast<int>(Second) + static_cast<int>(Third) == 20);
+  }
+
+  //
+  // Deep walks
+  //
+  Graph Tree = createBinaryTree(10);
+  Graph Chain = createChain(20000);
+#ifdef ITERATIVE
+  revng_check(iterativeCountNodes(Tree.root()) == (1 << 10) - 1);
+  revng_check(iterativeCountNodes(Chain.root()) == 20000);
+#else
+  revng_check(countNodes(Tree.root()) == (1 << 10) - 1);
+  revng_check(countNodes(Chain.root()) == 20000);
+#endif
+
   int Result = 0;
   accumulateSums(7, Result);
   std::cout << "Result: " << Result << std::endl;
@@ -0,0 +1,90 @@
+/// \file TypeShrinking.cpp
+/// \brief Tests for TypeShrinking
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#define BOOST_TEST_MODULE TypeShrinking
+bool init_unit_test();
+#include "boost/test/unit_test.hpp"
+
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include "revng/Support/IRHelpers.h"
+#include "revng/Support/Parallel.h"
+#include "revng/TypeShrinking/BitLiveness.h"
+#include "revng/TypeShrinking/TypeShrinking.h"
+#include "revng/UnitTestHelpers/LLVMTestHelpers.h"
+#include "revng/UnitTestHelpers/UnitTestHelpers.h"
+
+using namespace llvm;
+
+static const char *Body = R"LLVM(
+  %a = load i64, i64* @rax
+  %b = load i64, i64* @rdi
+  %sum = add i64 %a, %b
+  %masked = and i64 %sum, 255
+  store i64 %masked, i64* @rbx
+  %wide = add i64 %a, %b
+  store i64 %wide, i64* @rcx
+  ret void
+)LLVM";
+
+static void runFunctionPasses(Module &M) {
+  FunctionPassManager FPM;
+  FPM.addPass(TypeShrinking::TypeShrinkingPass());
+
+  FunctionAnalysisManager FAM;
+  FAM.registerPass([]() { return TypeShrinking::BitLivenessPass(); });
+
+  ModuleAnalysisManager MAM;
+  FAM.registerPass([&MAM] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+
+  PassBuilder PB;
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerModuleAnalyses(MAM);
+
+  for (Function &F : M)
+    if (not F.isDeclaration())
+      FPM.run(F, FAM);
+}
+
+BOOST_AUTO_TEST_CASE(TestModulePassMatchesFunctionPass) {
+  LLVMContext TestContext;
+  std::unique_ptr<Module> M = loadModule(TestContext, Body);
+
+  // Create many copies of main
+  Function *Main = M->getFunction("main");
+  for (unsigned I = 0; I < 32; ++I) {
+    ValueToValueMapTy VMap;
+    Function *Copy = CloneFunction(Main, VMap);
+    Copy->setName("main_" + std::to_string(I));
+  }
+
+  std::unique_ptr<Module> Reference = CloneModule(*M);
+  runFunctionPasses(*Reference);
+
+  ParallelJobs = 4;
+  legacy::PassManager PM;
+  PM.add(new TypeShrinking::TypeShrinkingModulePass());
+  PM.run(*M);
+  ParallelJobs = 0;
+
+  revng_check(not verifyModule(*M, &dbgs()));
+  revng_check(dumpToString(M.get()) == dumpToString(Reference.get()));
+
+  // The masked sum and the mask have been shrunk, the wide sum has not
+  Main = M->getFunction("main");
+  unsigned ShrunkOperations = 0;
+  for (Instruction &I : instructions(Main))
+    if (isa<BinaryOperator>(&I) and I.getType()->isIntegerTy(8))
+      ++ShrunkOperations;
+  revng_check(ShrunkOperations == 2);
+  revng_check(instructionByName(Main, "wide")->getType()->isIntegerTy(64));
+}
@@ -215,6 +215,73 @@ target_link_libraries(test_genericgraph
 add_test(NAME test_genericgraph COMMAND ./bin/test_genericgraph)
 set_tests_properties(test_genericgraph PROPERTIES LABELS "unit")
 
+#
+# test_frozengraph
+#
+
+revng_add_private_executable(test_frozengraph "${SRC}/FrozenGraph.cpp")
+target_compile_definitions(test_frozengraph
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_frozengraph
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_frozengraph
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_frozengraph COMMAND ./bin/test_frozengraph)
+set_tests_properties(test_frozengraph PROPERTIES LABELS "unit")
+
+#
+# test_graphalgorithms
+#
+
+revng_add_private_executable(test_graphalgorithms "${SRC}/GraphAlgorithms.cpp")
+target_compile_definitions(test_graphalgorithms
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_graphalgorithms
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_graphalgorithms
+  revngSupport
+  revngUnitTestHelpers
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_graphalgorithms COMMAND ./bin/test_graphalgorithms -- "${SRC}/test_graphs/")
+set_tests_properties(test_graphalgorithms PROPERTIES LABELS "unit")
+
+#
+# test_mfp
+#
+
+revng_add_private_executable(test_mfp "${SRC}/MFP.cpp")
+target_compile_definitions(test_mfp
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_mfp
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_mfp
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_mfp COMMAND ./bin/test_mfp)
+set_tests_properties(test_mfp PROPERTIES LABELS "unit")
+
+#
+# test_typeshrinking
+#
+
+revng_add_private_executable(test_typeshrinking "${SRC}/TypeShrinking.cpp")
+target_compile_definitions(test_typeshrinking
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_typeshrinking
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_typeshrinking
+  revngTypeShrinking
+  revngSupport
+  revngUnitTestHelpers
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_typeshrinking COMMAND ./bin/test_typeshrinking)
+set_tests_properties(test_typeshrinking PROPERTIES LABELS "unit")
+
 #
 # test_keyedobjectscontainers
 #
@@ -242,6 +309,7 @@ target_compile_definitions(test_model
 target_include_directories(test_model
   PRIVATE "${CMAKE_SOURCE_DIR}")
 target_link_libraries(test_model
+  revngModel
   revngSupport
   revngUnitTestHelpers
   Boost::unit_test_framework
@@ -285,6 +353,86 @@ target_link_libraries(test_upcastablepointer
 add_test(NAME test_upcastablepointer COMMAND ./bin/test_upcastablepointer)
 set_tests_properties(test_upcastablepointer PROPERTIES LABELS "unit")
 
+#
+# test_parallelfixedpoint
+#
+
+revng_add_private_executable(test_parallelfixedpoint "${SRC}/ParallelFixedPoint.cpp")
+target_compile_definitions(test_parallelfixedpoint
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_parallelfixedpoint
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_parallelfixedpoint
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_parallelfixedpoint COMMAND ./bin/test_parallelfixedpoint)
+set_tests_properties(test_parallelfixedpoint PROPERTIES LABELS "unit")
+
+#
+# test_monotoneframework
+#
+
+revng_add_private_executable(test_monotoneframework "${SRC}/MonotoneFramework.cpp")
+target_compile_definitions(test_monotoneframework
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_monotoneframework
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_monotoneframework
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_monotoneframework COMMAND ./bin/test_monotoneframework)
+set_tests_properties(test_monotoneframework PROPERTIES LABELS "unit")
+
+#
+# test_instrumentation
+#
+
+revng_add_private_executable(test_instrumentation "${SRC}/Instrumentation.cpp")
+target_compile_definitions(test_instrumentation
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_instrumentation
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_instrumentation
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_instrumentation COMMAND ./bin/test_instrumentation)
+set_tests_properties(test_instrumentation PROPERTIES LABELS "unit")
+
+#
+# test_logger
+#
+
+revng_add_private_executable(test_logger "${SRC}/Logger.cpp")
+target_compile_definitions(test_logger
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_logger
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_logger
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_logger COMMAND ./bin/test_logger)
+set_tests_properties(test_logger PROPERTIES LABELS "unit")
+
+#
+# test_queue
+#
+
+revng_add_private_executable(test_queue "${SRC}/Queue.cpp")
+target_compile_definitions(test_queue
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_queue
+  PRIVATE "${CMAKE_SOURCE_DIR}")
+target_link_libraries(test_queue
+  revngSupport
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_queue COMMAND ./bin/test_queue)
+set_tests_properties(test_queue PROPERTIES LABELS "unit")
+
 #
 # test_recursive_coroutines
 #
@@ -309,3 +457,24 @@ target_compile_definitions(test_recursive_coroutines_fallback PRIVATE DISABLE_RE
 
 add_recursive_coroutine_test(test_recursive_coroutines_iterative)
 target_compile_definitions(test_recursive_coroutines_iterative PRIVATE ITERATIVE)
+
+#
+# test_binaryfile
+#
+
+revng_add_private_executable(test_binaryfile
+  "${SRC}/BinaryFile.cpp"
+  "${CMAKE_SOURCE_DIR}/tools/revng-lift/BinaryFile.cpp")
+target_compile_definitions(test_binaryfile
+  PRIVATE "BOOST_TEST_DYN_LINK=1")
+target_include_directories(test_binaryfile
+  PRIVATE "${CMAKE_SOURCE_DIR}"
+          "${CMAKE_SOURCE_DIR}/tools/revng-lift")
+target_link_libraries(test_binaryfile
+  revngModel
+  revngSupport
+  revngUnitTestHelpers
+  Boost::unit_test_framework
+  ${LLVM_LIBRARIES})
+add_test(NAME test_binaryfile COMMAND ./bin/test_binaryfile)
+set_tests_properties(test_binaryfile PROPERTIES LABELS "unit")
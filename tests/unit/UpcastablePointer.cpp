@@ -5,6 +5,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <vector>
+
 #include "revng/ADT/UpcastablePointer.h"
 
 // clang-format off
@@ -47,6 +49,103 @@ static_assert(std::is_copy_constructible_v<UpcastablePointer<TestClass>>);
 static_assert(std::is_move_assignable_v<UpcastablePointer<TestClass>>);
 static_assert(std::is_move_constructible_v<UpcastablePointer<TestClass>>);
 
+class Base {
+public:
+  int Kind;
+
+public:
+  Base() : Kind(0) {}
+  Base(int Kind) : Kind(Kind) {}
+  bool operator==(const Base &) const = default;
+
+public:
+  static bool classof(const Base *B) { return B->Kind == 0; }
+};
+
+static unsigned DestroyedTrackers = 0;
+
+/// Counts how many times it has been destroyed
+struct DestructionTracker {
+  ~DestructionTracker() { ++DestroyedTrackers; }
+  bool operator==(const DestructionTracker &) const { return true; }
+};
+
+class Derived : public Base {
+public:
+  std::vector<int> Payload;
+  DestructionTracker Tracker;
+
+public:
+  Derived() : Base(1) {}
+  bool operator==(const Derived &) const = default;
+
+public:
+  static bool classof(const Base *B) { return B->Kind == 1; }
+};
+
+template<>
+struct concrete_types_traits<Base> {
+  using type = std::tuple<Derived, Base>;
+};
+
+// Concrete types are stored inline
+static_assert(sizeof(UpcastablePointer<Base>) > sizeof(Derived));
+static_assert(sizeof(UpcastablePointer<Base>) <= 2 * sizeof(Derived));
+
 int main() {
+  using Pointer = UpcastablePointer<Base>;
+
+  Pointer Null;
+  revng_check(Null.get() == nullptr);
+
+  Pointer A = Pointer::make<Derived>();
+  llvm::cast<Derived>(A.get())->Payload.push_back(42);
+
+  // Copy
+  Pointer B = A;
+  revng_check(A == B);
+  revng_check(A.get() != B.get());
+  revng_check(llvm::cast<Derived>(B.get())->Payload.size() == 1);
+
+  // Move
+  Pointer C = std::move(B);
+  revng_check(B.get() == nullptr);
+  revng_check(llvm::isa<Derived>(C.get()));
+
+  // Adopt an heap-allocated object
+  Pointer D(new Base);
+  revng_check(llvm::isa<Base>(D.get()));
+  revng_check(not(D == C));
+
+  // Adopt an heap-allocated object of a derived type: the original object
+  // must be destroyed as a Derived, even if Base has no virtual destructor
+  {
+    auto *Heap = new Derived;
+    Heap->Payload.push_back(43);
+    unsigned Before = DestroyedTrackers;
+    Pointer E(Heap);
+    revng_check(DestroyedTrackers == Before + 1);
+    revng_check(llvm::cast<Derived>(E.get())->Payload.size() == 1);
+    revng_check(llvm::cast<Derived>(E.get())->Payload[0] == 43);
+
+    E.reset(new Derived);
+    revng_check(DestroyedTrackers == Before + 3);
+    revng_check(llvm::cast<Derived>(E.get())->Payload.empty());
+  }
+
+  // Visit
+  int Visited = 0;
+  C.upcast([&Visited](auto &Upcasted) {
+    using type = std::remove_cvref_t<decltype(Upcasted)>;
+    Visited = std::is_same_v<type, Derived> ? 1 : 2;
+  });
+  revng_check(Visited == 1);
+
+  D.emplace<Derived>().Payload.push_back(42);
+  revng_check(D == A);
+
+  D.reset();
+  revng_check(D.get() == nullptr);
+
   return 0;
 }
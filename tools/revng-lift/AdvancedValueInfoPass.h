@@ -45,10 +45,15 @@ class AdvancedValueInfoPass
   : public llvm::PassInfoMixin<AdvancedValueInfoPass> {
 private:
   JumpTargetManager *JTM;
+  MaterializedValuesCache *Cache;
+  DisjointRanges::ConvergenceOptions Options;
   static constexpr const char *MarkerName = "revng_avi";
 
 public:
-  AdvancedValueInfoPass(JumpTargetManager *JTM) : JTM(JTM) {}
+  AdvancedValueInfoPass(JumpTargetManager *JTM,
+                        MaterializedValuesCache *Cache = nullptr,
+                        const DisjointRanges::ConvergenceOptions &Options = {}) :
+    JTM(JTM), Cache(Cache), Options(Options) {}
 
   llvm::PreservedAnalyses
   run(llvm::Function &F, llvm::FunctionAnalysisManager &);
@@ -114,7 +119,8 @@ AdvancedValueInfoPass::run(llvm::Function &F,
   BasicBlock *Dispatcher = Terminator->getDefaultDest();
 
   auto &SCEV = FAM.getResult<ScalarEvolutionAnalysis>(F);
-  AdvancedValueInfo<StaticDataMemoryOracle> AVI(LVI, SCEV, DT, MO, Dispatcher);
+  using AVIType = AdvancedValueInfo<StaticDataMemoryOracle>;
+  AVIType AVI(LVI, SCEV, DT, MO, Dispatcher, Cache, Options);
 
 #ifndef NDEBUG
   // Ensure that no instruction has itself as operand, except for phis
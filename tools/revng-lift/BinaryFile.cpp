@@ -5,6 +5,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <ios>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -12,6 +14,8 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/BinaryFormat/Dwarf.h"
@@ -24,9 +28,13 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/LEB128.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "revng/Support/CommandLine.h"
 #include "revng/Support/Debug.h"
+#include "revng/Support/Instrumentation.h"
+#include "revng/Support/Parallel.h"
 
 #include "BinaryFile.h"
 
@@ -42,6 +50,19 @@ static Logger<> LabelsLog("labels");
 
 const unsigned char R_MIPS_IMPLICIT_RELATIVE = 255;
 
+cl::opt<unsigned> BinaryFileShardSize("binary-file-shard-size",
+                                      cl::desc("minimum number of relocations "
+                                               "or .eh_frame entries parsed "
+                                               "by each thread"),
+                                      cl::init(4096),
+                                      cl::cat(MainCategory));
+
+/// \return the maximum number of shards to parse a table of \p Entries in
+static size_t maxShards(size_t Entries) {
+  size_t ShardSize = std::max(1U, BinaryFileShardSize.getValue());
+  return std::max<size_t>(1, Entries / ShardSize);
+}
+
 namespace nooverflow {
 
 template<typename T, typename U>
@@ -205,10 +226,21 @@ getInitialPC(Triple::ArchType Arch, bool Swap, ArrayRef<uint8_t> Command) {
 
 BinaryFile::BinaryFile(std::string FilePath, uint64_t PreferedBaseAddress) :
   EntryPoint(MetaAddress::invalid()), BaseAddress(0) {
-  auto BinaryOrErr = object::createBinary(FilePath);
-  revng_check(BinaryOrErr, "Couldn't open the input file");
+  PhaseTimer Timer("load-binary");
+
+  // Not requiring a null terminator ensures the file is mmap'd (unless it's
+  // tiny): all the segments are then ArrayRefs in the mapping, and only the
+  // pages actually accessed are read
+  auto BufferOrErr = MemoryBuffer::getFile(FilePath,
+                                           /* IsText */ false,
+                                           /* RequiresNullTerminator */ false);
+  revng_check(BufferOrErr, "Couldn't open the input file");
 
-  BinaryHandle = std::move(BinaryOrErr.get());
+  auto BinaryOrErr = object::createBinary(BufferOrErr.get()->getMemBufferRef());
+  revng_check(BinaryOrErr, "Couldn't parse the input file");
+
+  BinaryHandle = object::OwningBinary<object::Binary>(std::move(*BinaryOrErr),
+                                                      std::move(*BufferOrErr));
 
   auto *TheBinary = cast<object::ObjectFile>(BinaryHandle.getBinary());
 
@@ -572,28 +604,60 @@ BinaryFile::BinaryFile(std::string FilePath, uint64_t PreferedBaseAddress) :
     if (EntryPointOffset)
       EntryPoint = virtualAddressFromOffset(*EntryPointOffset).toPC(Arch);
 
-    const uint64_t PointerSize = TheArchitecture.pointerSize() / 8;
+    SymbolsParser = &BinaryFile::parseMachOBindings;
 
-    Error TheError = Error::success();
+  } else {
+    revng_assert("Unsupported file format.");
+  }
+}
 
-    for (const MachOBindEntry &U : MachO->bindTable(TheError))
-      registerBindEntry(&U, PointerSize);
-    revng_check(not TheError);
+void BinaryFile::ensureSymbolsParsed() const {
+  if (SymbolsParsed)
+    return;
 
-    for (const MachOBindEntry &U : MachO->lazyBindTable(TheError))
-      registerBindEntry(&U, PointerSize);
-    revng_check(not TheError);
+  // Lazily parsed information is not part of the observable state
+  auto *This = const_cast<BinaryFile *>(this);
+  This->SymbolsParsed = true;
 
-    // TODO: we should handle weak symbols
-    for (const MachOBindEntry &U : MachO->weakBindTable(TheError))
-      registerBindEntry(&U, PointerSize);
-    revng_check(not TheError);
+  PhaseTimer Timer("parse-symbols");
+  if (SymbolsParser != nullptr)
+    (This->*SymbolsParser)();
+  This->rebuildLabelsMap();
+}
 
-  } else {
-    revng_assert("Unsupported file format.");
-  }
+void BinaryFile::ensureExceptionHandlingParsed() const {
+  if (ExceptionHandlingParsed)
+    return;
 
-  rebuildLabelsMap();
+  auto *This = const_cast<BinaryFile *>(this);
+  This->ExceptionHandlingParsed = true;
+
+  PhaseTimer Timer("parse-exception-handling");
+  if (ExceptionHandlingParser != nullptr)
+    (This->*ExceptionHandlingParser)();
+}
+
+void BinaryFile::parseMachOBindings() {
+  using namespace llvm::MachO;
+  using namespace llvm::object;
+
+  auto *MachO = cast<MachOObjectFile>(BinaryHandle.getBinary());
+  const uint64_t PointerSize = TheArchitecture.pointerSize() / 8;
+
+  Error TheError = Error::success();
+
+  for (const MachOBindEntry &U : MachO->bindTable(TheError))
+    registerBindEntry(&U, PointerSize);
+  revng_check(not TheError);
+
+  for (const MachOBindEntry &U : MachO->lazyBindTable(TheError))
+    registerBindEntry(&U, PointerSize);
+  revng_check(not TheError);
+
+  // TODO: we should handle weak symbols
+  for (const MachOBindEntry &U : MachO->weakBindTable(TheError))
+    registerBindEntry(&U, PointerSize);
+  revng_check(not TheError);
 }
 
 void BinaryFile::registerBindEntry(const object::MachOBindEntry *Entry,
@@ -842,16 +906,141 @@ void BinaryFile::parseMachOSegment(ArrayRef<uint8_t> RawDataRef,
   Segments.push_back(Segment);
 }
 
-template<typename T, bool HasAddend>
-void BinaryFile::parseELF(object::ObjectFile *TheBinary,
-                          uint64_t PreferedBaseAddress) {
-  // Parse the ELF file
+template<typename T>
+static object::ELFFile<T> createELFFile(const object::ObjectFile *TheBinary) {
   auto TheELFOrErr = object::ELFFile<T>::create(TheBinary->getData());
   if (not TheELFOrErr) {
     logAllUnhandledErrors(TheELFOrErr.takeError(), errs(), "");
     revng_abort();
   }
-  object::ELFFile<T> &TheELF = *TheELFOrErr;
+  return std::move(*TheELFOrErr);
+}
+
+/// \brief The information collected from the .dynamic table
+struct DynamicInfo {
+  SmallVector<uint64_t, 10> NeededLibraryNameOffsets;
+  FilePortion DynstrPortion;
+  FilePortion DynsymPortion;
+  FilePortion ReldynPortion;
+  FilePortion RelpltPortion;
+  FilePortion GotPortion;
+  Optional<MetaAddress> GotAddress;
+  Optional<uint64_t> SymbolsCount;
+  Optional<uint64_t> MIPSFirstGotSymbol;
+  Optional<uint64_t> MIPSLocalGotEntries;
+};
+
+/// \brief Parse the .dynamic table, if any
+///
+/// The table is tiny, this is cheap enough to be done both upon loading and
+/// upon parsing symbols and relocations.
+template<typename T, bool HasAddend>
+static Optional<DynamicInfo> parseDynamic(const object::ELFFile<T> &TheELF,
+                                          const BinaryFile &Binary,
+                                          bool IsMIPS) {
+  using Elf_Phdr = const typename object::ELFFile<T>::Elf_Phdr;
+  using Elf_Dyn = const typename object::ELFFile<T>::Elf_Dyn;
+  using Elf_Addr = const typename object::ELFFile<T>::Elf_Addr;
+
+  auto ProgHeaders = TheELF.program_headers();
+  if (not ProgHeaders) {
+    logAllUnhandledErrors(std::move(ProgHeaders.takeError()), errs(), "");
+    revng_abort();
+  }
+
+  auto IsDynamic = [](Elf_Phdr &ProgramHeader) {
+    return ProgramHeader.p_type == ELF::PT_DYNAMIC;
+  };
+  if (llvm::none_of(*ProgHeaders, IsDynamic))
+    return {};
+
+  DynamicInfo Result;
+
+  auto DynamicEntries = TheELF.dynamicEntries();
+  if (not DynamicEntries) {
+    logAllUnhandledErrors(std::move(DynamicEntries.takeError()), errs(), "");
+    revng_abort();
+  }
+  for (Elf_Dyn &DynamicTag : *DynamicEntries) {
+
+    auto TheTag = DynamicTag.getTag();
+    MetaAddress Relocated = Binary.relocate(DynamicTag.getPtr());
+    switch (TheTag) {
+    case ELF::DT_NEEDED:
+      Result.NeededLibraryNameOffsets.push_back(DynamicTag.getVal());
+      break;
+
+    case ELF::DT_STRTAB:
+      Result.DynstrPortion.setAddress(Relocated);
+      break;
+
+    case ELF::DT_STRSZ:
+      Result.DynstrPortion.setSize(DynamicTag.getVal());
+      break;
+
+    case ELF::DT_SYMTAB:
+      Result.DynsymPortion.setAddress(Relocated);
+      break;
+
+    case ELF::DT_JMPREL:
+      Result.RelpltPortion.setAddress(Relocated);
+      break;
+
+    case ELF::DT_PLTRELSZ:
+      Result.RelpltPortion.setSize(DynamicTag.getVal());
+      break;
+
+    case ELF::DT_REL:
+    case ELF::DT_RELA:
+      revng_assert(TheTag == (HasAddend ? ELF::DT_RELA : ELF::DT_REL));
+      Result.ReldynPortion.setAddress(Relocated);
+      break;
+
+    case ELF::DT_RELSZ:
+    case ELF::DT_RELASZ:
+      revng_assert(TheTag == (HasAddend ? ELF::DT_RELASZ : ELF::DT_RELSZ));
+      Result.ReldynPortion.setSize(DynamicTag.getVal());
+      break;
+
+    case ELF::DT_PLTGOT:
+      Result.GotPortion.setAddress(Relocated);
+      Result.GotAddress = Relocated;
+      break;
+
+    case ELF::DT_MIPS_SYMTABNO:
+      if (IsMIPS)
+        Result.SymbolsCount = DynamicTag.getVal();
+      break;
+
+    case ELF::DT_MIPS_GOTSYM:
+      if (IsMIPS)
+        Result.MIPSFirstGotSymbol = DynamicTag.getVal();
+      break;
+
+    case ELF::DT_MIPS_LOCAL_GOTNO:
+      if (IsMIPS)
+        Result.MIPSLocalGotEntries = DynamicTag.getVal();
+      break;
+    }
+  }
+
+  // In MIPS the GOT has one entry per symbol
+  if (IsMIPS and Result.SymbolsCount and Result.MIPSFirstGotSymbol
+      and Result.MIPSLocalGotEntries) {
+    uint32_t GotEntries = (*Result.MIPSLocalGotEntries
+                           + (*Result.SymbolsCount
+                              - *Result.MIPSFirstGotSymbol));
+    Result.GotPortion.setSize(GotEntries * sizeof(Elf_Addr));
+  }
+
+  return Result;
+}
+
+template<typename T, bool HasAddend>
+void BinaryFile::parseELF(object::ObjectFile *TheBinary,
+                          uint64_t PreferedBaseAddress) {
+  // Parse the ELF file
+  object::ELFFile<T> TheELF = createELFFile<T>(TheBinary);
 
   // BaseAddress makes sense only for shared (relocatable, PIC) objects
   auto Type = TheELF.getHeader().e_type;
@@ -863,15 +1052,11 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
                "rev.ng currently handles executables and "
                "dynamic libraries only.");
 
-  // Look for static or dynamic symbols and relocations
-  using ConstElf_ShdrPtr = const typename object::ELFFile<T>::Elf_Shdr *;
+  // Look for .eh_frame and .dynamic. Symbols and relocations are parsed
+  // lazily, see parseELFSymbols.
   using Elf_PhdrPtr = const typename object::ELFFile<T>::Elf_Phdr *;
-  ConstElf_ShdrPtr SymtabShdr = nullptr;
   Elf_PhdrPtr DynamicPhdr = nullptr;
   Optional<MetaAddress> DynamicAddress;
-  Optional<MetaAddress> EHFrameAddress;
-  Optional<uint64_t> EHFrameSize;
-  Optional<MetaAddress> EHFrameHdrAddress;
 
   auto Sections = TheELF.sections();
   if (not Sections) {
@@ -881,14 +1066,10 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
       auto NameOrErr = TheELF.getSectionName(Section);
       if (NameOrErr) {
         auto &Name = *NameOrErr;
-        if (Name == ".symtab") {
-          // TODO: check dedicated field in section header
-          revng_assert(SymtabShdr == nullptr, "Duplicate .symtab");
-          SymtabShdr = &Section;
-        } else if (Name == ".eh_frame") {
-          revng_assert(not EHFrameAddress, "Duplicate .eh_frame");
-          EHFrameAddress = relocate(fromGeneric(Section.sh_addr));
-          EHFrameSize = static_cast<uint64_t>(Section.sh_size);
+        if (Name == ".eh_frame") {
+          revng_assert(not EHFrame.Address, "Duplicate .eh_frame");
+          EHFrame.Address = relocate(fromGeneric(Section.sh_addr));
+          EHFrame.Size = static_cast<uint64_t>(Section.sh_size);
         } else if (Name == ".dynamic") {
           revng_assert(not DynamicAddress, "Duplicate .dynamic");
           DynamicAddress = relocate(fromGeneric(Section.sh_addr));
@@ -897,54 +1078,6 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
     }
   }
 
-  // If we found a symbol table
-  if (SymtabShdr != nullptr && SymtabShdr->sh_link != 0) {
-    // Obtain a reference to the string table
-    auto Strtab = TheELF.getSection(SymtabShdr->sh_link);
-    if (not Strtab) {
-      logAllUnhandledErrors(std::move(Strtab.takeError()), errs(), "");
-      revng_abort();
-    }
-    auto StrtabArray = TheELF.getSectionContents(**Strtab);
-    if (not StrtabArray) {
-      logAllUnhandledErrors(std::move(StrtabArray.takeError()), errs(), "");
-      revng_abort();
-    }
-    StringRef StrtabContent(reinterpret_cast<const char *>(StrtabArray->data()),
-                            StrtabArray->size());
-
-    // Collect symbol names
-    auto ELFSymbols = TheELF.symbols(SymtabShdr);
-    if (not ELFSymbols) {
-      logAllUnhandledErrors(std::move(ELFSymbols.takeError()), errs(), "");
-      revng_abort();
-    }
-    for (auto &Symbol : *ELFSymbols) {
-      auto Name = Symbol.getName(StrtabContent);
-      if (not Name) {
-        logAllUnhandledErrors(std::move(Name.takeError()), errs(), "");
-        revng_abort();
-      }
-
-      auto SymbolType = SymbolType::fromELF(Symbol.getType());
-      if (shouldIgnoreSymbol(*Name) or Symbol.st_shndx == ELF::SHN_UNDEF)
-        continue;
-
-      MetaAddress Address = MetaAddress::invalid();
-
-      if (SymbolType == SymbolType::Code)
-        Address = relocate(fromPC(Symbol.st_value));
-      else
-        Address = relocate(fromGeneric(Symbol.st_value));
-
-      registerLabel(Label::createSymbol(LabelOrigin::StaticSymbol,
-                                        Address,
-                                        Symbol.st_size,
-                                        *Name,
-                                        SymbolType));
-    }
-  }
-
   const auto &ElfHeader = TheELF.getHeader();
   EntryPoint = relocate(fromPC(ElfHeader.e_entry));
   ProgramHeaders.Count = ElfHeader.e_phnum;
@@ -955,8 +1088,6 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
   // assign them a section and output information about them in the linking info
   // CSV
   using Elf_Phdr = const typename object::ELFFile<T>::Elf_Phdr;
-  using Elf_Dyn = const typename object::ELFFile<T>::Elf_Dyn;
-  using Elf_Addr = const typename object::ELFFile<T>::Elf_Addr;
 
   auto ProgHeaders = TheELF.program_headers();
   if (not ProgHeaders) {
@@ -1016,8 +1147,8 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
     } break;
 
     case ELF::PT_GNU_EH_FRAME:
-      revng_assert(!EHFrameHdrAddress);
-      EHFrameHdrAddress = relocate(fromGeneric(ProgramHeader.p_vaddr));
+      revng_assert(!EHFrame.HeaderAddress);
+      EHFrame.HeaderAddress = relocate(fromGeneric(ProgramHeader.p_vaddr));
       break;
 
     case ELF::PT_DYNAMIC:
@@ -1033,11 +1164,41 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
 
   revng_assert((DynamicPhdr != nullptr) == (DynamicAddress.hasValue()));
 
+  // Collect the needed libraries and the canonical values from the .dynamic
+  // table, they're required to set up the output module
+  bool IsMIPS = (TheArchitecture.type() == Triple::mips
+                 or TheArchitecture.type() == Triple::mipsel);
+  auto Dynamic = parseDynamic<T, HasAddend>(TheELF, *this, IsMIPS);
+  if (Dynamic) {
+    // Obtain the canonical value of the global pointer in MIPS
+    if (IsMIPS and Dynamic->GotAddress)
+      CanonicalValues["gp"] = (*Dynamic->GotAddress + 0x7ff0).address();
+
+    if (NeededLibraryNames.size() > 0)
+      revng_assert(Dynamic->DynstrPortion.isAvailable());
+
+    if (Dynamic->DynstrPortion.isAvailable()) {
+      StringRef Dynstr = Dynamic->DynstrPortion.extractString(Segments);
+      for (auto Offset : Dynamic->NeededLibraryNameOffsets) {
+        StringRef LibraryName = Dynstr.slice(Offset, Dynstr.size());
+        NeededLibraryNames.push_back(LibraryName.data());
+      }
+    }
+  }
+
+  SymbolsParser = &BinaryFile::parseELFSymbols<T, HasAddend>;
+  ExceptionHandlingParser = &BinaryFile::parseELFExceptionHandling<T>;
+}
+
+template<typename T>
+void BinaryFile::parseELFExceptionHandling() {
   Optional<uint64_t> FDEsCount;
-  if (EHFrameHdrAddress) {
+  Optional<MetaAddress> EHFrameAddress = EHFrame.Address;
+  if (EHFrame.HeaderAddress) {
     MetaAddress Address = MetaAddress::invalid();
 
-    std::tie(Address, FDEsCount) = ehFrameFromEhFrameHdr<T>(*EHFrameHdrAddress);
+    std::tie(Address,
+             FDEsCount) = ehFrameFromEhFrameHdr<T>(*EHFrame.HeaderAddress);
     if (EHFrameAddress) {
       revng_assert(*EHFrameAddress == Address);
     }
@@ -1046,114 +1207,98 @@ void BinaryFile::parseELF(object::ObjectFile *TheBinary,
   }
 
   if (EHFrameAddress)
-    parseEHFrame<T>(*EHFrameAddress, FDEsCount, EHFrameSize);
-
-  // Parse the .dynamic table
-  if (DynamicPhdr != nullptr) {
-    SmallVector<uint64_t, 10> NeededLibraryNameOffsets;
-
-    FilePortion DynstrPortion;
-    FilePortion DynsymPortion;
-    FilePortion ReldynPortion;
-    FilePortion RelpltPortion;
-    FilePortion GotPortion;
-    Optional<uint64_t> SymbolsCount;
-    Optional<uint64_t> MIPSFirstGotSymbol;
-    Optional<uint64_t> MIPSLocalGotEntries;
-    bool IsMIPS = (TheArchitecture.type() == Triple::mips
-                   or TheArchitecture.type() == Triple::mipsel);
-
-    auto DynamicEntries = TheELF.dynamicEntries();
-    if (not DynamicEntries) {
-      logAllUnhandledErrors(std::move(DynamicEntries.takeError()), errs(), "");
-      revng_abort();
-    }
-    for (Elf_Dyn &DynamicTag : *DynamicEntries) {
-
-      auto TheTag = DynamicTag.getTag();
-      MetaAddress Relocated = relocate(fromGeneric(DynamicTag.getPtr()));
-      switch (TheTag) {
-      case ELF::DT_NEEDED:
-        NeededLibraryNameOffsets.push_back(DynamicTag.getVal());
-        break;
-
-      case ELF::DT_STRTAB:
-        DynstrPortion.setAddress(Relocated);
-        break;
-
-      case ELF::DT_STRSZ:
-        DynstrPortion.setSize(DynamicTag.getVal());
-        break;
-
-      case ELF::DT_SYMTAB:
-        DynsymPortion.setAddress(Relocated);
-        break;
+    parseEHFrame<T>(*EHFrameAddress, FDEsCount, EHFrame.Size);
+}
 
-      case ELF::DT_JMPREL:
-        RelpltPortion.setAddress(Relocated);
-        break;
+template<typename T, bool HasAddend>
+void BinaryFile::parseELFSymbols() {
+  auto *TheBinary = cast<object::ObjectFile>(BinaryHandle.getBinary());
+  object::ELFFile<T> TheELF = createELFFile<T>(TheBinary);
 
-      case ELF::DT_PLTRELSZ:
-        RelpltPortion.setSize(DynamicTag.getVal());
-        break;
+  // Look for static symbols
+  using ConstElf_ShdrPtr = const typename object::ELFFile<T>::Elf_Shdr *;
+  ConstElf_ShdrPtr SymtabShdr = nullptr;
 
-      case ELF::DT_REL:
-      case ELF::DT_RELA:
-        revng_assert(TheTag == (HasAddend ? ELF::DT_RELA : ELF::DT_REL));
-        ReldynPortion.setAddress(Relocated);
-        break;
+  auto Sections = TheELF.sections();
+  if (not Sections) {
+    logAllUnhandledErrors(std::move(Sections.takeError()), errs(), "");
+  } else {
+    for (auto &Section : *Sections) {
+      auto NameOrErr = TheELF.getSectionName(Section);
+      if (NameOrErr and *NameOrErr == ".symtab") {
+        // TODO: check dedicated field in section header
+        revng_assert(SymtabShdr == nullptr, "Duplicate .symtab");
+        SymtabShdr = &Section;
+      }
+    }
+  }
 
-      case ELF::DT_RELSZ:
-      case ELF::DT_RELASZ:
-        revng_assert(TheTag == (HasAddend ? ELF::DT_RELASZ : ELF::DT_RELSZ));
-        ReldynPortion.setSize(DynamicTag.getVal());
-        break;
+  // If we found a symbol table
+  if (SymtabShdr != nullptr && SymtabShdr->sh_link != 0) {
+    // Obtain a reference to the string table
+    auto Strtab = TheELF.getSection(SymtabShdr->sh_link);
+    if (not Strtab) {
+      logAllUnhandledErrors(std::move(Strtab.takeError()), errs(), "");
+      revng_abort();
+    }
+    auto StrtabArray = TheELF.getSectionContents(**Strtab);
+    if (not StrtabArray) {
+      logAllUnhandledErrors(std::move(StrtabArray.takeError()), errs(), "");
+      revng_abort();
+    }
+    StringRef StrtabContent(reinterpret_cast<const char *>(StrtabArray->data()),
+                            StrtabArray->size());
 
-      case ELF::DT_PLTGOT:
-        GotPortion.setAddress(Relocated);
+    // Collect symbol names
+    auto ELFSymbols = TheELF.symbols(SymtabShdr);
+    if (not ELFSymbols) {
+      logAllUnhandledErrors(std::move(ELFSymbols.takeError()), errs(), "");
+      revng_abort();
+    }
+    for (auto &Symbol : *ELFSymbols) {
+      auto Name = Symbol.getName(StrtabContent);
+      if (not Name) {
+        logAllUnhandledErrors(std::move(Name.takeError()), errs(), "");
+        revng_abort();
+      }
 
-        // Obtaint the canonical value of the global pointer in MIPS
-        if (IsMIPS)
-          CanonicalValues["gp"] = (Relocated + 0x7ff0).address();
-        break;
+      auto SymbolType = SymbolType::fromELF(Symbol.getType());
+      if (shouldIgnoreSymbol(*Name) or Symbol.st_shndx == ELF::SHN_UNDEF)
+        continue;
 
-      case ELF::DT_MIPS_SYMTABNO:
-        if (IsMIPS)
-          SymbolsCount = DynamicTag.getVal();
-        break;
+      MetaAddress Address = MetaAddress::invalid();
 
-      case ELF::DT_MIPS_GOTSYM:
-        if (IsMIPS)
-          MIPSFirstGotSymbol = DynamicTag.getVal();
-        break;
+      if (SymbolType == SymbolType::Code)
+        Address = relocate(fromPC(Symbol.st_value));
+      else
+        Address = relocate(fromGeneric(Symbol.st_value));
 
-      case ELF::DT_MIPS_LOCAL_GOTNO:
-        if (IsMIPS)
-          MIPSLocalGotEntries = DynamicTag.getVal();
-        break;
-      }
+      registerLabel(Label::createSymbol(LabelOrigin::StaticSymbol,
+                                        Address,
+                                        Symbol.st_size,
+                                        *Name,
+                                        SymbolType));
     }
+  }
 
-    if (NeededLibraryNames.size() > 0)
-      revng_assert(DynstrPortion.isAvailable());
-
-    // In MIPS the GOT has one entry per symbol
-    if (IsMIPS and SymbolsCount and MIPSFirstGotSymbol
-        and MIPSLocalGotEntries) {
-      uint32_t GotEntries = (*MIPSLocalGotEntries
-                             + (*SymbolsCount - *MIPSFirstGotSymbol));
-      GotPortion.setSize(GotEntries * sizeof(Elf_Addr));
-    }
+  // Parse dynamic symbols and relocations
+  bool IsMIPS = (TheArchitecture.type() == Triple::mips
+                 or TheArchitecture.type() == Triple::mipsel);
+  auto Dynamic = parseDynamic<T, HasAddend>(TheELF, *this, IsMIPS);
+  if (Dynamic) {
+    using Elf_Addr = const typename object::ELFFile<T>::Elf_Addr;
+    FilePortion &DynstrPortion = Dynamic->DynstrPortion;
+    FilePortion &DynsymPortion = Dynamic->DynsymPortion;
+    FilePortion &ReldynPortion = Dynamic->ReldynPortion;
+    FilePortion &RelpltPortion = Dynamic->RelpltPortion;
+    FilePortion &GotPortion = Dynamic->GotPortion;
+    Optional<uint64_t> &SymbolsCount = Dynamic->SymbolsCount;
+    Optional<uint64_t> &MIPSFirstGotSymbol = Dynamic->MIPSFirstGotSymbol;
+    Optional<uint64_t> &MIPSLocalGotEntries = Dynamic->MIPSLocalGotEntries;
 
     StringRef Dynstr;
-
-    if (DynstrPortion.isAvailable()) {
+    if (DynstrPortion.isAvailable())
       Dynstr = DynstrPortion.extractString(Segments);
-      for (auto Offset : NeededLibraryNameOffsets) {
-        StringRef LibraryName = Dynstr.slice(Offset, Dynstr.size());
-        NeededLibraryNames.push_back(LibraryName.data());
-      }
-    }
 
     // Collect symbols count and code pointers in image base-relative
     // relocations
@@ -1334,15 +1479,12 @@ Label BinaryFile::parseRelocation(unsigned char RelocationType,
                                   uint64_t Addend,
                                   StringRef SymbolName,
                                   uint64_t SymbolSize,
-                                  SymbolType::Values SymbolType) {
+                                  SymbolType::Values SymbolType) const {
 
   const auto &RelocationTypes = TheArchitecture.relocationTypes();
   auto It = RelocationTypes.find(RelocationType);
-  if (It == RelocationTypes.end()) {
-    dbg << "Warning: unhandled relocation type "
-        << static_cast<int>(RelocationType) << "\n";
+  if (It == RelocationTypes.end())
     return Label::createInvalid();
-  }
 
   uint64_t Offset;
 
@@ -1410,31 +1552,69 @@ void BinaryFile::registerRelocations(Elf_Rel_Array<T, HasAddend> Relocations,
   if (Dynsym.isAvailable())
     Symbols = Dynsym.extractAs<Elf_Sym>(Segments);
 
-  for (Elf_Rel Relocation : Relocations) {
-    auto Type = static_cast<unsigned char>(Relocation.getType(false));
-    uint64_t Addend = RelocationHelper<T, HasAddend>::getAddend(Relocation);
-    MetaAddress Address = relocate(fromGeneric(Relocation.r_offset));
-
-    StringRef SymbolName;
-    uint64_t SymbolSize = 0;
-    unsigned char SymbolType = llvm::ELF::STT_NOTYPE;
-    if (Dynsym.isAvailable() and Dynstr.isAvailable()) {
-      uint32_t SymbolIndex = Relocation.getSymbol(false);
-      revng_check(SymbolIndex < Symbols.size());
-      const Elf_Sym &Symbol = Symbols[SymbolIndex];
-      auto Result = Symbol.getName(Dynstr.extractString(Segments));
-      if (Result)
-        SymbolName = *Result;
-      SymbolSize = Symbol.st_size;
-      SymbolType = Symbol.getType();
+  bool HasSymbols = Dynsym.isAvailable() and Dynstr.isAvailable();
+  StringRef StringTable;
+  if (HasSymbols)
+    StringTable = Dynstr.extractString(Segments);
+
+  const auto &RelocationTypes = TheArchitecture.relocationTypes();
+
+  // Relocations are independent: parse them in shards, each producing its own
+  // labels, and register them in the original order
+  struct ShardResult {
+    std::vector<Label> Labels;
+    std::vector<unsigned char> UnhandledTypes;
+  };
+
+  size_t MaxShards = maxShards(Relocations.size());
+  std::vector<ShardResult> Results(std::min<size_t>(MaxShards,
+                                                    threadsCount()));
+
+  auto ParseShard = [&](size_t Shard, size_t Begin, size_t End) {
+    ShardResult &Result = Results[Shard];
+    for (const Elf_Rel &Relocation : Relocations.slice(Begin, End - Begin)) {
+      auto Type = static_cast<unsigned char>(Relocation.getType(false));
+      if (RelocationTypes.count(Type) == 0) {
+        Result.UnhandledTypes.push_back(Type);
+        continue;
+      }
+
+      uint64_t Addend = RelocationHelper<T, HasAddend>::getAddend(Relocation);
+      MetaAddress Address = relocate(fromGeneric(Relocation.r_offset));
+
+      StringRef SymbolName;
+      uint64_t SymbolSize = 0;
+      unsigned char SymbolType = llvm::ELF::STT_NOTYPE;
+      if (HasSymbols) {
+        uint32_t SymbolIndex = Relocation.getSymbol(false);
+        revng_check(SymbolIndex < Symbols.size());
+        const Elf_Sym &Symbol = Symbols[SymbolIndex];
+        auto Name = Symbol.getName(StringTable);
+        if (Name)
+          SymbolName = *Name;
+        SymbolSize = Symbol.st_size;
+        SymbolType = Symbol.getType();
+      }
+
+      Label NewLabel = parseRelocation(Type,
+                                       Address,
+                                       Addend,
+                                       SymbolName,
+                                       SymbolSize,
+                                       SymbolType::fromELF(SymbolType));
+      if (not NewLabel.isInvalid())
+        Result.Labels.push_back(NewLabel);
     }
+  };
+  forEachShard(Relocations.size(), Results.size(), ParseShard);
+
+  for (ShardResult &Result : Results) {
+    for (unsigned char Type : Result.UnhandledTypes)
+      dbg << "Warning: unhandled relocation type " << static_cast<int>(Type)
+          << "\n";
 
-    registerLabel(parseRelocation(Type,
-                                  Address,
-                                  Addend,
-                                  SymbolName,
-                                  SymbolSize,
-                                  SymbolType::fromELF(SymbolType)));
+    for (const Label &NewLabel : Result.Labels)
+      registerLabel(NewLabel);
   }
 }
 
@@ -1506,6 +1686,8 @@ void BinaryFile::rebuildLabelsMap() {
     LabelsMap += make_pair(Interval::right_open(Start, End), LabelList{ &L });
   }
 
+  Symbols.build(Labels);
+
   // Dump the map out
   if (LabelsLog.isEnabled()) {
     for (auto &P : LabelsMap) {
@@ -1752,7 +1934,54 @@ void BinaryFile::parseEHFrame(MetaAddress EHFrameAddress,
     return;
   llvm::ArrayRef<uint8_t> EHFrame = *R;
 
-  DwarfReader<T> EHFrameReader(TheArchitecture.type(), EHFrame, EHFrameAddress);
+  // Locate all the entries, reading only their length and ID. Entries can
+  // then be decoded independently.
+  struct EntryInfo {
+    uint64_t StartOffset;
+    bool IsCIE;
+  };
+  std::vector<EntryInfo> Entries;
+  std::vector<uint64_t> CIEOffsets;
+
+  {
+    DwarfReader<T> EHFrameReader(TheArchitecture.type(),
+                                 EHFrame,
+                                 EHFrameAddress);
+    unsigned FDEIndex = 0;
+
+    while (!EHFrameReader.eof()
+           && ((FDEsCount && FDEIndex < *FDEsCount)
+               || (EHFrameSize && EHFrameReader.offset() < *EHFrameSize))) {
+
+      uint64_t StartOffset = EHFrameReader.offset();
+
+      // Read the length of the entry
+      uint64_t Length = EHFrameReader.readNextU32();
+      if (Length == 0xffffffff)
+        Length = EHFrameReader.readNextU64();
+
+      // Compute the end offset of the entry
+      uint64_t OffsetAfterLength = EHFrameReader.offset();
+      uint64_t EndOffset = OffsetAfterLength + Length;
+
+      // Zero-sized entry, skip it
+      if (Length == 0) {
+        revng_assert(EHFrameReader.offset() == EndOffset);
+        continue;
+      }
+
+      // Get the entry ID, 0 means it's a CIE, otherwise it's a FDE
+      uint32_t ID = EHFrameReader.readNextU32();
+      Entries.push_back({ StartOffset, ID == 0 });
+      if (ID == 0)
+        CIEOffsets.push_back(StartOffset);
+      else
+        FDEIndex++;
+
+      // Skip all the remaining parts
+      EHFrameReader.moveTo(EndOffset);
+    }
+  }
 
   // A few fields of the CIE are used when decoding the FDE's.  This struct
   // will cache those fields we need so that we don't have to decode it
@@ -1763,125 +1992,148 @@ void BinaryFile::parseEHFrame(MetaAddress EHFrameAddress,
     bool hasAugmentationLength;
   };
 
-  // Map from the start offset of the CIE to the cached data for that CIE.
-  DenseMap<uint64_t, DecodedCIE> CachedCIEs;
-  unsigned FDEIndex = 0;
+  // Decode the CIE at \p StartOffset, the personality function is recorded as
+  // a landing pad
+  auto ParseCIE = [&](uint64_t StartOffset,
+                      std::set<MetaAddress> &NewLandingPads) -> DecodedCIE {
+    DwarfReader<T> EHFrameReader(TheArchitecture.type(),
+                                 EHFrame,
+                                 EHFrameAddress);
+    EHFrameReader.moveTo(StartOffset);
+
+    if (EHFrameReader.readNextU32() == 0xffffffff)
+      EHFrameReader.readNextU64();
+    uint32_t ID = EHFrameReader.readNextU32();
+    revng_assert(ID == 0);
 
-  while (!EHFrameReader.eof()
-         && ((FDEsCount && FDEIndex < *FDEsCount)
-             || (EHFrameSize && EHFrameReader.offset() < *EHFrameSize))) {
+    revng_log(EhFrameLog, "New CIE");
 
-    uint64_t StartOffset = EHFrameReader.offset();
+    // Ensure the version is the one we expect
+    uint32_t Version = EHFrameReader.readNextU8();
+    revng_assert(Version == 1);
 
-    // Read the length of the entry
-    uint64_t Length = EHFrameReader.readNextU32();
-    if (Length == 0xffffffff)
-      Length = EHFrameReader.readNextU64();
+    // Parse a null terminated augmentation string
+    SmallString<8> AugmentationString;
+    for (uint8_t Char = EHFrameReader.readNextU8(); Char != 0;
+         Char = EHFrameReader.readNextU8())
+      AugmentationString.push_back(Char);
 
-    // Compute the end offset of the entry
-    uint64_t OffsetAfterLength = EHFrameReader.offset();
-    uint64_t EndOffset = OffsetAfterLength + Length;
+    // Optionally parse the EH data if the augmentation string says it's
+    // there
+    if (StringRef(AugmentationString).count("eh") != 0)
+      EHFrameReader.readNextU();
 
-    // Zero-sized entry, skip it
-    if (Length == 0) {
-      revng_assert(EHFrameReader.offset() == EndOffset);
-      continue;
-    }
+    // CodeAlignmentFactor
+    EHFrameReader.readULEB128();
 
-    // Get the entry ID, 0 means it's a CIE, otherwise it's a FDE
-    uint32_t ID = EHFrameReader.readNextU32();
-    if (ID == 0) {
-      // This is a CIE
-      revng_log(EhFrameLog, "New CIE");
-
-      // Ensure the version is the one we expect
-      uint32_t Version = EHFrameReader.readNextU8();
-      revng_assert(Version == 1);
-
-      // Parse a null terminated augmentation string
-      SmallString<8> AugmentationString;
-      for (uint8_t Char = EHFrameReader.readNextU8(); Char != 0;
-           Char = EHFrameReader.readNextU8())
-        AugmentationString.push_back(Char);
-
-      // Optionally parse the EH data if the augmentation string says it's
-      // there
-      if (StringRef(AugmentationString).count("eh") != 0)
-        EHFrameReader.readNextU();
-
-      // CodeAlignmentFactor
-      EHFrameReader.readULEB128();
-
-      // DataAlignmentFactor
-      EHFrameReader.readULEB128();
-
-      // ReturnAddressRegister
-      EHFrameReader.readNextU8();
-
-      Optional<uint64_t> AugmentationLength;
-      Optional<uint32_t> LSDAPointerEncoding;
-      Optional<uint32_t> PersonalityEncoding;
-      Optional<uint32_t> FDEPointerEncoding;
-      if (!AugmentationString.empty() && AugmentationString.front() == 'z') {
-        AugmentationLength = EHFrameReader.readULEB128();
-
-        // Walk the augmentation string to get all the augmentation data.
-        for (unsigned I = 1, e = AugmentationString.size(); I != e; ++I) {
-          char Char = AugmentationString[I];
-          switch (Char) {
-          case 'e':
-            revng_assert((I + 1) != e && AugmentationString[I + 1] == 'h',
-                         "Expected 'eh' in augmentation string");
-            break;
-          case 'L':
-            // This is the only information we really care about, all the rest
-            // is processed just so we can get here
-            revng_assert(!LSDAPointerEncoding, "Duplicate LSDA encoding");
-            LSDAPointerEncoding = EHFrameReader.readNextU8();
-            break;
-          case 'P': {
-            revng_assert(!PersonalityEncoding, "Duplicate personality");
-            PersonalityEncoding = EHFrameReader.readNextU8();
-            // Personality
-            Pointer Personality;
-            Personality = EHFrameReader.readPointer(*PersonalityEncoding);
-            auto PersonalityPtr = getCodePointer<T>(Personality);
-            logAddress(EhFrameLog, "Personality function: ", PersonalityPtr);
-
-            // TODO: technically this is not a landing pad
-            LandingPads.insert(PersonalityPtr);
-            break;
-          }
-          case 'R':
-            revng_assert(!FDEPointerEncoding, "Duplicate FDE encoding");
-            FDEPointerEncoding = EHFrameReader.readNextU8();
-            break;
-          case 'z':
-            revng_unreachable("'z' must be first in the augmentation string");
-          }
+    // DataAlignmentFactor
+    EHFrameReader.readULEB128();
+
+    // ReturnAddressRegister
+    EHFrameReader.readNextU8();
+
+    Optional<uint64_t> AugmentationLength;
+    Optional<uint32_t> LSDAPointerEncoding;
+    Optional<uint32_t> PersonalityEncoding;
+    Optional<uint32_t> FDEPointerEncoding;
+    if (!AugmentationString.empty() && AugmentationString.front() == 'z') {
+      AugmentationLength = EHFrameReader.readULEB128();
+
+      // Walk the augmentation string to get all the augmentation data.
+      for (unsigned I = 1, e = AugmentationString.size(); I != e; ++I) {
+        char Char = AugmentationString[I];
+        switch (Char) {
+        case 'e':
+          revng_assert((I + 1) != e && AugmentationString[I + 1] == 'h',
+                       "Expected 'eh' in augmentation string");
+          break;
+        case 'L':
+          // This is the only information we really care about, all the rest
+          // is processed just so we can get here
+          revng_assert(!LSDAPointerEncoding, "Duplicate LSDA encoding");
+          LSDAPointerEncoding = EHFrameReader.readNextU8();
+          break;
+        case 'P': {
+          revng_assert(!PersonalityEncoding, "Duplicate personality");
+          PersonalityEncoding = EHFrameReader.readNextU8();
+          // Personality
+          Pointer Personality;
+          Personality = EHFrameReader.readPointer(*PersonalityEncoding);
+          auto PersonalityPtr = getCodePointer<T>(Personality);
+          logAddress(EhFrameLog, "Personality function: ", PersonalityPtr);
+
+          // TODO: technically this is not a landing pad
+          NewLandingPads.insert(PersonalityPtr);
+          break;
+        }
+        case 'R':
+          revng_assert(!FDEPointerEncoding, "Duplicate FDE encoding");
+          FDEPointerEncoding = EHFrameReader.readNextU8();
+          break;
+        case 'z':
+          revng_unreachable("'z' must be first in the augmentation string");
         }
       }
+    }
 
-      // Cache this entry
-      CachedCIEs[StartOffset] = { FDEPointerEncoding,
-                                  LSDAPointerEncoding,
-                                  AugmentationLength.hasValue() };
+    return { FDEPointerEncoding,
+             LSDAPointerEncoding,
+             AugmentationLength.hasValue() };
+  };
+
+  // Decode the entries in shards, each one with its own CIE cache and its own
+  // set of landing pads. Logging requires a single shard.
+  size_t MaxShards = 1;
+  if (not EhFrameLog.isEnabled())
+    MaxShards = maxShards(Entries.size());
+  std::vector<std::set<MetaAddress>> Results(std::min<size_t>(MaxShards,
+                                                              threadsCount()));
+
+  auto ParseShard = [&](size_t Shard, size_t Begin, size_t End) {
+    std::set<MetaAddress> &NewLandingPads = Results[Shard];
+
+    // Map from the start offset of the CIE to the cached data for that CIE.
+    DenseMap<uint64_t, DecodedCIE> CachedCIEs;
+    auto GetCIE = [&](uint64_t Offset) -> const DecodedCIE & {
+      auto It = CachedCIEs.find(Offset);
+      if (It == CachedCIEs.end())
+        It = CachedCIEs.insert({ Offset, ParseCIE(Offset, NewLandingPads) })
+               .first;
+      return It->second;
+    };
+
+    ArrayRef<EntryInfo> ShardEntries(Entries.data() + Begin,
+                                     Entries.data() + End);
+    for (const EntryInfo &Entry : ShardEntries) {
+      if (Entry.IsCIE) {
+        GetCIE(Entry.StartOffset);
+        continue;
+      }
 
-    } else {
       // This is an FDE
-      FDEIndex++;
+      DwarfReader<T> EHFrameReader(TheArchitecture.type(),
+                                   EHFrame,
+                                   EHFrameAddress);
+      EHFrameReader.moveTo(Entry.StartOffset);
+      if (EHFrameReader.readNextU32() == 0xffffffff)
+        EHFrameReader.readNextU64();
+      uint64_t OffsetAfterLength = EHFrameReader.offset();
+      uint32_t ID = EHFrameReader.readNextU32();
 
       // The CIE pointer for an FDE is the same location as the ID which we
       // already read
       uint64_t CIEOffset = OffsetAfterLength - ID;
 
       // Ensure we already met this CIE
-      auto CIEIt = CachedCIEs.find(CIEOffset);
-      revng_assert(CIEIt != CachedCIEs.end(),
+      bool IsKnownCIE = (CIEOffset < Entry.StartOffset
+                         and std::binary_search(CIEOffsets.begin(),
+                                                CIEOffsets.end(),
+                                                CIEOffset));
+      revng_assert(IsKnownCIE,
                    "Couldn't find CIE at offset in to __eh_frame section");
 
       // Ensure we have at least the pointer encoding
-      const DecodedCIE &CIE = CIEIt->getSecond();
+      const DecodedCIE &CIE = GetCIE(CIEOffset);
       revng_assert(CIE.FDEPointerEncoding,
                    "FDE references CIE which did not set pointer encoding");
 
@@ -1899,17 +2151,22 @@ void BinaryFile::parseEHFrame(MetaAddress EHFrameAddress,
       // Decode the LSDA if the CIE augmentation string said we should.
       if (CIE.LSDAPointerEncoding) {
         auto LSDAPointer = EHFrameReader.readPointer(*CIE.LSDAPointerEncoding);
-        parseLSDA<T>(PCBegin, getGenericPointer<T>(LSDAPointer));
+        parseLSDA<T>(PCBegin,
+                     getGenericPointer<T>(LSDAPointer),
+                     NewLandingPads);
       }
     }
+  };
+  forEachShard(Entries.size(), Results.size(), ParseShard);
 
-    // Skip all the remaining parts
-    EHFrameReader.moveTo(EndOffset);
-  }
+  for (const std::set<MetaAddress> &NewLandingPads : Results)
+    LandingPads.insert(NewLandingPads.begin(), NewLandingPads.end());
 }
 
 template<typename T>
-void BinaryFile::parseLSDA(MetaAddress FDEStart, MetaAddress LSDAAddress) {
+void BinaryFile::parseLSDA(MetaAddress FDEStart,
+                           MetaAddress LSDAAddress,
+                           std::set<MetaAddress> &NewLandingPads) const {
   logAddress(EhFrameLog, "LSDAAddress: ", LSDAAddress);
 
   auto R = getAddressData(LSDAAddress);
@@ -1953,10 +2210,10 @@ void BinaryFile::parseLSDA(MetaAddress FDEStart, MetaAddress LSDAAddress) {
     LSDAReader.readULEB128();
 
     if (LandingPad.isValid()) {
-      if (LandingPads.count(LandingPad) == 0)
+      if (NewLandingPads.count(LandingPad) == 0)
         logAddress(EhFrameLog, "New landing pad found: ", LandingPad);
 
-      LandingPads.insert(LandingPad);
+      NewLandingPads.insert(LandingPad);
     }
   }
 }
@@ -1977,65 +2234,148 @@ static bool isBetterThan(const Label *NewCandidate, const Label *OldCandidate) {
   return false;
 }
 
-std::string
-BinaryFile::nameForAddress(MetaAddress Address, uint64_t Size) const {
-  using interval = boost::icl::interval<MetaAddress, compareAddress>;
-  std::stringstream Result;
-  const auto &SymbolMap = labels();
+void SymbolIndex::build(ArrayRef<Label> Labels) {
+  Starts.clear();
+  Offsets.clear();
+  Covering.clear();
+  BestVirtual.clear();
 
-  auto End = Address.toGeneric() + Size;
-  revng_assert(Address.isValid() and End.isValid());
-  auto It = SymbolMap.find(interval::right_open(Address, End));
-  if (It != SymbolMap.end()) {
-    // We have to look for (in order):
-    //
-    // * Exact match
-    // * Contained (non 0-sized)
-    // * Contained (0-sized)
-    const Label *ExactMatch = nullptr;
-    const Label *ContainedNonZeroSized = nullptr;
-    const Label *ContainedZeroSized = nullptr;
-
-    for (const Label *L : It->second) {
-      // Consider symbols only
-      if (not L->isSymbol())
-        continue;
+  // Collect the non-empty symbols and the boundaries of the segments
+  std::vector<const Label *> Symbols;
+  for (const Label &L : Labels) {
+    if (not L.isSymbol() or L.size() == 0)
+      continue;
 
-      if (L->matches(Address, Size)) {
+    Symbols.push_back(&L);
+    Starts.push_back(L.address().address());
+    Starts.push_back((L.address() + L.size()).address());
+  }
 
-        // It's an exact match
-        ExactMatch = L;
-        break;
+  std::sort(Starts.begin(), Starts.end());
+  Starts.erase(std::unique(Starts.begin(), Starts.end()), Starts.end());
 
-      } else if (not L->isSizeVirtual() and L->contains(Address, Size)) {
+  if (Starts.size() == 0)
+    return;
 
-        // It's contained in a not 0-sized symbol
-        if (isBetterThan(L, ContainedNonZeroSized))
-          ContainedNonZeroSized = L;
+  size_t SegmentsCount = Starts.size() - 1;
+  auto SegmentsOf = [this](const Label *L) {
+    auto Begin = llvm::lower_bound(Starts, L->address().address());
+    auto End = llvm::lower_bound(Starts, (L->address() + L->size()).address());
+    return std::make_pair(Begin - Starts.begin(), End - Starts.begin());
+  };
 
-      } else if (L->isSizeVirtual() and L->contains(Address, 0)) {
+  // Count the symbols covering each segment
+  Offsets.assign(SegmentsCount + 1, 0);
+  for (const Label *L : Symbols) {
+    auto [Begin, End] = SegmentsOf(L);
+    for (auto I = Begin; I < End; ++I)
+      ++Offsets[I + 1];
+  }
 
-        // It's contained in a 0-sized symbol
-        if (isBetterThan(L, ContainedZeroSized))
-          ContainedZeroSized = L;
-      }
+  for (size_t I = 1; I < Offsets.size(); ++I)
+    Offsets[I] += Offsets[I - 1];
+
+  // Fill the flat array, preserving the original order, and pick the best
+  // symbol with a virtual size for each segment
+  Covering.resize(Offsets.back());
+  BestVirtual.assign(SegmentsCount, nullptr);
+  std::vector<uint32_t> Next(Offsets.begin(), --Offsets.end());
+  for (const Label *L : Symbols) {
+    auto [Begin, End] = SegmentsOf(L);
+    for (auto I = Begin; I < End; ++I) {
+      Covering[Next[I]++] = L;
+      if (L->isSizeVirtual() and isBetterThan(L, BestVirtual[I]))
+        BestVirtual[I] = L;
     }
+  }
+}
 
-    const Label *Chosen = nullptr;
-    if (ExactMatch != nullptr)
-      Chosen = ExactMatch;
-    else if (ContainedNonZeroSized != nullptr)
-      Chosen = ContainedNonZeroSized;
-    else if (ContainedZeroSized != nullptr)
-      Chosen = ContainedZeroSized;
-
-    if (Chosen != nullptr and Chosen->symbolName().size() != 0) {
-      auto Arch = architecture().type();
-      Address.dumpRelativeTo(Result,
-                             Chosen->address().toPC(Arch),
-                             Chosen->symbolName());
-      return Result.str();
-    }
+const Label *SymbolIndex::lookup(MetaAddress Address, uint64_t Size) const {
+  uint64_t Raw = Address.toGeneric().address();
+  auto It = llvm::upper_bound(Starts, Raw);
+  if (It == Starts.begin() or It == Starts.end())
+    return nullptr;
+
+  size_t Segment = (It - Starts.begin()) - 1;
+  const Label *ContainedNonZeroSized = nullptr;
+  for (uint32_t I = Offsets[Segment]; I < Offsets[Segment + 1]; ++I) {
+    const Label *L = Covering[I];
+
+    // Exact match
+    if (L->matches(Address, Size))
+      return L;
+
+    // Contained in a not 0-sized symbol
+    if (not L->isSizeVirtual() and L->contains(Address, Size)
+        and isBetterThan(L, ContainedNonZeroSized))
+      ContainedNonZeroSized = L;
+  }
+
+  if (ContainedNonZeroSized != nullptr)
+    return ContainedNonZeroSized;
+
+  // Contained in a 0-sized symbol
+  return BestVirtual[Segment];
+}
+
+/// \brief Minimal std::ostream replacement writing to a stack buffer
+///
+/// It supports what MetaAddress::dump and MetaAddress::dumpRelativeTo need:
+/// strings, unsigned integers, std::hex and std::dec.
+class AddressNameFormatter {
+private:
+  using Manipulator = std::ios_base &(*) (std::ios_base &);
+
+private:
+  llvm::SmallString<64> Buffer;
+  llvm::raw_svector_ostream Stream;
+  bool Hexadecimal = false;
+
+public:
+  AddressNameFormatter() : Stream(Buffer) {}
+
+  AddressNameFormatter &operator<<(const char *String) {
+    Stream << String;
+    return *this;
+  }
+
+  AddressNameFormatter &operator<<(uint64_t Value) {
+    if (Hexadecimal)
+      Stream.write_hex(Value);
+    else
+      Stream << Value;
+    return *this;
+  }
+
+  AddressNameFormatter &operator<<(Manipulator M) {
+    if (M == static_cast<Manipulator>(std::hex))
+      Hexadecimal = true;
+    else if (M == static_cast<Manipulator>(std::dec))
+      Hexadecimal = false;
+    else
+      revng_abort();
+    return *this;
+  }
+
+  std::string str() const { return std::string(Buffer.str()); }
+};
+
+std::string
+BinaryFile::nameForAddress(MetaAddress Address, uint64_t Size) const {
+  ensureSymbolsParsed();
+
+  AddressNameFormatter Result;
+
+  auto End = Address.toGeneric() + Size;
+  revng_assert(Address.isValid() and End.isValid());
+
+  const Label *Chosen = Symbols.lookup(Address, Size);
+  if (Chosen != nullptr and Chosen->symbolName().size() != 0) {
+    auto Arch = architecture().type();
+    Address.dumpRelativeTo(Result,
+                           Chosen->address().toPC(Arch),
+                           Chosen->symbolName());
+    return Result.str();
   }
 
   // We don't have a symbol to use, just return the address
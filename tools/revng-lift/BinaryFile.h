@@ -10,9 +10,11 @@
 
 #include "boost/icl/interval_map.hpp"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/ELFTypes.h"
+#include "llvm/Support/CommandLine.h"
 
 #include "revng/Support/revng.h"
 
@@ -433,8 +435,48 @@ private:
   MetaAddress Value;
 };
 
+/// \brief Immutable index of the symbols, used to name addresses
+///
+/// The address space is split in elementary segments at the boundaries of
+/// the symbols. For each segment we record, in a flat array, the symbols
+/// covering it and, precomputed, the best candidate among those with a virtual
+/// size. A lookup is a binary search followed by a scan of the symbols
+/// covering the address, and never allocates.
+///
+/// \note All the symbols are expected to have comparable addresses.
+class SymbolIndex {
+private:
+  /// Start of each segment, segment I ends at Starts[I + 1]
+  std::vector<uint64_t> Starts;
+  /// Segment I is covered by Covering[Offsets[I]] to Covering[Offsets[I + 1]]
+  std::vector<uint32_t> Offsets;
+  /// Symbols covering each segment, in the order they've been registered
+  std::vector<const Label *> Covering;
+  /// Best symbol with a virtual size covering each segment, if any
+  std::vector<const Label *> BestVirtual;
+
+public:
+  /// \brief Rebuild the index from scratch considering the symbols in \p Labels
+  void build(llvm::ArrayRef<Label> Labels);
+
+  /// \brief Find the symbol to use to name [Address, Address + Size)
+  ///
+  /// In order of preference: a symbol exactly matching the range, the
+  /// best symbol strictly containing the range and, finally, the best symbol
+  /// with a virtual size containing \p Address. A symbol is better than
+  /// another one if it starts at a higher address or, at the same address, if
+  /// the other has no name.
+  ///
+  /// \return the chosen symbol or nullptr.
+  const Label *lookup(MetaAddress Address, uint64_t Size) const;
+};
+
 class FilePortion;
 
+/// Relocation tables and .eh_frame sections are parsed in parallel only if
+/// each thread gets at least this many entries
+extern llvm::cl::opt<unsigned> BinaryFileShardSize;
+
 using boost::icl::partial_absorber;
 
 template<typename A, typename B, ICL_COMPARE C>
@@ -442,6 +484,16 @@ using interval_map = boost::icl::interval_map<A, B, partial_absorber, C>;
 
 /// \brief BinaryFile describes an input image file in a semi-architecture
 ///        independent way
+///
+/// The input file is mmap'd and segments point into the mapping. Upon
+/// construction only the headers, the segments and the .dynamic table are
+/// parsed: symbols and relocations are parsed upon the first query for
+/// labels, code pointers or names, exception handling information upon the
+/// first query for landing pads. Use `-instrumentation-output` to see how long
+/// each phase takes and the peak memory usage.
+///
+/// \note revng-lift queries labels, landing pads and code pointers as soon as
+///       it starts harvesting, so, there, parsing lazily only defers the work.
 class BinaryFile {
 public:
   using LabelList = llvm::SmallVector<Label *, 6u>;
@@ -485,9 +537,22 @@ public:
   const Architecture &architecture() const { return TheArchitecture; }
   std::vector<SegmentInfo> &segments() { return Segments; }
   const std::vector<SegmentInfo> &segments() const { return Segments; }
-  const LabelIntervalMap &labels() const { return LabelsMap; }
-  const std::set<MetaAddress> &landingPads() const { return LandingPads; }
-  const std::set<MetaAddress> &codePointers() const { return CodePointers; }
+
+  const LabelIntervalMap &labels() const {
+    ensureSymbolsParsed();
+    return LabelsMap;
+  }
+
+  const std::set<MetaAddress> &landingPads() const {
+    ensureExceptionHandlingParsed();
+    return LandingPads;
+  }
+
+  const std::set<MetaAddress> &codePointers() const {
+    ensureSymbolsParsed();
+    return CodePointers;
+  }
+
   MetaAddress entryPoint() const { return EntryPoint; }
 
   const std::vector<std::string> &neededLibraryNames() const {
@@ -567,6 +632,15 @@ private:
   void
   parseELF(llvm::object::ObjectFile *TheBinary, uint64_t PreferredBaseAddress);
 
+  /// \brief Parse the static and dynamic symbols and the dynamic relocations
+  ///        of an ELF file
+  template<typename T, bool HasAddend>
+  void parseELFSymbols();
+
+  /// \brief Parse .eh_frame and the LSDAs of an ELF file
+  template<typename T>
+  void parseELFExceptionHandling();
+
   /// \brief Parse a COFF file
   void
   parseCOFF(llvm::object::ObjectFile *TheBinary, uint64_t PreferredBaseAddress);
@@ -575,6 +649,9 @@ private:
   void parseMachOSegment(llvm::ArrayRef<uint8_t> RawDataRef,
                          const T &SegmentCommand);
 
+  /// \brief Register a label for each entry of the Mach-O bind tables
+  void parseMachOBindings();
+
   /// \brief Parse the .eh_frame_hdr section to obtain the address and the
   ///        number of FDEs in .eh_frame
   ///
@@ -587,6 +664,9 @@ private:
 
   /// \brief Parse the .eh_frame section to collect all the landing pads
   ///
+  /// Entries are first located reading only their lengths and IDs, then
+  /// decoded in parallel, if there are many of them.
+  ///
   /// \param EHFrameAddress the address of the .eh_frame section
   /// \param FDEsCount the count of FDEs in the .eh_frame section
   /// \param EHFrameSize the size of the .eh_frame section
@@ -602,8 +682,13 @@ private:
   /// \param FDEStart the start address of the FDE to which this LSDA is
   ///        associated
   /// \param LSDAAddress the address of the target LSDA
+  /// \param NewLandingPads the set where the landing pads are collected
+  ///
+  /// \note this method is thread-safe
   template<typename T>
-  void parseLSDA(MetaAddress FDEStart, MetaAddress LSDAAddress);
+  void parseLSDA(MetaAddress FDEStart,
+                 MetaAddress LSDAAddress,
+                 std::set<MetaAddress> &NewLandingPads) const;
 
   /// \brief Compute the symbol count according to the given relocation table
   ///
@@ -613,17 +698,25 @@ private:
   uint64_t symbolsCount(const FilePortion &Relocations);
 
   /// \brief Process a relocation and produce a Label
+  ///
+  /// \note this method is thread-safe
+  ///
+  /// \return an invalid Label if the relocation has to be ignored or its type
+  ///         is not supported.
   Label parseRelocation(unsigned char RelocationType,
                         MetaAddress Target,
                         uint64_t Addend,
                         llvm::StringRef SymbolName,
                         uint64_t SymbolSize,
-                        SymbolType::Values SymbolType);
+                        SymbolType::Values SymbolType) const;
 
   template<typename T, bool Addend>
   using Elf_Rel_Array = llvm::ArrayRef<llvm::object::Elf_Rel_Impl<T, Addend>>;
 
   /// \brief Register a label for each input relocation
+  ///
+  /// Large relocation tables are parsed in parallel, labels are registered in
+  /// the order of the table anyway.
   template<typename T, bool HasAddend>
   void registerRelocations(Elf_Rel_Array<T, HasAddend> Relocations,
                            const FilePortion &Dynsym,
@@ -642,6 +735,16 @@ private:
 
   void rebuildLabelsMap();
 
+  /// \brief Run the symbols parser for the current format, if it hasn't run
+  ///        yet, and build the labels map
+  ///
+  /// \note BinaryFile is not thread-safe, lazily parsed information included
+  void ensureSymbolsParsed() const;
+
+  /// \brief Run the exception handling information parser for the current
+  ///        format, if it hasn't run yet
+  void ensureExceptionHandlingParsed() const;
+
   SegmentInfo *findSegment(MetaAddress Address) {
     for (SegmentInfo &Segment : Segments)
       if (Segment.contains(Address))
@@ -668,11 +771,24 @@ private:
   std::map<llvm::StringRef, uint64_t> CanonicalValues;
   std::vector<Label> Labels;
   LabelIntervalMap LabelsMap;
+  SymbolIndex Symbols;
 
   /// The program's entry point
   MetaAddress EntryPoint;
   llvm::Optional<uint64_t> BaseAddress;
 
+  //
+  // Lazy parsing
+  //
+
+  /// Parser for symbols and relocations, run upon the first query for labels
+  void (BinaryFile::*SymbolsParser)() = nullptr;
+  bool SymbolsParsed = false;
+
+  /// Parser for landing pads, run upon the first query for them
+  void (BinaryFile::*ExceptionHandlingParser)() = nullptr;
+  bool ExceptionHandlingParsed = false;
+
   //
   // ELF specific fields
   //
@@ -682,4 +798,11 @@ private:
     unsigned Count = 0;
     unsigned Size = 0;
   } ProgramHeaders;
+
+  /// Location of the exception handling information, for the lazy parser
+  struct EHFrameInfo {
+    llvm::Optional<MetaAddress> Address;
+    llvm::Optional<uint64_t> Size;
+    llvm::Optional<MetaAddress> HeaderAddress;
+  } EHFrame;
 };
@@ -23,6 +23,7 @@
 
 #include "revng/Support/Debug.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/Support/Instrumentation.h"
 
 #include "CPUStateAccessAnalysisPass.h"
 #include "VariableManager.h"
@@ -3271,6 +3272,7 @@ bool CPUStateAccessAnalysis::run() {
 }
 
 bool CPUStateAccessAnalysisPass::runOnModule(Module &Mod) {
+  PhaseTimer Timer("csaa");
   CPUStateAccessAnalysis AccessAnalysis(Mod, Variables, Lazy);
   return AccessAnalysis.run();
 }
@@ -44,6 +44,7 @@
 #include "revng/Support/Debug.h"
 #include "revng/Support/DebugHelper.h"
 #include "revng/Support/FunctionTags.h"
+#include "revng/Support/Instrumentation.h"
 #include "revng/Support/ProgramCounterHandler.h"
 #include "revng/Support/revng.h"
 
@@ -734,6 +735,7 @@ bool CpuLoopExitPass::runOnModule(llvm::Module &M) {
 }
 
 void CodeGenerator::translate(Optional<uint64_t> RawVirtualAddress) {
+  PhaseTimer Timer("lift");
   using FT = FunctionType;
 
   // Declare the abort function
@@ -1343,6 +1345,8 @@ void CodeGenerator::translate(Optional<uint64_t> RawVirtualAddress) {
 }
 
 void CodeGenerator::serialize() {
+  PhaseTimer Timer("serialize");
+
   // Ask the debug handler if it already has a good copy of the IR, if not dump
   // it
   if (!Debug->copySource()) {
@@ -44,6 +44,7 @@
 #include "revng/Support/Debug.h"
 #include "revng/Support/FunctionTags.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/Support/Instrumentation.h"
 #include "revng/Support/MetaAddress.h"
 #include "revng/Support/Statistics.h"
 #include "revng/Support/revng.h"
@@ -66,6 +67,30 @@ Logger<> RegisterJTLog("registerjt");
 
 CounterMap<std::string> HarvestingStats("harvesting");
 RunningStatistics BlocksAnalyzedByAVI("blocks-analyzed-by-avi");
+RunningStatistics AVICacheHits("avi-cache-hits");
+InstrumentationCounter NewJumpTargets("new-jump-targets");
+
+cl::opt<bool> CountDispatcherHits("count-dispatcher-hits",
+                                  cl::desc("count how many times the "
+                                           "dispatcher is reached at run "
+                                           "time, see support.c"),
+                                  cl::cat(MainCategory));
+
+cl::opt<unsigned> AVIWideningThreshold("avi-widening-threshold",
+                                       cl::desc("visits of a basic block "
+                                                "after which AVI widens the "
+                                                "ranges that keep growing, 0 "
+                                                "to never widen"),
+                                       cl::cat(MainCategory),
+                                       cl::init(0));
+
+cl::opt<unsigned> AVIVisitsBudget("avi-visits-budget",
+                                  cl::desc("average visits per basic block "
+                                           "after which AVI gives up on "
+                                           "narrowing ranges, 0 for no "
+                                           "limit"),
+                                  cl::cat(MainCategory),
+                                  cl::init(0));
 
 RegisterPass<TranslateDirectBranchesPass> X("translate-db",
                                             "Translate Direct Branches"
@@ -901,6 +926,8 @@ JumpTargetManager::registerJT(MetaAddress PC, JTReason::Values Reason) {
     return BB;
   }
 
+  NewJumpTargets.add();
+
   // Did we already meet this PC (i.e. do we know what's the associated
   // instruction)?
   BasicBlock *NewBlock = nullptr;
@@ -988,6 +1015,17 @@ void JumpTargetManager::prepareDispatcher() {
 
   Dispatcher = Entry;
 
+  // The counter lives at the beginning of the dispatcher entry block, which
+  // survives rebuildDispatcher
+  if (CountDispatcherHits) {
+    Type *HitsType = Type::getInt64Ty(Context);
+    Constant *Hits = TheModule.getOrInsertGlobal("dispatcher_hits", HitsType);
+    Builder.SetInsertPoint(Entry);
+    Value *NewHits = Builder.CreateAdd(Builder.CreateLoad(Hits),
+                                       ConstantInt::get(HitsType, 1));
+    Builder.CreateStore(NewHits, Hits);
+  }
+
   // Create basic blocks to handle jumps to any PC and to a PC we didn't expect
   AnyPC = BasicBlock::Create(Context, "anypc", TheFunction);
   UnexpectedPC = BasicBlock::Create(Context, "unexpectedpc", TheFunction);
@@ -1441,6 +1479,7 @@ JumpTargetManager::MetaAddressSet JumpTargetManager::inflateAVIWhitelist() {
 }
 
 void JumpTargetManager::harvestWithAVI() {
+  PhaseTimer Timer("avi");
   Module *M = TheFunction->getParent();
 
   //
@@ -1678,6 +1717,10 @@ void JumpTargetManager::harvestWithAVI() {
 
   SummaryCallsBuilder SCB(CSVMap);
 
+  // Values materialized by AVI, shared by all the values registered in AR. It
+  // refers to OptimizedFunction, so it must not outlive this round.
+  MaterializedValuesCache AVICache;
+
   // Remove PC initialization from entry block
   {
     BasicBlock &Entry = OptimizedFunction->getEntryBlock();
@@ -1708,7 +1751,10 @@ void JumpTargetManager::harvestWithAVI() {
     FPM.addPass(InstCombinePass(true));
     FPM.addPass(EarlyCSEPass(true));
     FPM.addPass(DropRangeMetadataPass());
-    FPM.addPass(AdvancedValueInfoPass(this));
+    DisjointRanges::ConvergenceOptions Options;
+    Options.WideningThreshold = AVIWideningThreshold;
+    Options.VisitsPerLabelBudget = AVIVisitsBudget;
+    FPM.addPass(AdvancedValueInfoPass(this, &AVICache, Options));
 
     FunctionAnalysisManager FAM;
     FAM.registerPass([]() { return TypeShrinking::BitLivenessPass(); });
@@ -1733,6 +1779,8 @@ void JumpTargetManager::harvestWithAVI() {
     FPM.run(*OptimizedFunction, FAM);
   }
 
+  AVICacheHits.push(AVICache.hits());
+
   if (VerifyLog.isEnabled())
     revng_check(not verifyModule(*OptimizedFunction->getParent(), &dbgs()));
 
@@ -1854,6 +1902,7 @@ void JumpTargetManager::harvestWithAVI() {
 // translate we proceed as long as we are able to create new edges on the CFG
 // (not considering the dispatcher).
 void JumpTargetManager::harvest() {
+  PhaseTimer Timer("harvest");
 
   HarvestingStats.push("harvest 0");
 